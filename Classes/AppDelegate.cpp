@@ -24,6 +24,7 @@
 
 #include "AppDelegate.h"
 #include "BoardModuleTest.h"
+#include "2d/CCFontAtlasCache.h"
 
 // #define USE_AUDIO_ENGINE 1
 // #define USE_SIMPLE_AUDIO_ENGINE 1
@@ -96,12 +97,21 @@ bool AppDelegate::applicationDidFinishLaunching() {
     // set FPS. the default value is 1.0/60 if you don't call this
     director->setAnimationInterval(1.0f / 60);
 
+    // reorder commands with the same global Z order by material, to batch pieces, labels and icons together
+    director->getRenderer()->setBatchReorderingEnabled(true);
+
     // Set search paths
     auto fileUtils = FileUtils::getInstance();
     std::vector<std::string> searchPaths = fileUtils->getSearchPaths();
     searchPaths.push_back("Resources");
     searchPaths.push_back("shaders");
     fileUtils->setSearchPaths(searchPaths);
+    // 启动时建立搜索路径的文件索引，之后查找文件（包括找不到的文件）不再访问磁盘
+    fileUtils->setSearchPathIndexEnabled(true);
+    // 拼图大图优先加载 tools/compress_textures.py 生成的 GPU 压缩纹理（ASTC/ETC2/ETC1），没有时仍用 PNG
+    TextureCache::setCompressedVariantsEnabled(true);
+    // 字体图集的字形页缓存到可写目录，下次启动直接加载，不再重新光栅化已用过的字形
+    FontAtlas::setPersistentCacheEnabled(true);
 
     // Set the design resolution
     glview->setDesignResolutionSize(designResolutionSize.width, designResolutionSize.height, ResolutionPolicy::SHOW_ALL);
@@ -142,6 +152,8 @@ bool AppDelegate::applicationDidFinishLaunching() {
 // This function will be called when the app is inactive. Note, when receiving a phone call it is invoked.
 void AppDelegate::applicationDidEnterBackground() {
     Director::getInstance()->stopAnimation();
+    // 进入后台时可能被系统杀掉，先保存有新字形的字体图集
+    FontAtlasCache::savePersistentCache();
 
 #if USE_AUDIO_ENGINE
     AudioEngine::pauseAll();
@@ -65,6 +65,9 @@ bool BoardModule::init() {
     _inputHandler->setDelegate(this);
     _rules = new PuzzleRules();
 
+    // 棋盘大部分帧都没有变化，缓存渲染命令，只有拼图块移动或状态变化时才重新遍历
+    setStaticSubtree(true);
+
     // 设置输入监听器
     auto touchListener = cocos2d::EventListenerTouchOneByOne::create();
     touchListener->setSwallowTouches(true);
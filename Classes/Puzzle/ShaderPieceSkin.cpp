@@ -37,7 +37,11 @@ bool ShaderPieceSkin::initShader() {
         fragPath = "Resources/shaders/RoundedBorder.frag";
     }
 
-    auto glProgram = cocos2d::GLProgram::createWithFilenames(vertPath, fragPath);
+    // ETC1 压缩纹理的 alpha 在单独的纹理中，需要 shader 从 CC_Texture1 读取
+    auto texture = _sprite->getTexture();
+    const bool hasAlphaTexture = texture && texture->getAlphaTexture() != nullptr;
+
+    auto glProgram = cocos2d::GLProgram::createWithFilenames(vertPath, fragPath, hasAlphaTexture ? "USE_ALPHA_TEXTURE" : "");
     if (!glProgram) {
         cocos2d::log("ShaderPieceSkin: Failed to load shader files.");
         return false;
@@ -45,6 +49,8 @@ bool ShaderPieceSkin::initShader() {
 
     _glProgramState = cocos2d::GLProgramState::create(glProgram);
     _sprite->setGLProgramState(_glProgramState);
+    _cornerRadiiHandle = _glProgramState->getUniformHandle("u_cornerRadii");
+    _borderSidesHandle = _glProgramState->getUniformHandle("u_borderSides");
     
     // 设置初始 Uniforms
     cocos2d::Size size = _sprite->getContentSize();
@@ -52,10 +58,6 @@ bool ShaderPieceSkin::initShader() {
     _glProgramState->setUniformFloat("u_borderWidth", _config.borderWidth);
     _glProgramState->setUniformVec4("u_borderColor", _config.borderColor);
     
-    // 默认：显示所有边框和圆角
-    _glProgramState->setUniformVec4("u_cornerRadii", cocos2d::Vec4(_config.cornerRadius, _config.cornerRadius, _config.cornerRadius, _config.cornerRadius));
-    _glProgramState->setUniformVec4("u_borderSides", cocos2d::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
-    
     // 计算 UV 矩形
     auto quad = _sprite->getQuad();
     float minU = std::min(quad.tl.texCoords.u, quad.br.texCoords.u);
@@ -69,10 +71,55 @@ bool ShaderPieceSkin::initShader() {
     if (heightV <= 0.0001f) heightV = 1.0f;
 
     _glProgramState->setUniformVec4("u_uvRect", cocos2d::Vec4(minU, minV, widthU, heightV));
+
+    // 支持实例化绘制时额外使用共享的实例化 Shader，不支持时 Sprite 自动回退到上面的逐块 Shader
+    initInstancedShader(vertPath, fragPath, hasAlphaTexture);
+
+    // 默认：显示所有边框和圆角
+    applyPieceParams(cocos2d::Vec4(_config.cornerRadius, _config.cornerRadius, _config.cornerRadius, _config.cornerRadius),
+                     cocos2d::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
     
     return true;
 }
 
+bool ShaderPieceSkin::initInstancedShader(const std::string& vertPath, const std::string& fragPath, bool hasAlphaTexture) {
+    if (!cocos2d::Configuration::getInstance()->supportsInstancedArrays()) return false;
+
+    // 带 alpha 纹理 (ETC1) 的版本单独缓存
+    const char* PROGRAM_KEY = hasAlphaTexture ? "RoundedBorderInstancedAlphaTexture" : "RoundedBorderInstanced";
+    auto cache = cocos2d::GLProgramCache::getInstance();
+    auto glProgram = cache->getGLProgram(PROGRAM_KEY);
+    if (!glProgram) {
+        // 与 RoundedBorder.vert 在同一目录
+        std::string instancedVertPath = vertPath.substr(0, vertPath.rfind("RoundedBorder.vert")) + "RoundedBorderInstanced.vert";
+        if (!cocos2d::FileUtils::getInstance()->isFileExist(instancedVertPath)) return false;
+
+        glProgram = cocos2d::GLProgram::createWithFilenames(instancedVertPath, fragPath,
+                                                             hasAlphaTexture ? "USE_INSTANCING;USE_ALPHA_TEXTURE" : "USE_INSTANCING");
+        if (!glProgram) {
+            cocos2d::log("ShaderPieceSkin: Failed to load instanced shader files.");
+            return false;
+        }
+        cache->addGLProgram(glProgram, PROGRAM_KEY);
+    }
+
+    // 所有拼图块共用同一个 GLProgramState (同一纹理时可合并为一次绘制)
+    // 拼图块大小都相同，u_size 等作为共享 uniform，圆角和描边通过实例参数传递
+    auto glProgramState = cocos2d::GLProgramState::getOrCreateWithGLProgram(glProgram);
+    cocos2d::Size size = _sprite->getContentSize();
+    glProgramState->setUniformVec2("u_size", cocos2d::Vec2(size.width, size.height));
+    glProgramState->setUniformFloat("u_borderWidth", _config.borderWidth);
+    glProgramState->setUniformVec4("u_borderColor", _config.borderColor);
+    _sprite->setInstancedGLProgramState(glProgramState);
+    return true;
+}
+
+void ShaderPieceSkin::applyPieceParams(const cocos2d::Vec4& cornerRadii, const cocos2d::Vec4& borderSides) {
+    _glProgramState->setUniformVec4(_cornerRadiiHandle, cornerRadii);
+    _glProgramState->setUniformVec4(_borderSidesHandle, borderSides);
+    _sprite->setInstanceParams(cornerRadii, borderSides);
+}
+
 void ShaderPieceSkin::updateState(const PieceState& state) {
     if (!_glProgramState) return;
 
@@ -82,8 +129,6 @@ void ShaderPieceSkin::updateState(const PieceState& state) {
     if (state.connectedRight) borderSides.y = 0.0f;
     if (state.connectedBottom) borderSides.z = 0.0f;
     if (state.connectedLeft) borderSides.w = 0.0f;
-    
-    _glProgramState->setUniformVec4("u_borderSides", borderSides);
 
     // u_cornerRadii: 右上, 右下, 左上, 左下
     float r = _config.cornerRadius;
@@ -94,7 +139,7 @@ void ShaderPieceSkin::updateState(const PieceState& state) {
     if (state.connectedTop || state.connectedLeft) cornerRadii.z = 0.0f; 
     if (state.connectedBottom || state.connectedLeft) cornerRadii.w = 0.0f; 
 
-    _glProgramState->setUniformVec4("u_cornerRadii", cornerRadii);
+    applyPieceParams(cornerRadii, borderSides);
 }
 
 void ShaderPieceSkin::updateAppearance(const PuzzlePiece* piece) {
@@ -115,8 +160,6 @@ void ShaderPieceSkin::updateAppearance(const PuzzlePiece* piece) {
     // w: BottomLeft (受 Bottom 和 Left 影响)
     if (piece->connectedBottom || piece->connectedLeft) cornerRadii.w = 0.0f;
 
-    _glProgramState->setUniformVec4("u_cornerRadii", cornerRadii);
-
     // 2. 更新描边显隐 (根据连接状态)
     // Shader: u_borderSides (Top, Right, Bottom, Left) -> (1, 2, 4, 8)
     // 0 表示显示，1 表示隐藏 (Shader 逻辑可能需要适配，或者这里传 float 数组)
@@ -128,5 +171,5 @@ void ShaderPieceSkin::updateAppearance(const PuzzlePiece* piece) {
     if (piece->connectedBottom) borderSides.z = 0.0f;
     if (piece->connectedLeft) borderSides.w = 0.0f;
     
-    _glProgramState->setUniformVec4("u_borderSides", borderSides);
+    applyPieceParams(cornerRadii, borderSides);
 }
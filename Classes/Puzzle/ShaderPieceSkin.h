@@ -16,11 +16,16 @@ public:
 protected:
     ShaderPieceSkin(const GameConfig& config);
     bool initShader();
+    bool initInstancedShader(const std::string& vertPath, const std::string& fragPath, bool hasAlphaTexture);
+    void applyPieceParams(const cocos2d::Vec4& cornerRadii, const cocos2d::Vec4& borderSides);
 
 private:
     GameConfig _config;
     cocos2d::Sprite* _sprite;
     cocos2d::GLProgramState* _glProgramState;
+    // 每次拼合都会更新的 uniform，预先解析句柄避免按名字查找
+    cocos2d::UniformHandle _cornerRadiiHandle;
+    cocos2d::UniformHandle _borderSidesHandle;
 };
 
 #endif // __SHADER_PIECE_SKIN_H__
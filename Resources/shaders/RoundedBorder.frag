@@ -9,9 +9,18 @@ varying vec2 v_pos;
 uniform vec2 u_size;
 uniform float u_borderWidth;
 uniform vec4 u_borderColor;
+#ifdef USE_INSTANCING
+// Per piece values come from the instance attributes (see RoundedBorderInstanced.vert)
+varying vec2 v_localUV;
+varying vec4 v_cornerRadii;
+varying vec4 v_borderSides;
+#define u_cornerRadii v_cornerRadii
+#define u_borderSides v_borderSides
+#else
 uniform vec4 u_uvRect; // x: minU, y: minV, z: widthU, w: heightV
 uniform vec4 u_cornerRadii; // x: TR, y: BR, z: TL, w: BL
 uniform vec4 u_borderSides; // x: Top, y: Right, z: Bottom, w: Left (1.0 = show, 0.0 = hide)
+#endif
 
 // Signed Distance Function for a rounded box with varying radii
 // r: TR, BR, TL, BL
@@ -40,7 +49,11 @@ float sdRoundedBox(vec2 p, vec2 b, vec4 r)
 void main()
 {
     // Calculate local UV (0.0 to 1.0)
+#ifdef USE_INSTANCING
+    vec2 localUV = v_localUV;
+#else
     vec2 localUV = (v_texCoord - u_uvRect.xy) / u_uvRect.zw;
+#endif
     
     // Calculate local position centered at (0,0)
     // FIX: Invert Y because Cocos2d texture coordinates V goes down (0 at top, 1 at bottom)
@@ -113,7 +126,13 @@ void main()
         }
     }
 
+#ifdef USE_ALPHA_TEXTURE
+    // ETC1 textures keep their alpha in a second texture, premultiplied here like the engine's ETC1 alpha shader
+    vec4 texColor = vec4(texture2D(CC_Texture0, v_texCoord).rgb, texture2D(CC_Texture1, v_texCoord).r);
+    texColor.rgb *= texColor.a;
+#else
     vec4 texColor = texture2D(CC_Texture0, v_texCoord);
+#endif
     
     // Calculate border factor
     float borderFactor = smoothstep(-u_borderWidth - 1.0, -u_borderWidth, dist);
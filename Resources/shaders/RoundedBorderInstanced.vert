@@ -0,0 +1,38 @@
+// 实例化绘制版本：所有拼图块共用一个 GLProgramState，一次绘制完成
+// 四边形在 GPU 上由实例属性展开 (见 cocos2d::InstancedQuadCommand)
+attribute vec2 a_position; // 单位四边形的角 (0..1)
+attribute vec4 a_color;
+attribute vec4 a_instanceOrigin;
+attribute vec4 a_instanceAxes;
+attribute vec4 a_instanceTexCoordAxes;
+attribute vec4 a_instanceParams0; // 圆角半径: TR, BR, TL, BL
+attribute vec4 a_instanceParams1; // 描边显隐: Top, Right, Bottom, Left
+
+#ifdef GL_ES
+varying mediump vec2 v_texCoord;
+varying mediump vec4 v_fragmentColor;
+varying mediump vec2 v_pos;
+varying mediump vec2 v_localUV;
+varying mediump vec4 v_cornerRadii;
+varying mediump vec4 v_borderSides;
+#else
+varying vec2 v_texCoord;
+varying vec4 v_fragmentColor;
+varying vec2 v_pos;
+varying vec2 v_localUV;
+varying vec4 v_cornerRadii;
+varying vec4 v_borderSides;
+#endif
+
+void main()
+{
+    vec2 position = a_instanceOrigin.xy + a_instanceAxes.xy * a_position.x + a_instanceAxes.zw * a_position.y;
+    gl_Position = CC_PMatrix * vec4(position, 0.0, 1.0);
+    v_fragmentColor = a_color;
+    v_texCoord = a_instanceOrigin.zw + a_instanceTexCoordAxes.xy * a_position.x + a_instanceTexCoordAxes.zw * a_position.y;
+    v_pos = position;
+    // 与 u_uvRect 的计算结果一致：V 向下，顶部为 0
+    v_localUV = vec2(a_position.x, 1.0 - a_position.y);
+    v_cornerRadii = a_instanceParams0;
+    v_borderSides = a_instanceParams1;
+}
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "math/CCGeometry.h"
 #include "base/CCScriptSupport.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -324,6 +324,8 @@ private:
 class CC_DLL CallFunc : public ActionInstant
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(CallFunc)
+
     /** Creates the action with the callback of type std::function<void()>.
      This is the preferred way to create the callback.
      * When this function bound in js or lua ,the input param will be changed.
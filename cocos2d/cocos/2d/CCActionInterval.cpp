@@ -39,9 +39,14 @@ THE SOFTWARE.
 #include "base/CCEventDispatcher.h"
 #include "platform/CCStdC.h"
 #include "base/CCScriptSupport.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Sequence, 64)
+CC_DEFINE_ALLOCATOR_POOL(MoveTo, 128)
+CC_DEFINE_ALLOCATOR_POOL(FadeTo, 64)
+
 // Extra action for making a Sequence or Spawn when only adding one action to it.
 class ExtraAction : public FiniteTimeAction
 {
@@ -114,7 +119,7 @@ bool ActionInterval::isDone() const
     return _done;
 }
 
-void ActionInterval::step(float dt)
+float ActionInterval::advance(float dt)
 {
     if (_firstTick)
     {
@@ -127,9 +132,14 @@ void ActionInterval::step(float dt)
     }
     
     
-    float updateDt = std::max(0.0f,                                  // needed for rewind. elapsed could be negative
-                              std::min(1.0f, _elapsed / _duration)
-                              );
+    return std::max(0.0f,                                  // needed for rewind. elapsed could be negative
+                    std::min(1.0f, _elapsed / _duration)
+                    );
+}
+
+void ActionInterval::step(float dt)
+{
+    float updateDt = advance(dt);
 
     if (sendUpdateEventToScript(updateDt, this)) return;
     
@@ -1290,6 +1300,17 @@ MoveTo* MoveTo::clone() const
     return MoveTo::create(_duration, _endPosition);
 }
 
+void MoveTo::stepTween(float dt)
+{
+    float updateDt = advance(dt);
+
+    if (sendUpdateEventToScript(updateDt, this)) return;
+
+    MoveBy::update(updateDt);
+
+    _done = _elapsed >= _duration;
+}
+
 void MoveTo::startWithTarget(Node *target)
 {
     MoveBy::startWithTarget(target);
@@ -2273,6 +2294,17 @@ void FadeTo::update(float time)
     }
 }
 
+void FadeTo::stepTween(float dt)
+{
+    float updateDt = advance(dt);
+
+    if (sendUpdateEventToScript(updateDt, this)) return;
+
+    FadeTo::update(updateDt);
+
+    _done = _elapsed >= _duration;
+}
+
 //
 // TintTo
 //
@@ -120,6 +120,8 @@ protected:
     
 protected:
     bool sendUpdateEventToScript(float dt, Action *actionObject);
+    /** Advances the elapsed time by dt, and returns the normalized time to update the action with. */
+    float advance(float dt);
 };
 
 /** @class Sequence
@@ -128,6 +130,8 @@ protected:
 class CC_DLL Sequence : public ActionInterval
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(Sequence)
+
     /** Helper constructor to create an array of sequenceable actions.
      *
      * @return An autoreleased Sequence object.
@@ -643,6 +647,8 @@ private:
 class CC_DLL MoveTo : public MoveBy
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(MoveTo)
+
     /** 
      * Creates the action.
      * @param duration Duration time, in seconds.
@@ -664,6 +670,11 @@ public:
     virtual MoveTo* clone() const override;
     virtual MoveTo* reverse() const  override;
     virtual void startWithTarget(Node *target) override;
+
+    /** Same as step(), without virtual calls. Used by ActionManager to step all the MoveTo actions together.
+     * @param dt In seconds.
+     */
+    void stepTween(float dt);
     
 CC_CONSTRUCTOR_ACCESS:
     MoveTo() {}
@@ -1230,6 +1241,8 @@ private:
 class CC_DLL FadeTo : public ActionInterval
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(FadeTo)
+
     /** 
      * Creates an action with duration and opacity.
      * @param duration Duration time, in seconds.
@@ -1248,6 +1261,11 @@ public:
      * @param time In seconds.
      */
     virtual void update(float time) override;
+
+    /** Same as step(), without virtual calls. Used by ActionManager to step all the FadeTo actions together.
+     * @param dt In seconds.
+     */
+    void stepTween(float dt);
     
 CC_CONSTRUCTOR_ACCESS:
     FadeTo() {}
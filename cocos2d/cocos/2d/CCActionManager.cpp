@@ -30,30 +30,22 @@ THE SOFTWARE.
 #include "2d/CCActionManager.h"
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
-#include "base/ccCArray.h"
-#include "base/uthash.h"
+
+#include <typeinfo>
 
 NS_CC_BEGIN
 //
 // singleton stuff
 //
-typedef struct _hashElement
-{
-    struct _ccArray     *actions;
-    Node                *target;
-    int                 actionIndex;
-    Action              *currentAction;
-    bool                currentActionSalvaged;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashElement;
-
 ActionManager::ActionManager()
-: _targets(nullptr),
-  _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+: _freeActionSlot(UINT32_MAX),
+  _tweenLaneHoles(0),
+  _currentTween(nullptr),
+  _currentTweenSalvaged(false),
+  _updating(false)
 {
 
 }
@@ -67,39 +59,115 @@ ActionManager::~ActionManager()
 
 // private
 
-void ActionManager::deleteHashElement(tHashElement *element)
+ActionManager::TweenLane ActionManager::tweenLaneOf(const Action *action)
+{
+    // exact types only: a subclass may override update()
+    const std::type_info& type = typeid(*action);
+    if (type == typeid(MoveTo))
+    {
+        return TweenLane::MOVE_TO;
+    }
+    if (type == typeid(FadeTo))
+    {
+        return TweenLane::FADE_TO;
+    }
+    return TweenLane::NONE;
+}
+
+ActionManager::Element* ActionManager::findElement(const Node *target)
 {
-    ccArrayFree(element->actions);
-    HASH_DEL(_targets, element);
-    element->target->release();
-    free(element);
+    auto iter = _targetIndices.find(target);
+    return iter != _targetIndices.end() ? &_targets[iter->second] : nullptr;
+}
+
+const ActionManager::Element* ActionManager::findElement(const Node *target) const
+{
+    auto iter = _targetIndices.find(target);
+    return iter != _targetIndices.end() ? &_targets[iter->second] : nullptr;
+}
+
+uint32_t ActionManager::allocActionSlot(Action *action)
+{
+    uint32_t slot = _freeActionSlot;
+    if (slot != UINT32_MAX)
+    {
+        _freeActionSlot = _actionSlots[slot].nextFree;
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(_actionSlots.size());
+        _actionSlots.push_back({nullptr, 0, UINT32_MAX, TweenLane::NONE, 0, false});
+    }
+
+    _actionSlots[slot].action = action;
+    return slot;
 }
 
-void ActionManager::actionAllocWithHashElement(tHashElement *element)
+void ActionManager::freeActionSlot(uint32_t slot)
 {
-    // 4 actions per Node by default
-    if (element->actions == nullptr)
+    auto& actionSlot = _actionSlots[slot];
+    if (actionSlot.lane != TweenLane::NONE)
     {
-        element->actions = ccArrayNew(4);
-    }else 
-    if (element->actions->num == element->actions->max)
+        // leave a hole, the lanes may be iterated right now
+        _tweenLanes[(int)actionSlot.lane][actionSlot.laneIndex].action = nullptr;
+        actionSlot.lane = TweenLane::NONE;
+        ++_tweenLaneHoles;
+    }
+    actionSlot.action = nullptr;
+    // stale handles of the removed action no longer match
+    ++actionSlot.generation;
+    actionSlot.nextFree = _freeActionSlot;
+    _freeActionSlot = slot;
+}
+
+void ActionManager::deleteElement(size_t index)
+{
+    // take the element out before releasing anything: releasing an action may remove other actions
+    Element element = std::move(_targets[index]);
+    _targetIndices.erase(element.target);
+    // keep the order of the other targets, they are updated in that order
+    _targets.erase(_targets.begin() + index);
+    for (size_t i = index; i < _targets.size(); ++i)
     {
-        ccArrayDoubleCapacity(element->actions);
+        _targetIndices[_targets[i].target] = i;
     }
 
+    releaseElement(element);
 }
 
-void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
+void ActionManager::releaseElement(Element& element)
 {
-    Action *action = static_cast<Action*>(element->actions->arr[index]);
+    for (auto& running : element.actions)
+    {
+        freeActionSlot(running.slot);
+        running.action->release();
+    }
+    element.target->release();
+}
 
+void ActionManager::salvageCurrentAction(Element *element, Action *action)
+{
+    // the action being stepped is released after its step
     if (action == element->currentAction && (! element->currentActionSalvaged))
     {
         element->currentAction->retain();
         element->currentActionSalvaged = true;
     }
+    else if (action == _currentTween && (! _currentTweenSalvaged))
+    {
+        _currentTween->retain();
+        _currentTweenSalvaged = true;
+    }
+}
+
+void ActionManager::removeActionAtIndex(ssize_t index, Element *element)
+{
+    RunningAction running = element->actions[index];
 
-    ccArrayRemoveObjectAtIndex(element->actions, index, true);
+    salvageCurrentAction(element, running.action);
+
+    element->actions.erase(element->actions.begin() + index);
+    freeActionSlot(running.slot);
 
     // update actionIndex in case we are in tick. looping over the actions
     if (element->actionIndex >= index)
@@ -107,38 +175,41 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->actionIndex--;
     }
 
-    if (element->actions->num == 0)
+    // while updating, the empty elements are removed after the loop (issue #481)
+    if (element->actions.empty() && !_updating)
     {
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            deleteHashElement(element);
-        }
+        deleteElement(element - _targets.data());
     }
+
+    running.action->release();
 }
 
 // pause / resume
 
+void ActionManager::setElementPaused(Element *element, bool paused)
+{
+    element->paused = paused;
+    for (const auto& running : element->actions)
+    {
+        _actionSlots[running.slot].paused = paused;
+    }
+}
+
 void ActionManager::pauseTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
     if (element)
     {
-        element->paused = true;
+        setElementPaused(element, true);
     }
 }
 
 void ActionManager::resumeTarget(Node *target)
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
     if (element)
     {
-        element->paused = false;
+        setElementPaused(element, false);
     }
 }
 
@@ -146,12 +217,12 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
 {
     Vector<Node*> idsWithActions;
     
-    for (tHashElement *element=_targets; element != nullptr; element = (tHashElement *)element->hh.next) 
+    for (auto& element : _targets)
     {
-        if (! element->paused) 
+        if (! element.paused && ! element.actions.empty())
         {
-            element->paused = true;
-            idsWithActions.pushBack(element->target);
+            setElementPaused(&element, true);
+            idsWithActions.pushBack(element.target);
         }
     }    
     
@@ -175,35 +246,101 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
     if(action == nullptr || target == nullptr)
         return;
 
-    tHashElement *element = nullptr;
-    // we should convert it to Ref*, because we save it as Ref*
-    Ref *tmp = target;
-    HASH_FIND_PTR(_targets, &tmp, element);
+    Element *element = findElement(target);
     if (! element)
     {
-        element = (tHashElement*)calloc(sizeof(*element), 1);
+        _targetIndices[target] = _targets.size();
+        _targets.push_back(Element());
+        element = &_targets.back();
+        element->target = target;
+        element->actionIndex = 0;
+        element->currentAction = nullptr;
+        element->currentActionSalvaged = false;
         element->paused = paused;
         target->retain();
-        element->target = target;
-        HASH_ADD_PTR(_targets, target, element);
+        // 4 actions per Node by default
+        element->actions.reserve(4);
+    }
+    else if (element->actions.empty())
+    {
+        // emptied during update, it is reused as a new element
+        element->paused = paused;
     }
 
-     actionAllocWithHashElement(element);
- 
-     CCASSERT(! ccArrayContainsObject(element->actions, action), "action already be added!");
-     ccArrayAppendObject(element->actions, action);
- 
-     action->startWithTarget(target);
+#if COCOS2D_DEBUG > 0
+    for (const auto& running : element->actions)
+    {
+        CCASSERT(running.action != action, "action already be added!");
+    }
+#endif
+
+    action->retain();
+    uint32_t slot = allocActionSlot(action);
+    TweenLane lane = tweenLaneOf(action);
+    element->actions.push_back({action, slot, lane});
+
+    auto& actionSlot = _actionSlots[slot];
+    actionSlot.paused = element->paused;
+    actionSlot.lane = lane;
+    if (lane != TweenLane::NONE)
+    {
+        auto& tweens = _tweenLanes[(int)lane];
+        actionSlot.laneIndex = static_cast<uint32_t>(tweens.size());
+        tweens.push_back({action, slot, lane});
+    }
+
+    action->startWithTarget(target);
+}
+
+ActionManager::Handle ActionManager::getActionHandle(const Action *action) const
+{
+    Handle handle;
+    if (action == nullptr)
+    {
+        return handle;
+    }
+
+    const Element *element = findElement(action->getOriginalTarget());
+    if (element)
+    {
+        for (const auto& running : element->actions)
+        {
+            if (running.action == action)
+            {
+                handle.index = running.slot;
+                handle.generation = _actionSlots[running.slot].generation;
+                break;
+            }
+        }
+    }
+
+    return handle;
+}
+
+Action* ActionManager::getAction(const Handle& handle) const
+{
+    if (handle.index >= _actionSlots.size())
+    {
+        return nullptr;
+    }
+
+    const auto& actionSlot = _actionSlots[handle.index];
+    return actionSlot.generation == handle.generation ? actionSlot.action : nullptr;
 }
 
 // remove
 
 void ActionManager::removeAllActions()
 {
-    for (tHashElement *element = _targets; element != nullptr; )
+    std::vector<Node*> targets;
+    targets.reserve(_targets.size());
+    for (const auto& element : _targets)
+    {
+        targets.push_back(element.target);
+    }
+
+    for (auto target : targets)
     {
-        auto target = element->target;
-        element = (tHashElement*)element->hh.next;
         removeAllActionsFromTarget(target);
     }
 }
@@ -216,24 +353,26 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
         return;
     }
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
     if (element)
     {
-        if (ccArrayContainsObject(element->actions, element->currentAction) && (! element->currentActionSalvaged))
+        std::vector<RunningAction> actions;
+        actions.swap(element->actions);
+
+        for (const auto& running : actions)
         {
-            element->currentAction->retain();
-            element->currentActionSalvaged = true;
+            salvageCurrentAction(element, running.action);
+            freeActionSlot(running.slot);
         }
 
-        ccArrayRemoveAllObjects(element->actions);
-        if (_currentTarget == element)
+        if (! _updating)
         {
-            _currentTargetSalvaged = true;
+            deleteElement(element - _targets.data());
         }
-        else
+
+        for (const auto& running : actions)
         {
-            deleteHashElement(element);
+            running.action->release();
         }
     }
 }
@@ -246,19 +385,26 @@ void ActionManager::removeAction(Action *action)
         return;
     }
 
-    tHashElement *element = nullptr;
-    Ref *target = action->getOriginalTarget();
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(action->getOriginalTarget());
     if (element)
     {
-        auto i = ccArrayGetIndexOfObject(element->actions, action);
-        if (i != CC_INVALID_INDEX)
+        auto limit = element->actions.size();
+        for (size_t i = 0; i < limit; ++i)
         {
-            removeActionAtIndex(i, element);
+            if (element->actions[i].action == action)
+            {
+                removeActionAtIndex(i, element);
+                break;
+            }
         }
     }
 }
 
+void ActionManager::removeAction(const Handle& handle)
+{
+    removeAction(getAction(handle));
+}
+
 void ActionManager::removeActionByTag(int tag, Node *target)
 {
     CCASSERT(tag != Action::INVALID_TAG, "Invalid tag value!");
@@ -268,15 +414,14 @@ void ActionManager::removeActionByTag(int tag, Node *target)
         return;
     }
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
 
     if (element)
     {
-        auto limit = element->actions->num;
-        for (int i = 0; i < limit; ++i)
+        auto limit = element->actions.size();
+        for (size_t i = 0; i < limit; ++i)
         {
-            Action *action = static_cast<Action*>(element->actions->arr[i]);
+            Action *action = element->actions[i].action;
 
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
@@ -296,19 +441,24 @@ void ActionManager::removeAllActionsByTag(int tag, Node *target)
         return;
     }
     
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
     
     if (element)
     {
-        auto limit = element->actions->num;
-        for (int i = 0; i < limit;)
+        auto limit = element->actions.size();
+        for (size_t i = 0; i < limit;)
         {
-            Action *action = static_cast<Action*>(element->actions->arr[i]);
+            Action *action = element->actions[i].action;
 
             if (action->getTag() == (int)tag && action->getOriginalTarget() == target)
             {
+                // the element may be deleted with its last action
+                bool last = (limit == 1);
                 removeActionAtIndex(i, element);
+                if (last)
+                {
+                    break;
+                }
                 --limit;
             }
             else
@@ -331,19 +481,24 @@ void ActionManager::removeActionsByFlags(unsigned int flags, Node *target)
         return;
     }
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    Element *element = findElement(target);
 
     if (element)
     {
-        auto limit = element->actions->num;
-        for (int i = 0; i < limit;)
+        auto limit = element->actions.size();
+        for (size_t i = 0; i < limit;)
         {
-            Action *action = static_cast<Action*>(element->actions->arr[i]);
+            Action *action = element->actions[i].action;
 
             if ((action->getFlags() & flags) != 0 && action->getOriginalTarget() == target)
             {
+                // the element may be deleted with its last action
+                bool last = (limit == 1);
                 removeActionAtIndex(i, element);
+                if (last)
+                {
+                    break;
+                }
                 --limit;
             }
             else
@@ -356,28 +511,19 @@ void ActionManager::removeActionsByFlags(unsigned int flags, Node *target)
 
 // get
 
-// FIXME: Passing "const O *" instead of "const O&" because HASH_FIND_IT requires the address of a pointer
-// and, it is not possible to get the address of a reference
 Action* ActionManager::getActionByTag(int tag, const Node *target) const
 {
     CCASSERT(tag != Action::INVALID_TAG, "Invalid tag value!");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    const Element *element = findElement(target);
 
     if (element)
     {
-        if (element->actions != nullptr)
+        for (const auto& running : element->actions)
         {
-            auto limit = element->actions->num;
-            for (int i = 0; i < limit; ++i)
+            if (running.action->getTag() == (int)tag)
             {
-                Action *action = static_cast<Action*>(element->actions->arr[i]);
-
-                if (action->getTag() == (int)tag)
-                {
-                    return action;
-                }
+                return running.action;
             }
         }
     }
@@ -385,39 +531,31 @@ Action* ActionManager::getActionByTag(int tag, const Node *target) const
     return nullptr;
 }
 
-// FIXME: Passing "const O *" instead of "const O&" because HASH_FIND_IT requires the address of a pointer
-// and, it is not possible to get the address of a reference
 ssize_t ActionManager::getNumberOfRunningActionsInTarget(const Node *target) const
 {
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    const Element *element = findElement(target);
     if (element)
     {
-        return element->actions ? element->actions->num : 0;
+        return element->actions.size();
     }
 
     return 0;
 }
 
-// FIXME: Passing "const O *" instead of "const O&" because HASH_FIND_IT requires the address of a pointer
-// and, it is not possible to get the address of a reference
 size_t ActionManager::getNumberOfRunningActionsInTargetByTag(const Node *target,
                                                              int tag)
 {
     CCASSERT(tag != Action::INVALID_TAG, "Invalid tag value!");
 
-    tHashElement *element = nullptr;
-    HASH_FIND_PTR(_targets, &target, element);
+    const Element *element = findElement(target);
 
-    if(!element || !element->actions)
+    if(!element)
         return 0;
 
     int count = 0;
-    auto limit = element->actions->num;
-    for(int i = 0; i < limit; ++i)
+    for (const auto& running : element->actions)
     {
-        auto action = static_cast<Action*>(element->actions->arr[i]);
-        if(action->getTag() == tag)
+        if(running.action->getTag() == tag)
             ++count;
     }
 
@@ -427,78 +565,162 @@ size_t ActionManager::getNumberOfRunningActionsInTargetByTag(const Node *target,
 ssize_t ActionManager::getNumberOfRunningActions() const
 {
     ssize_t count = 0;
-    struct _hashElement* element = nullptr;
-    struct _hashElement* tmp = nullptr;
-    HASH_ITER(hh, _targets, element, tmp)
+    for (const auto& element : _targets)
     {
-        count += (element->actions ? element->actions->num : 0);
+        count += element.actions.size();
     }
     return count;
 }
 
+template <typename T>
+void ActionManager::stepTweenLane(TweenLane lane, float dt)
+{
+    // tweens added while stepping are appended, and stepped in the same frame
+    for (size_t i = 0; i < _tweenLanes[(int)lane].size(); ++i)
+    {
+        const RunningAction tween = _tweenLanes[(int)lane][i];
+        if (tween.action == nullptr || _actionSlots[tween.slot].paused)
+        {
+            continue;
+        }
+
+        T *action = static_cast<T*>(tween.action);
+        _currentTween = action;
+        _currentTweenSalvaged = false;
+
+        action->stepTween(dt);
+
+        if (_currentTweenSalvaged)
+        {
+            // removed during its step, see salvageCurrentAction()
+            action->release();
+        }
+        else if (action->T::isDone())
+        {
+            action->T::stop();
+
+            _currentTween = nullptr;
+            removeAction(action);
+        }
+
+        _currentTween = nullptr;
+    }
+}
+
+void ActionManager::compactTweenLanes()
+{
+    if (_tweenLaneHoles == 0)
+    {
+        return;
+    }
+
+    for (auto& tweens : _tweenLanes)
+    {
+        size_t kept = 0;
+        for (const auto& tween : tweens)
+        {
+            if (tween.action != nullptr)
+            {
+                _actionSlots[tween.slot].laneIndex = static_cast<uint32_t>(kept);
+                tweens[kept++] = tween;
+            }
+        }
+        tweens.resize(kept);
+    }
+    _tweenLaneHoles = 0;
+}
+
 // main loop
 void ActionManager::update(float dt)
 {
-    for (tHashElement *elt = _targets; elt != nullptr; )
+    _updating = true;
+
+    // targets added while stepping are appended, and stepped in the same frame
+    for (size_t i = 0; i < _targets.size(); ++i)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        Element *element = &_targets[i];
+        if (element->paused)
+        {
+            continue;
+        }
 
-        if (! _currentTarget->paused)
+        // The 'actions' array may change while inside this loop.
+        for (element->actionIndex = 0; element->actionIndex < (int)element->actions.size(); element->actionIndex++)
         {
-            // The 'actions' MutableArray may change while inside this loop.
-            for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
-                _currentTarget->actionIndex++)
+            const RunningAction& running = element->actions[element->actionIndex];
+            if (running.lane != TweenLane::NONE)
             {
-                _currentTarget->currentAction = static_cast<Action*>(_currentTarget->actions->arr[_currentTarget->actionIndex]);
-                if (_currentTarget->currentAction == nullptr)
-                {
-                    continue;
-                }
+                // stepped with its lane below
+                continue;
+            }
 
-                _currentTarget->currentActionSalvaged = false;
+            Action *action = running.action;
+            element->currentAction = action;
+            element->currentActionSalvaged = false;
 
-                _currentTarget->currentAction->step(dt);
+            action->step(dt);
 
-                if (_currentTarget->currentActionSalvaged)
-                {
-                    // The currentAction told the node to remove it. To prevent the action from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    _currentTarget->currentAction->release();
-                } else
-                if (_currentTarget->currentAction->isDone())
-                {
-                    _currentTarget->currentAction->stop();
+            // adding an action to a new target may have moved the elements
+            element = &_targets[i];
 
-                    Action *action = _currentTarget->currentAction;
-                    // Make currentAction nil to prevent removeAction from salvaging it.
-                    _currentTarget->currentAction = nullptr;
-                    removeAction(action);
-                }
+            if (element->currentActionSalvaged)
+            {
+                // The currentAction told the node to remove it. To prevent the action from
+                // accidentally deallocating itself before finishing its step, we retained
+                // it. Now that step is done, it's safe to release it.
+                action->release();
+            } else
+            if (action->isDone())
+            {
+                action->stop();
 
-                _currentTarget->currentAction = nullptr;
+                element = &_targets[i];
+                // Make currentAction nil to prevent removeAction from salvaging it.
+                element->currentAction = nullptr;
+                removeAction(action);
             }
+
+            element->currentAction = nullptr;
         }
+    }
+
+    // the MoveTo and FadeTo actions of all the targets, one type at a time
+    stepTweenLane<MoveTo>(TweenLane::MOVE_TO, dt);
+    stepTweenLane<FadeTo>(TweenLane::FADE_TO, dt);
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashElement*)(elt->hh.next);
+    _updating = false;
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->actions->num == 0)
+    // only delete the elements which have no actions scheduled during the cycle (issue #481)
+    // if some node reference 'target', it's reference count >= 2 (issues #14050)
+    // the kept elements keep their order, the deleted ones are released once the array is consistent again
+    std::vector<Element> deleted;
+    size_t kept = 0;
+    for (size_t i = 0; i < _targets.size(); ++i)
+    {
+        Element& element = _targets[i];
+        if (element.actions.empty() || element.target->getReferenceCount() == 1)
         {
-            deleteHashElement(_currentTarget);
+            _targetIndices.erase(element.target);
+            deleted.push_back(std::move(element));
         }
-        //if some node reference 'target', it's reference count >= 2 (issues #14050)
-        else if (_currentTarget->target->getReferenceCount() == 1)
+        else
         {
-            deleteHashElement(_currentTarget);
+            if (kept != i)
+            {
+                _targets[kept] = std::move(element);
+                _targetIndices[_targets[kept].target] = kept;
+            }
+            ++kept;
         }
     }
+    _targets.resize(kept);
+
+    for (auto& element : deleted)
+    {
+        releaseElement(element);
+    }
 
-    // issue #635
-    _currentTarget = nullptr;
+    compactTweenLanes();
 }
 
 NS_CC_END
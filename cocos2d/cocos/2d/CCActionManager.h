@@ -30,6 +30,10 @@ THE SOFTWARE.
 #ifndef __ACTION_CCACTION_MANAGER_H__
 #define __ACTION_CCACTION_MANAGER_H__
 
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
 #include "2d/CCAction.h"
 #include "base/CCVector.h"
 #include "base/CCRef.h"
@@ -38,8 +42,6 @@ NS_CC_BEGIN
 
 class Action;
 
-struct _hashElement;
-
 /**
  * @addtogroup actions
  * @{
@@ -53,12 +55,31 @@ struct _hashElement;
  Examples:
     - When you want to run an action where the target is different from a Node. 
     - When you want to pause / resume the actions.
+
+ The targets are stored in a contiguous array, found through a hash map, and the running actions of a target in a
+ contiguous array too. The targets are updated in the order they got their first action.
+ Each running action gets a generational Handle, which can be kept to stop or query the action
+ without keeping a reference to it: once the action is removed, the handle is stale and refers to nothing.
+ The MoveTo and FadeTo actions, allocated from their own pools, are also kept in a contiguous lane per type and are
+ stepped together after the other actions, without virtual calls.
  
  @since v0.8
  */
 class CC_DLL ActionManager : public Ref
 {
 public:
+    /** Generational reference to a running action. */
+    struct Handle
+    {
+        Handle() : index(UINT32_MAX), generation(0) {}
+
+        /** Whether the handle was returned for an action, it may be stale. */
+        bool isValid() const { return index != UINT32_MAX; }
+
+        uint32_t index;
+        uint32_t generation;
+    };
+
     /**
      * @js ctor
      */
@@ -83,6 +104,34 @@ public:
      */
     virtual void addAction(Action *action, Node *target, bool paused);
 
+    /** Returns the handle of a running action, an invalid handle if the action is not running.
+     *
+     * @param action    A certain action.
+     * @js NA
+     */
+    Handle getActionHandle(const Action *action) const;
+
+    /** Returns the action of a handle, nullptr if it stopped.
+     *
+     * @param handle    The handle of the action.
+     * @js NA
+     */
+    Action* getAction(const Handle& handle) const;
+
+    /** Whether the action of a handle is running.
+     *
+     * @param handle    The handle of the action.
+     * @js NA
+     */
+    bool isActionRunning(const Handle& handle) const { return getAction(handle) != nullptr; }
+
+    /** Removes the action of a handle, if it is running.
+     *
+     * @param handle    The handle of the action.
+     * @js NA
+     */
+    void removeAction(const Handle& handle);
+
     /** Removes all actions from all the targets.
      */
     virtual void removeAllActions();
@@ -200,16 +249,74 @@ public:
     virtual void update(float dt);
     
 protected:
-    // declared in ActionManager.m
+    // exact action types stepped together, see update()
+    enum class TweenLane : uint8_t
+    {
+        NONE,
+        MOVE_TO,
+        FADE_TO,
+        COUNT
+    };
+
+    struct RunningAction
+    {
+        Action* action;
+        uint32_t slot;
+        TweenLane lane;
+    };
+
+    struct Element
+    {
+        Node* target;
+        std::vector<RunningAction> actions;
+        int actionIndex;
+        Action* currentAction;
+        bool currentActionSalvaged;
+        bool paused;
+    };
+
+    struct ActionSlot
+    {
+        Action* action;
+        uint32_t generation;
+        uint32_t nextFree;
+        // position in the lane of the action, if it has one
+        TweenLane lane;
+        uint32_t laneIndex;
+        // copy of the paused state of the target, read by the lanes
+        bool paused;
+    };
 
-    void removeActionAtIndex(ssize_t index, struct _hashElement *element);
-    void deleteHashElement(struct _hashElement *element);
-    void actionAllocWithHashElement(struct _hashElement *element);
+    static TweenLane tweenLaneOf(const Action* action);
+    Element* findElement(const Node* target);
+    const Element* findElement(const Node* target) const;
+    void removeActionAtIndex(ssize_t index, Element *element);
+    void deleteElement(size_t index);
+    void releaseElement(Element& element);
+    void setElementPaused(Element* element, bool paused);
+    void salvageCurrentAction(Element* element, Action* action);
+    uint32_t allocActionSlot(Action* action);
+    void freeActionSlot(uint32_t slot);
+    template <typename T>
+    void stepTweenLane(TweenLane lane, float dt);
+    void compactTweenLanes();
 
 protected:
-    struct _hashElement    *_targets;
-    struct _hashElement    *_currentTarget;
-    bool            _currentTargetSalvaged;
+    std::vector<Element> _targets;
+    std::unordered_map<const Node*, size_t> _targetIndices;
+
+    // running actions by handle index, the free slots are linked by nextFree
+    std::vector<ActionSlot> _actionSlots;
+    uint32_t _freeActionSlot;
+
+    // running MoveTo and FadeTo actions by type, removed actions leave holes until the end of update()
+    std::vector<RunningAction> _tweenLanes[(int)TweenLane::COUNT];
+    size_t _tweenLaneHoles;
+    Action* _currentTween;
+    bool _currentTweenSalvaged;
+
+    // while updating, the targets without actions are removed after the loop
+    bool _updating;
 };
 
 // end of actions group
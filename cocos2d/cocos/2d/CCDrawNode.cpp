@@ -446,6 +446,7 @@ void DrawNode::drawPoint(const Vec2& position, const float pointSize, const Colo
     
     _bufferCountGLPoint += 1;
     _dirtyGLPoint = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, const Color4F &color)
@@ -467,6 +468,7 @@ void DrawNode::drawPoints(const Vec2 *position, unsigned int numberOfPoints, con
     
     _bufferCountGLPoint += numberOfPoints;
     _dirtyGLPoint = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -483,6 +485,7 @@ void DrawNode::drawLine(const Vec2 &origin, const Vec2 &destination, const Color
     
     _bufferCountGLLine += 2;
     _dirtyGLLine = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -668,6 +671,7 @@ void DrawNode::drawDot(const Vec2 &pos, float radius, const Color4F &color)
     _bufferCount += vertex_count;
     
     _dirty = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawRect(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, const Vec2& p4, const Color4F &color)
@@ -749,6 +753,7 @@ void DrawNode::drawSegment(const Vec2 &from, const Vec2 &to, float radius, const
     _bufferCount += vertex_count;
     
     _dirty = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColor, float borderWidth, const Color4F &borderColor)
@@ -832,6 +837,7 @@ void DrawNode::drawPolygon(const Vec2 *verts, int count, const Color4F &fillColo
     _bufferCount += vertex_count;
     
     _dirty = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawSolidRect(const Vec2 &origin, const Vec2 &destination, const Color4F &color)
@@ -895,6 +901,7 @@ void DrawNode::drawTriangle(const Vec2 &p1, const Vec2 &p2, const Vec2 &p3, cons
 
     _bufferCount += vertex_count;
     _dirty = true;
+    invalidateStaticSubtree();
 }
 
 void DrawNode::drawQuadraticBezier(const Vec2& from, const Vec2& control, const Vec2& to, unsigned int segments, const Color4F &color)
@@ -910,6 +917,7 @@ void DrawNode::clear()
     _dirtyGLLine = true;
     _bufferCountGLPoint = 0;
     _dirtyGLPoint = true;
+    invalidateStaticSubtree();
     _lineWidth = _defaultLineWidth;
 }
 
@@ -36,6 +36,10 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCJobSystem.h"
+#include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
+#include "xxhash.h"
 
 NS_CC_BEGIN
 
@@ -43,6 +47,61 @@ const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
+const char* FontAtlas::CMD_GLYPHS_READY = "__cc_FONTATLAS_GLYPHS_READY";
+bool FontAtlas::s_persistentCacheEnabled = CC_ENABLE_FONT_ATLAS_PERSISTENT_CACHE != 0;
+
+namespace {
+
+const char PERSISTENT_CACHE_MAGIC[4] = { 'C', 'C', 'F', 'A' };
+// increase it when the layout of the file or the glyph rendering changes
+const uint32_t PERSISTENT_CACHE_VERSION = 1;
+
+struct PersistentCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t fontDataHash;
+    uint32_t settingsHash;
+    uint32_t letterDefinitionSize;
+    uint32_t pageWidth;
+    uint32_t pageHeight;
+    uint32_t bytesPerPixel;
+    uint32_t pageCount;
+    uint32_t letterCount;
+    float currentPageOrigX;
+    float currentPageOrigY;
+    float lineHeight;
+    int32_t currLineHeight;
+};
+
+struct PersistentCacheLetter
+{
+    uint32_t utf32Char;
+    FontLetterDefinition definition;
+};
+
+}
+
+struct FontAtlas::GlyphBatch
+{
+    struct Glyph
+    {
+        char32_t utf32Char;
+        unsigned int charCode;
+        Rect rect;
+        int xAdvance;
+        long bitmapWidth;
+        long bitmapHeight;
+        // the rendered glyph with its padding, as renderCharAt writes it in the page data
+        long pixelsWidth;
+        std::vector<unsigned char> pixels;
+    };
+
+    std::vector<Glyph> glyphs;
+    JobSystem::Handle job;
+    // set by the cocos2d thread when the atlas is reset, the job stops and the glyphs are dropped
+    std::atomic<bool> cancelled;
+};
 
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
@@ -53,6 +112,8 @@ FontAtlas::FontAtlas(Font &theFont)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _currLineHeight(0)
+, _asyncGlyphRasterization(CC_ENABLE_ASYNC_GLYPH_RASTERIZATION != 0)
+, _persistentCacheDirty(false)
 {
     _font->retain();
 
@@ -113,6 +174,9 @@ void FontAtlas::reinit()
 
 FontAtlas::~FontAtlas()
 {
+    cancelGlyphBatches();
+    savePersistentCache();
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     if (_fontFreeType && _rendererRecreatedListener)
     {
@@ -138,6 +202,8 @@ FontAtlas::~FontAtlas()
 
 void FontAtlas::reset()
 {
+    cancelGlyphBatches();
+    savePersistentCache();
     releaseTextures();
     
     _currLineHeight = 0;
@@ -145,6 +211,8 @@ void FontAtlas::reset()
     _currentPageOrigX = 0;
     _currentPageOrigY = 0;
     _letterDefinitions.clear();
+    _fullPagesData.clear();
+    _persistentCacheDirty = false;
     
     reinit();
 }
@@ -342,7 +410,7 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     } 
  
-    if (!_currentPageData)
+    if (!_currentPageData && !loadPersistentCache())
         reinit();     
  
     std::unordered_map<unsigned int, unsigned int> codeMapOfNewChar;
@@ -352,17 +420,19 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
+    if (_asyncGlyphRasterization)
+    {
+        requestGlyphs(codeMapOfNewChar);
+        return true;
+    }
+
     long bitmapWidth;
     long bitmapHeight;
-    int glyphHeight;
+    int posX;
+    int posY;
     Rect tempRect;
     FontLetterDefinition tempDef;
 
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
-
     float startY = _currentPageOrigY;
 
     for (auto&& it : codeMapOfNewChar)
@@ -370,67 +440,8 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
         if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
         {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
-
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
-            {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
-                {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
-                }
-            }
-            glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
-            if (glyphHeight > _currLineHeight)
-            {
-                _currLineHeight = glyphHeight;
-            }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
+            placeLetterDefinition(tempRect, bitmapHeight, startY, tempDef, posX, posY);
+            _fontFreeType->renderCharAt(_currentPageData, posX, posY, bitmap, bitmapWidth, bitmapHeight);
         }
         else{
             if(bitmap)
@@ -453,8 +464,81 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         _letterDefinitions[it.first] = tempDef;
     }
 
+    updateCurrentPageTexture(startY, _currentPageOrigY - startY + _currLineHeight);
+    _persistentCacheDirty = true;
+
+    return true;
+}
+
+void FontAtlas::placeLetterDefinition(const Rect& glyphRect, long bitmapHeight, float& startY, FontLetterDefinition& letterDefinition, int& posX, int& posY)
+{
+    int adjustForDistanceMap = _letterPadding / 2;
+    int adjustForExtend = _letterEdgeExtend / 2;
+    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+
+    letterDefinition.validDefinition = true;
+    letterDefinition.width = glyphRect.size.width + _letterPadding + _letterEdgeExtend;
+    letterDefinition.height = glyphRect.size.height + _letterPadding + _letterEdgeExtend;
+    letterDefinition.offsetX = glyphRect.origin.x - adjustForDistanceMap - adjustForExtend;
+    letterDefinition.offsetY = _fontAscender + glyphRect.origin.y - adjustForDistanceMap - adjustForExtend;
+
+    if (_currentPageOrigX + letterDefinition.width > CacheTextureWidth)
+    {
+        _currentPageOrigY += _currLineHeight;
+        _currLineHeight = 0;
+        _currentPageOrigX = 0;
+        if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
+        {
+            updateCurrentPageTexture(startY, CacheTextureHeight - startY);
+
+            startY = 0.0f;
+
+            if (s_persistentCacheEnabled)
+            {
+                _fullPagesData.emplace_back(_currentPageData, _currentPageData + _currentPageDataSize);
+            }
+            _currentPageOrigY = 0;
+            memset(_currentPageData, 0, _currentPageDataSize);
+            _currentPage++;
+            auto tex = new (std::nothrow) Texture2D;
+            if (_antialiasEnabled)
+            {
+                tex->setAntiAliasTexParameters();
+            }
+            else
+            {
+                tex->setAliasTexParameters();
+            }
+            tex->initWithData(_currentPageData, _currentPageDataSize,
+                pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+            addTexture(tex, _currentPage);
+            tex->release();
+        }
+    }
+    int glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
+    if (glyphHeight > _currLineHeight)
+    {
+        _currLineHeight = glyphHeight;
+    }
+    posX = _currentPageOrigX + adjustForExtend;
+    posY = _currentPageOrigY + adjustForExtend;
+
+    letterDefinition.U = _currentPageOrigX;
+    letterDefinition.V = _currentPageOrigY;
+    letterDefinition.textureID = _currentPage;
+    _currentPageOrigX += letterDefinition.width + 1;
+    // take from pixels to points
+    letterDefinition.width = letterDefinition.width / scaleFactor;
+    letterDefinition.height = letterDefinition.height / scaleFactor;
+    letterDefinition.U = letterDefinition.U / scaleFactor;
+    letterDefinition.V = letterDefinition.V / scaleFactor;
+}
+
+void FontAtlas::updateCurrentPageTexture(float startY, float height)
+{
     unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    if (_fontFreeType->getOutlineSize() > 0)
     {
         data = _currentPageData + CacheTextureWidth * (int)startY * 2;
     }
@@ -462,8 +546,420 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
     {
         data = _currentPageData + CacheTextureWidth * (int)startY;
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
+    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, height);
+}
+
+void FontAtlas::setAsyncGlyphRasterization(bool enabled)
+{
+    if (!enabled && !_glyphBatches.empty())
+    {
+        // the cocos2d thread loads the glyphs in the face from now on, finish the requested ones first
+        for (auto&& batch : _glyphBatches)
+        {
+            JobSystem::getInstance()->wait(batch->job);
+        }
+        commitGlyphBatches(0);
+    }
+    _asyncGlyphRasterization = enabled;
+}
+
+void FontAtlas::prewarmGlyphs(const std::u32string& utf32Text)
+{
+    prepareLetterDefinitions(utf32Text);
+}
+
+bool FontAtlas::hasPendingGlyphs(const std::u32string& utf32Text) const
+{
+    if (_pendingGlyphs.empty())
+    {
+        return false;
+    }
+
+    for (auto utf32Char : utf32Text)
+    {
+        if (_pendingGlyphs.find(utf32Char) != _pendingGlyphs.end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FontAtlas::isGlyphPending(char32_t utf32Char) const
+{
+    return !_pendingGlyphs.empty() && _pendingGlyphs.find(utf32Char) != _pendingGlyphs.end();
+}
+
+void FontAtlas::requestGlyphs(const std::unordered_map<unsigned int, unsigned int>& codeMapOfNewChar)
+{
+    auto batch = std::make_shared<GlyphBatch>();
+    batch->cancelled = false;
+    batch->glyphs.resize(codeMapOfNewChar.size());
+
+    // the placeholders keep findNewCharacters from requesting the glyphs again until they are ready
+    FontLetterDefinition placeholder;
+    memset(&placeholder, 0, sizeof(placeholder));
+    placeholder.validDefinition = false;
+
+    size_t index = 0;
+    for (auto&& it : codeMapOfNewChar)
+    {
+        auto& glyph = batch->glyphs[index++];
+        glyph.utf32Char = it.first;
+        glyph.charCode = it.second;
+        glyph.bitmapWidth = 0;
+        glyph.bitmapHeight = 0;
+        glyph.xAdvance = 0;
+        _letterDefinitions[it.first] = placeholder;
+        _pendingGlyphs.insert(it.first);
+    }
+
+    // the glyphs of a face are loaded in the same slot, the batches of an atlas run one after another
+    std::vector<JobSystem::Handle> dependencies;
+    if (!_glyphBatches.empty())
+    {
+        dependencies.push_back(_glyphBatches.back()->job);
+    }
+
+    FontFreeType* font = _fontFreeType;
+    int padding = _letterPadding;
+    int bytesPerPixel = font->getOutlineSize() > 0 ? 2 : 1;
+    GlyphBatch* rasterized = batch.get();
+    batch->job = JobSystem::getInstance()->schedule([font, padding, bytesPerPixel, rasterized]() {
+        for (auto&& glyph : rasterized->glyphs)
+        {
+            if (rasterized->cancelled)
+            {
+                return;
+            }
+
+            long bitmapWidth = 0;
+            long bitmapHeight = 0;
+            auto bitmap = font->getGlyphBitmap(glyph.charCode, bitmapWidth, bitmapHeight, glyph.rect, glyph.xAdvance);
+            if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
+            {
+                glyph.bitmapWidth = bitmapWidth;
+                glyph.bitmapHeight = bitmapHeight;
+                glyph.pixelsWidth = bitmapWidth + padding;
+                glyph.pixels.assign(glyph.pixelsWidth * (bitmapHeight + padding) * bytesPerPixel, 0);
+                font->renderCharAt(glyph.pixels.data(), 0, 0, bitmap, bitmapWidth, bitmapHeight, (int)glyph.pixelsWidth);
+            }
+            else if (bitmap)
+            {
+                delete[] bitmap;
+            }
+        }
+    }, dependencies, JobSystem::Priority::HIGH);
+
+    if (_glyphBatches.empty())
+    {
+        Director::getInstance()->getScheduler()->schedule(CC_SCHEDULE_SELECTOR(FontAtlas::commitGlyphBatches), this, 0, false);
+    }
+    _glyphBatches.push_back(batch);
+}
+
+void FontAtlas::cancelGlyphBatches()
+{
+    if (_glyphBatches.empty())
+    {
+        return;
+    }
+
+    // the jobs use the font, wait for the running one, the others stop before their first glyph
+    for (auto&& batch : _glyphBatches)
+    {
+        batch->cancelled = true;
+    }
+    for (auto&& batch : _glyphBatches)
+    {
+        JobSystem::getInstance()->wait(batch->job);
+    }
+    _glyphBatches.clear();
+
+    // drop the placeholders so that the glyphs are requested again
+    for (auto utf32Char : _pendingGlyphs)
+    {
+        _letterDefinitions.erase(utf32Char);
+    }
+    _pendingGlyphs.clear();
+    Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(FontAtlas::commitGlyphBatches), this);
+}
+
+void FontAtlas::commitGlyphBatches(float /*dt*/)
+{
+    size_t doneCount = 0;
+    while (doneCount < _glyphBatches.size() && _glyphBatches[doneCount]->job.isDone())
+    {
+        ++doneCount;
+    }
+    if (doneCount == 0)
+    {
+        return;
+    }
+
+    int bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    int posX;
+    int posY;
+    float startY = _currentPageOrigY;
+
+    for (size_t batchIndex = 0; batchIndex < doneCount; ++batchIndex)
+    {
+        for (auto&& glyph : _glyphBatches[batchIndex]->glyphs)
+        {
+            FontLetterDefinition tempDef;
+            tempDef.xAdvance = glyph.xAdvance;
+            if (!glyph.pixels.empty())
+            {
+                placeLetterDefinition(glyph.rect, glyph.bitmapHeight, startY, tempDef, posX, posY);
+
+                long pixelsHeight = (long)glyph.pixels.size() / (glyph.pixelsWidth * bytesPerPixel);
+                for (long y = 0; y < pixelsHeight; ++y)
+                {
+                    memcpy(_currentPageData + ((posY + y) * CacheTextureWidth + posX) * bytesPerPixel,
+                        glyph.pixels.data() + y * glyph.pixelsWidth * bytesPerPixel, glyph.pixelsWidth * bytesPerPixel);
+                }
+            }
+            else
+            {
+                tempDef.validDefinition = tempDef.xAdvance != 0;
+                tempDef.width = 0;
+                tempDef.height = 0;
+                tempDef.U = 0;
+                tempDef.V = 0;
+                tempDef.offsetX = 0;
+                tempDef.offsetY = 0;
+                tempDef.textureID = 0;
+                _currentPageOrigX += 1;
+            }
+
+            _letterDefinitions[glyph.utf32Char] = tempDef;
+            _pendingGlyphs.erase(glyph.utf32Char);
+        }
+    }
+    _glyphBatches.erase(_glyphBatches.begin(), _glyphBatches.begin() + doneCount);
+
+    // the glyphs of all the batches done this frame are uploaded at once
+    updateCurrentPageTexture(startY, _currentPageOrigY - startY + _currLineHeight);
+    _persistentCacheDirty = true;
+
+    if (_glyphBatches.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(FontAtlas::commitGlyphBatches), this);
+    }
+
+    // keep the atlas while the labels update, the last one using it may release it
+    retain();
+    Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(CMD_GLYPHS_READY, this);
+    release();
+}
+
+void FontAtlas::setPersistentCacheEnabled(bool enabled)
+{
+    s_persistentCacheEnabled = enabled;
+}
+
+uint32_t FontAtlas::getPersistentCacheSettingsHash() const
+{
+    struct
+    {
+        float fontSize;
+        float outlineSize;
+        float contentScaleFactor;
+        int distanceFieldEnabled;
+        int letterPadding;
+        int letterEdgeExtend;
+        int encoding;
+    } settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.fontSize = _fontFreeType->getFontSize();
+    settings.outlineSize = _fontFreeType->getOutlineSize();
+    settings.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    settings.distanceFieldEnabled = _fontFreeType->isDistanceFieldEnabled() ? 1 : 0;
+    settings.letterPadding = _letterPadding;
+    settings.letterEdgeExtend = _letterEdgeExtend;
+    settings.encoding = (int)_fontFreeType->getEncoding();
+    return XXH32(&settings, sizeof(settings), 0);
+}
+
+std::string FontAtlas::getPersistentCachePath() const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%08x%08x.atlas", _fontFreeType->getFontDataHash(), getPersistentCacheSettingsHash());
+    return FileUtils::getInstance()->getWritablePath() + "fontatlas/" + name;
+}
+
+bool FontAtlas::loadPersistentCache()
+{
+    if (!s_persistentCacheEnabled || _fontFreeType == nullptr)
+    {
+        return false;
+    }
+
+    auto fileUtils = FileUtils::getInstance();
+    auto path = getPersistentCachePath();
+    if (!fileUtils->isFileExist(path))
+    {
+        return false;
+    }
+
+    // the pages are uploaded straight from the mapped file
+    auto file = fileUtils->mapFile(path);
+    if (!file || file->getSize() < (ssize_t)sizeof(PersistentCacheHeader))
+    {
+        return false;
+    }
+
+    PersistentCacheHeader header;
+    memcpy(&header, file->getBytes(), sizeof(header));
+    const uint32_t bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    const size_t pageSize = CacheTextureWidth * CacheTextureHeight * bytesPerPixel;
+    if (memcmp(header.magic, PERSISTENT_CACHE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != PERSISTENT_CACHE_VERSION
+        || header.fontDataHash != _fontFreeType->getFontDataHash()
+        || header.settingsHash != getPersistentCacheSettingsHash()
+        || header.letterDefinitionSize != sizeof(FontLetterDefinition)
+        || header.pageWidth != (uint32_t)CacheTextureWidth
+        || header.pageHeight != (uint32_t)CacheTextureHeight
+        || header.bytesPerPixel != bytesPerPixel
+        || header.pageCount == 0
+        || (size_t)file->getSize() != sizeof(header) + header.letterCount * sizeof(PersistentCacheLetter) + header.pageCount * pageSize)
+    {
+        CCLOG("FontAtlas: ignore the invalid persistent cache %s", path.c_str());
+        return false;
+    }
+
+    const unsigned char* bytes = file->getBytes() + sizeof(header);
+    for (uint32_t i = 0; i < header.letterCount; ++i)
+    {
+        PersistentCacheLetter letter;
+        memcpy(&letter, bytes, sizeof(letter));
+        bytes += sizeof(letter);
+        _letterDefinitions[letter.utf32Char] = letter.definition;
+    }
+
+    auto pixelFormat = bytesPerPixel == 2 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    for (uint32_t page = 0; page < header.pageCount; ++page)
+    {
+        auto tex = new (std::nothrow) Texture2D;
+        if (page > 0)
+        {
+            if (_antialiasEnabled)
+            {
+                tex->setAntiAliasTexParameters();
+            }
+            else
+            {
+                tex->setAliasTexParameters();
+            }
+        }
+        tex->initWithData(bytes, pageSize, pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+        addTexture(tex, page);
+        tex->release();
+
+        // the full pages are only kept to save the cache again, the file can't stay mapped while it is rewritten
+        if (page + 1 < header.pageCount)
+        {
+            _fullPagesData.emplace_back(bytes, bytes + pageSize);
+        }
+        else
+        {
+            _currentPageDataSize = (int)pageSize;
+            _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
+            memcpy(_currentPageData, bytes, pageSize);
+        }
+        bytes += pageSize;
+    }
+
+    _currentPage = header.pageCount - 1;
+    _currentPageOrigX = header.currentPageOrigX;
+    _currentPageOrigY = header.currentPageOrigY;
+    _currLineHeight = header.currLineHeight;
+    _lineHeight = header.lineHeight;
+    _persistentCacheDirty = false;
+    return true;
+}
+
+bool FontAtlas::savePersistentCache()
+{
+    if (!s_persistentCacheEnabled || !_persistentCacheDirty || _fontFreeType == nullptr || _currentPageData == nullptr)
+    {
+        return false;
+    }
+
+    // the cache was enabled after the first pages were filled, they are not available anymore
+    if (_fullPagesData.size() != (size_t)_currentPage)
+    {
+        return false;
+    }
+
+    // the placeholders of the glyphs which are not rasterized yet are not saved
+    uint32_t letterCount = 0;
+    for (auto&& it : _letterDefinitions)
+    {
+        if (!isGlyphPending(it.first))
+            ++letterCount;
+    }
+
+    PersistentCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PERSISTENT_CACHE_MAGIC, sizeof(header.magic));
+    header.version = PERSISTENT_CACHE_VERSION;
+    header.fontDataHash = _fontFreeType->getFontDataHash();
+    header.settingsHash = getPersistentCacheSettingsHash();
+    header.letterDefinitionSize = sizeof(FontLetterDefinition);
+    header.pageWidth = CacheTextureWidth;
+    header.pageHeight = CacheTextureHeight;
+    header.bytesPerPixel = _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+    header.pageCount = (uint32_t)_fullPagesData.size() + 1;
+    header.letterCount = letterCount;
+    header.currentPageOrigX = _currentPageOrigX;
+    header.currentPageOrigY = _currentPageOrigY;
+    header.lineHeight = _lineHeight;
+    header.currLineHeight = _currLineHeight;
+
+    const size_t pageSize = _currentPageDataSize;
+    const size_t size = sizeof(header) + letterCount * sizeof(PersistentCacheLetter) + header.pageCount * pageSize;
+    auto bytes = (unsigned char*)malloc(size);
+    if (bytes == nullptr)
+    {
+        return false;
+    }
+
+    unsigned char* out = bytes;
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (auto&& it : _letterDefinitions)
+    {
+        if (isGlyphPending(it.first))
+            continue;
+
+        PersistentCacheLetter letter;
+        memset(&letter, 0, sizeof(letter));
+        letter.utf32Char = it.first;
+        letter.definition = it.second;
+        memcpy(out, &letter, sizeof(letter));
+        out += sizeof(letter);
+    }
+    for (auto&& page : _fullPagesData)
+    {
+        memcpy(out, page.data(), pageSize);
+        out += pageSize;
+    }
+    memcpy(out, _currentPageData, pageSize);
+
+    Data data;
+    data.fastSet(bytes, size);
+
+    auto fileUtils = FileUtils::getInstance();
+    auto path = getPersistentCachePath();
+    fileUtils->createDirectory(path.substr(0, path.rfind('/') + 1));
+    if (!fileUtils->writeDataToFile(data, path))
+    {
+        CCLOG("FontAtlas: failed to write the persistent cache %s", path.c_str());
+        return false;
+    }
 
+    _persistentCacheDirty = false;
     return true;
 }
 
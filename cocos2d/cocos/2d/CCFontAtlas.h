@@ -29,12 +29,16 @@
 
 /// @cond DO_NOT_SHOW
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
 #include "platform/CCStdC.h" // ssize_t on windows
+#include "math/CCGeometry.h"
 
 NS_CC_BEGIN
 
@@ -64,6 +68,7 @@ public:
     static const int CacheTextureHeight;
     static const char* CMD_PURGE_FONTATLAS;
     static const char* CMD_RESET_FONTATLAS;
+    static const char* CMD_GLYPHS_READY;
     /**
      * @js ctor
      */
@@ -79,6 +84,37 @@ public:
     
     bool prepareLetterDefinitions(const std::u32string& utf16String);
 
+    /** Rasterizes the glyphs which are not in the atlas yet on the job system instead of the cocos2d thread.
+     Until a glyph is ready its letter definition is an invalid placeholder, so labels skip it. The finished
+     glyphs are added once per frame with one texture update, then CMD_GLYPHS_READY is dispatched with the
+     atlas as user data. Defaults to CC_ENABLE_ASYNC_GLYPH_RASTERIZATION, only TTF atlases are affected.
+     */
+    void setAsyncGlyphRasterization(bool enabled);
+    bool isAsyncGlyphRasterization() const { return _asyncGlyphRasterization; }
+
+    /** Adds the glyphs of the text to the atlas ahead of the labels using them, in the background when
+     asynchronous rasterization is enabled.
+     */
+    void prewarmGlyphs(const std::u32string& utf32Text);
+
+    /** Whether a glyph of the text was requested and is not rasterized yet. */
+    bool hasPendingGlyphs(const std::u32string& utf32Text) const;
+    bool isGlyphPending(char32_t utf32Char) const;
+
+    /** Enables the persistent cache of the TTF atlases. Their pages and letter definitions are saved under
+     FileUtils::getWritablePath() and loaded on the next launch instead of rasterizing the glyphs again.
+     The cache file is keyed by the font file content, the font size, the outline, the distance field and
+     the content scale factor. Defaults to CC_ENABLE_FONT_ATLAS_PERSISTENT_CACHE.
+     */
+    static void setPersistentCacheEnabled(bool enabled);
+    static bool isPersistentCacheEnabled() { return s_persistentCacheEnabled; }
+
+    /** Saves the atlas in the persistent cache if glyphs were added since it was loaded or saved.
+     It is done when the atlas is destroyed, call it when the application goes to the background
+     to keep the glyphs if the process is killed.
+     */
+    bool savePersistentCache();
+
     const std::unordered_map<ssize_t, Texture2D*>& getTextures() const { return _atlasTextures; }
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -120,6 +156,32 @@ protected:
 
     void findNewCharacters(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
+    struct GlyphBatch;
+
+    void requestGlyphs(const std::unordered_map<unsigned int, unsigned int>& codeMapOfNewChar);
+
+    void cancelGlyphBatches();
+
+    void commitGlyphBatches(float dt);
+
+    /**
+     * Reserves the room of a glyph in the current page, on a new line or a new page when it does not fit,
+     * and fills its letter definition in points.
+     *
+     * @param posX, posY Where the glyph bitmap goes in the page data, in pixels.
+     */
+    void placeLetterDefinition(const Rect& glyphRect, long bitmapHeight, float& startY, FontLetterDefinition& letterDefinition, int& posX, int& posY);
+
+    /** Uploads the rows of the current page data starting at startY. */
+    void updateCurrentPageTexture(float startY, float height);
+
+    bool loadPersistentCache();
+
+    /** Hash of the settings changing the rendered glyphs: size, outline, distance field, padding and encoding. */
+    uint32_t getPersistentCacheSettingsHash() const;
+
+    std::string getPersistentCachePath() const;
+
     void conversionU32TOGB2312(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
     /**
@@ -150,6 +212,16 @@ protected:
     bool _antialiasEnabled;
     int _currLineHeight;
 
+    // asynchronous glyph rasterization, the batches are committed in the order they were requested
+    bool _asyncGlyphRasterization;
+    std::unordered_set<char32_t> _pendingGlyphs;
+    std::vector<std::shared_ptr<GlyphBatch>> _glyphBatches;
+
+    // persistent cache, the full pages are kept to be saved with the current one
+    static bool s_persistentCacheEnabled;
+    std::vector<std::vector<unsigned char>> _fullPagesData;
+    bool _persistentCacheDirty;
+
     friend class Label;
 };
 
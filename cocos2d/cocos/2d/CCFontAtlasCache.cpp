@@ -31,6 +31,7 @@
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontCharMap.h"
 #include "2d/CCLabel.h"
+#include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
@@ -51,6 +52,14 @@ void FontAtlasCache::purgeCachedData()
     _atlasMap.clear();
 }
 
+void FontAtlasCache::savePersistentCache()
+{
+    for (auto&& atlas : _atlasMap)
+    {
+        atlas.second->savePersistentCache();
+    }
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 {
     auto realFontFilename = FileUtils::getInstance()->getNewFilename(config->fontFilePath);  // resolves real file path, to prevent storing multiple atlases for the same file.
@@ -88,6 +97,20 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+FontAtlas* FontAtlasCache::prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& text)
+{
+    auto atlas = getFontAtlasTTF(config);
+    if (atlas)
+    {
+        std::u32string utf32Text;
+        if (StringUtils::UTF8ToUTF32(text, utf32Text))
+        {
+            atlas->prewarmGlyphs(utf32Text);
+        }
+    }
+    return atlas;
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset /* = Vec2::ZERO */)
 {
     auto realFontFilename = FileUtils::getInstance()->getNewFilename(fontFileName);  // resolves real file path, to prevent storing multiple atlases for the same file.
@@ -42,6 +42,10 @@ class CC_DLL FontAtlasCache
 {  
 public:
     static FontAtlas* getFontAtlasTTF(const _ttfConfig* config);
+    /** Creates the atlas of the TTF config if needed and adds the glyphs of the text to it, so that the labels
+     created later with the config find them. The atlas stays in the cache until it is purged.
+     */
+    static FontAtlas* prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& text);
     static FontAtlas* getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset = Vec2::ZERO);
 
     static FontAtlas* getFontAtlasCharMap(const std::string& charMapFile, int itemWidth, int itemHeight, int startCharMap);
@@ -55,6 +59,9 @@ public:
      */
     static void purgeCachedData();
 
+    /** Saves the TTF atlases which have new glyphs in the persistent cache, see FontAtlas::setPersistentCacheEnabled(). */
+    static void savePersistentCache();
+
     /** Release current FNT texture and reload it.
      CAUTION : All component use this font texture should be reset font name, though the file name is same!
                otherwise, it will cause program crash!
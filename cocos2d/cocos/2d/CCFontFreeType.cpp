@@ -26,11 +26,15 @@ THE SOFTWARE.
 
 #include "2d/CCFontFreeType.h"
 #include FT_BBOX_H
-#include "edtaa3func.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
 #include "2d/CCFontAtlas.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
+#include "xxhash.h"
 
 NS_CC_BEGIN
 
@@ -46,10 +50,17 @@ typedef struct _DataRef
 {
     Data data;
     unsigned int referenceCount;
+    unsigned int hash;
+    bool hashed;
 }DataRef;
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
 
+// FreeType 2.5 renders with a raster pool shared by the whole library, glyphs may be
+// rasterized by the job system (see FontAtlas::setAsyncGlyphRasterization) so every
+// use of the library and of the faces goes through this lock
+static std::mutex s_freeTypeMutex;
+
 FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,float outline /* = 0 */)
 {
     FontFreeType *tempFont =  new (std::nothrow) FontFreeType(distanceFieldEnabled,outline);
@@ -86,6 +97,7 @@ void FontFreeType::shutdownFreeType()
 {
     if (_FTInitialized == true)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         FT_Done_FreeType(_FTlibrary);
         s_cacheFontData.clear();
         _FTInitialized = false;
@@ -105,6 +117,7 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outlin
 , _distanceFieldEnabled(distanceFieldEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
+, _fontSize(0.0f)
 , _fontAtlas(nullptr)
 , _usedGlyphs(GlyphCollection::ASCII)
 {
@@ -125,6 +138,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     FT_Face face;
     // save font name locally
     _fontName = fontName;
+    _fontSize = fontSize;
 
     auto it = s_cacheFontData.find(fontName);
     if (it != s_cacheFontData.end())
@@ -134,6 +148,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     else
     {
         s_cacheFontData[fontName].referenceCount = 1;
+        s_cacheFontData[fontName].hashed = false;
         s_cacheFontData[fontName].data = FileUtils::getInstance()->getDataFromFile(fontName);    
 
         if (s_cacheFontData[fontName].data.isNull())
@@ -142,6 +157,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
         }
     }
 
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
     if (FT_New_Memory_Face(getFTLibrary(), s_cacheFontData[fontName].data.getBytes(), s_cacheFontData[fontName].data.getSize(), 0, &face ))
         return false;
 
@@ -187,6 +203,7 @@ FontFreeType::~FontFreeType()
 {
     if (_FTInitialized)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         if (_stroker)
         {
             FT_Stroker_Done(_stroker);
@@ -245,6 +262,7 @@ int * FontFreeType::getHorizontalKerningForTextUTF32(const std::u32string& text,
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         for (int c = 1; c < outNumLetters; ++c)
         {
             sizes[c] = getHorizontalKerningForChars(text[c-1], text[c]);
@@ -281,6 +299,21 @@ int FontFreeType::getFontAscender() const
     return (static_cast<int>(_fontRef->size->metrics.ascender >> 6));
 }
 
+unsigned int FontFreeType::getFontDataHash() const
+{
+    auto it = s_cacheFontData.find(_fontName);
+    if (it == s_cacheFontData.end())
+        return 0;
+
+    auto& dataRef = it->second;
+    if (!dataRef.hashed)
+    {
+        dataRef.hash = XXH32(dataRef.data.getBytes(), (int)dataRef.data.getSize(), 0);
+        dataRef.hashed = true;
+    }
+    return dataRef.hash;
+}
+
 const char* FontFreeType::getFontFamily() const
 {
     if (!_fontRef)
@@ -291,6 +324,7 @@ const char* FontFreeType::getFontFamily() const
 
 unsigned char* FontFreeType::getGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance)
 {
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
     bool invalidChar = true;
     unsigned char* ret = nullptr;
 
@@ -460,88 +494,165 @@ unsigned char * FontFreeType::getGlyphBitmapWithOutline(uint64_t theChar, FT_BBo
     return ret;
 }
 
+namespace {
+
+const float DistanceInfinity = 1e20f;
+
+// One dimensional squared euclidean distance transform (Felzenszwalb & Huttenlocher) of the samples
+// grid[offset + k * stride]. Besides the squared distance it stores, for every sample, the position
+// along the line of the nearest site, so that the 2D pass can recover the nearest covered pixel.
+void distanceTransform1D(float *grid, int *nearest, long offset, long stride, long length,
+                         float *f, float *z, int *v)
+{
+    for (long q = 0; q < length; ++q)
+        f[q] = grid[offset + q * stride];
+
+    long k = 0;
+    v[0] = 0;
+    z[0] = -DistanceInfinity;
+    z[1] = DistanceInfinity;
+    for (long q = 1; q < length; ++q)
+    {
+        float s;
+        do
+        {
+            long r = v[k];
+            s = (f[q] - f[r] + (float)(q * q - r * r)) / (float)(2 * (q - r));
+        } while (s <= z[k] && --k >= 0);
+
+        ++k;
+        v[k] = (int)q;
+        z[k] = s;
+        z[k + 1] = DistanceInfinity;
+    }
+
+    k = 0;
+    for (long q = 0; q < length; ++q)
+    {
+        while (z[k + 1] < q)
+            ++k;
+        long r = v[k];
+        grid[offset + q * stride] = f[r] + (float)((q - r) * (q - r));
+        nearest[offset + q * stride] = (int)r;
+    }
+}
+
+struct DistanceMapScratch
+{
+    std::vector<float> coverage;
+    std::vector<float> outside;
+    std::vector<float> inside;
+    std::vector<float> grid;
+    std::vector<int> nearestRow;
+    std::vector<int> nearestColumn;
+    std::vector<float> f;
+    std::vector<float> z;
+    std::vector<int> v;
+};
+
+// Distance from every pixel to the contour of the area covered by 'coverage' (levels in [0, 1]).
+// The nearest pixel with any coverage is found with an exact linear time EDT, then the contour is
+// assumed to cross that pixel at (0.5 - coverage) from its center, like edtaa3 does for a pixel
+// without gradient information. Pixels inside the area get 0.
+void contourDistance(DistanceMapScratch &scratch, float *result, long width, long height)
+{
+    const float *coverage = scratch.coverage.data();
+    float *grid = scratch.grid.data();
+    int *nearestRow = scratch.nearestRow.data();
+    int *nearestColumn = scratch.nearestColumn.data();
+    long pixelAmount = width * height;
+
+    for (long i = 0; i < pixelAmount; ++i)
+        grid[i] = coverage[i] > 0.0f ? 0.0f : DistanceInfinity;
+
+    for (long x = 0; x < width; ++x)
+        distanceTransform1D(grid, nearestRow, x, width, height, scratch.f.data(), scratch.z.data(), scratch.v.data());
+    for (long y = 0; y < height; ++y)
+        distanceTransform1D(grid, nearestColumn, y * width, 1, width, scratch.f.data(), scratch.z.data(), scratch.v.data());
+
+    for (long y = 0; y < height; ++y)
+    {
+        for (long x = 0; x < width; ++x)
+        {
+            long i = y * width + x;
+            if (grid[i] >= DistanceInfinity)
+            {
+                result[i] = DistanceInfinity;
+                continue;
+            }
+            long siteX = nearestColumn[i];
+            long siteY = nearestRow[y * width + siteX];
+            float dist = std::sqrt(grid[i]) + 0.5f - coverage[siteY * width + siteX];
+            result[i] = dist > 0.0f ? dist : 0.0f;
+        }
+    }
+}
+
+}
+
 unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
 {
-    long pixelAmount = (width + 2 * FontFreeType::DistanceMapSpread) * (height + 2 * FontFreeType::DistanceMapSpread);
-
-    short * xdist = (short *)  malloc( pixelAmount * sizeof(short) );
-    short * ydist = (short *)  malloc( pixelAmount * sizeof(short) );
-    double * gx   = (double *) calloc( pixelAmount, sizeof(double) );
-    double * gy      = (double *) calloc( pixelAmount, sizeof(double) );
-    double * data    = (double *) calloc( pixelAmount, sizeof(double) );
-    double * outside = (double *) calloc( pixelAmount, sizeof(double) );
-    double * inside  = (double *) calloc( pixelAmount, sizeof(double) );
-    long i,j;
-
-    // Convert img into double (data) rescale image levels between 0 and 1
     long outWidth = width + 2 * FontFreeType::DistanceMapSpread;
-    for (i = 0; i < width; ++i)
+    long outHeight = height + 2 * FontFreeType::DistanceMapSpread;
+    long pixelAmount = outWidth * outHeight;
+
+    // glyphs are rasterized one after another, keep the working buffers around instead of
+    // allocating seven of them for every glyph
+    static thread_local DistanceMapScratch scratch;
+    long maxLength = std::max(outWidth, outHeight);
+    scratch.coverage.assign(pixelAmount, 0.0f);
+    scratch.outside.resize(pixelAmount);
+    scratch.inside.resize(pixelAmount);
+    scratch.grid.resize(pixelAmount);
+    scratch.nearestRow.resize(pixelAmount);
+    scratch.nearestColumn.resize(pixelAmount);
+    if ((long)scratch.f.size() < maxLength)
     {
-        for (j = 0; j < height; ++j)
+        scratch.f.resize(maxLength);
+        scratch.z.resize(maxLength + 1);
+        scratch.v.resize(maxLength);
+    }
+
+    // Convert img into float (coverage) rescale image levels between 0 and 1, the glyph is
+    // centered in the map with DistanceMapSpread pixels of padding on every side
+    for (long j = 0; j < height; ++j)
+    {
+        float *row = scratch.coverage.data() + (j + FontFreeType::DistanceMapSpread) * outWidth + FontFreeType::DistanceMapSpread;
+        for (long i = 0; i < width; ++i)
         {
-            data[j * outWidth + FontFreeType::DistanceMapSpread + i] = img[j * width + i] / 255.0;
+            row[i] = img[j * width + i] / 255.0f;
         }
     }
 
-    width += 2 * FontFreeType::DistanceMapSpread;
-    height += 2 * FontFreeType::DistanceMapSpread;
-
-    // Transform background (outside contour, in areas of 0's)   
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, outside);
-    for( i=0; i< pixelAmount; i++)
-        if( outside[i] < 0.0 )
-            outside[i] = 0.0;
-
-    // Transform foreground (inside contour, in areas of 1's)   
-    for( i=0; i< pixelAmount; i++)
-        data[i] = 1 - data[i];
-    computegradient( data, (int)width, (int)height, gx, gy);
-    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, inside);
-    for( i=0; i< pixelAmount; i++)
-        if( inside[i] < 0.0 )
-            inside[i] = 0.0;
+    // Transform background (outside contour, in areas of 0's)
+    contourDistance(scratch, scratch.outside.data(), outWidth, outHeight);
+
+    // Transform foreground (inside contour, in areas of 1's)
+    for (long i = 0; i < pixelAmount; ++i)
+        scratch.coverage[i] = 1.0f - scratch.coverage[i];
+    contourDistance(scratch, scratch.inside.data(), outWidth, outHeight);
 
     // The bipolar distance field is now outside-inside
-    double dist;
-    /* Single channel 8-bit output (bad precision and range, but simple) */    
+    /* Single channel 8-bit output (bad precision and range, but simple) */
     unsigned char *out = (unsigned char *) malloc( pixelAmount * sizeof(unsigned char) );
-    for( i=0; i < pixelAmount; i++)
+    for (long i = 0; i < pixelAmount; ++i)
     {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0 ) dist = 0;
-        if( dist > 255 ) dist = 255;
+        float dist = scratch.outside[i] - scratch.inside[i];
+        dist = 128.0f - dist * 16;
+        if (dist < 0.0f) dist = 0.0f;
+        if (dist > 255.0f) dist = 255.0f;
         out[i] = (unsigned char) dist;
     }
-    /* Dual channel 16-bit output (more complicated, but good precision and range) */
-    /*unsigned char *out = (unsigned char *) malloc( pixelAmount * 3 * sizeof(unsigned char) ); 
-    for( i=0; i< pixelAmount; i++)
-    {
-        dist = outside[i] - inside[i];
-        dist = 128.0 - dist*16;
-        if( dist < 0.0 ) dist = 0.0;
-        if( dist >= 256.0 ) dist = 255.999;
-        // R channel is a copy of the original grayscale image
-        out[3*i] = img[i];
-        // G channel is fraction
-        out[3*i + 1] = (unsigned char) ( 256 - (dist - floor(dist)* 256.0 ));
-        // B channel is truncated integer part
-        out[3*i + 2] = (unsigned char)dist; 
-    }*/
-    
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
-    free( data );
-    free( outside );
-    free( inside );
 
     return out;
 }
 
 void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight)
+{
+    renderCharAt(dest, posX, posY, bitmap, bitmapWidth, bitmapHeight, FontAtlas::CacheTextureWidth);
+}
+
+void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight, int destWidth)
 {
     int iX = posX;
     int iY = posY;
@@ -567,7 +678,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
                 dest[index + 2] = out[index2 + 2];*/
 
                 //Single channel 8-bit output 
-                dest[iX + ( iY * FontAtlas::CacheTextureWidth )] = distanceMap[bitmap_y + x];
+                dest[iX + ( iY * destWidth )] = distanceMap[bitmap_y + x];
 
                 iX += 1;
             }
@@ -587,9 +698,9 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
             for (int x = 0; x < bitmapWidth; ++x)
             {
                 tempChar = bitmap[(bitmap_y + x) * 2];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2] = tempChar;
                 tempChar = bitmap[(bitmap_y + x) * 2 + 1];
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) ) * 2 + 1] = tempChar;
+                dest[(iX + ( iY * destWidth ) ) * 2 + 1] = tempChar;
 
                 iX += 1;
             }
@@ -610,7 +721,7 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
                 unsigned char cTemp = bitmap[bitmap_y + x];
 
                 // the final pixel
-                dest[(iX + ( iY * FontAtlas::CacheTextureWidth ) )] = cTemp;
+                dest[(iX + ( iY * destWidth ) )] = cTemp;
 
                 iX += 1;
             }
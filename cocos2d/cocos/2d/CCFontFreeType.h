@@ -64,6 +64,8 @@ public:
     float getOutlineSize() const { return _outlineSize; }
 
     void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
+    /** Renders the glyph bitmap into a destination buffer which is destWidth pixels wide. */
+    void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight, int destWidth);
 
     FT_Encoding getEncoding() const { return _encoding; }
 
@@ -74,6 +76,9 @@ public:
     int getFontAscender() const;
     const char* getFontFamily() const;
     std::string getFontName() const { return _fontName; }
+    float getFontSize() const { return _fontSize; }
+    /** Hash of the content of the font file, computed once per file. */
+    unsigned int getFontDataHash() const;
 
     virtual FontAtlas* createFontAtlas() override;
     virtual int getFontMaxHeight() const override { return _lineHeight; }
@@ -108,6 +113,7 @@ private:
     bool _distanceFieldEnabled;
     float _outlineSize;
     int _lineHeight;
+    float _fontSize;
     FontAtlas* _fontAtlas;
 
     GlyphCollection _usedGlyphs;
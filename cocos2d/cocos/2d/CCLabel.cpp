@@ -387,6 +387,7 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 , _fontAtlas(nullptr)
 , _reusedLetter(nullptr)
 , _horizontalKernings(nullptr)
+, _kerningsFont(nullptr)
 , _boldEnabled(false)
 , _underlineNode(nullptr)
 , _strikethroughEnabled(false)
@@ -435,6 +436,15 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
         }
     });
     _eventDispatcher->addEventListenerWithFixedPriority(_resetTextureListener, 2);
+
+    _glyphsReadyListener = EventListenerCustom::create(FontAtlas::CMD_GLYPHS_READY, [this](EventCustom* event){
+        if (_waitingForGlyphs && _fontAtlas && event->getUserData() == _fontAtlas)
+        {
+            _contentDirty = true;
+            invalidateStaticSubtree();
+        }
+    });
+    _eventDispatcher->addEventListenerWithFixedPriority(_glyphsReadyListener, 3);
 }
 
 Label::~Label()
@@ -450,6 +460,7 @@ Label::~Label()
     }
     _eventDispatcher->removeEventListener(_purgeTextureListener);
     _eventDispatcher->removeEventListener(_resetTextureListener);
+    _eventDispatcher->removeEventListener(_glyphsReadyListener);
 
     CC_SAFE_RELEASE_NULL(_textSprite);
     CC_SAFE_RELEASE_NULL(_shadowNode);
@@ -523,6 +534,7 @@ void Label::reset()
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
     _isOpacityModifyRGB = false;
     _insideBounds = true;
+    _waitingForGlyphs = false;
     _enableWrap = true;
     _bmFontSize = -1;
     _bmfontScale = 1.0f;
@@ -597,6 +609,7 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
         return;
 
     CC_SAFE_RETAIN(atlas);
+    _kerningsFont = nullptr;
     if (_fontAtlas)
     {
         _batchNodes.clear();
@@ -616,6 +629,7 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
     {
         _lineHeight = _fontAtlas->getLineHeight();
         _contentDirty = true;
+        invalidateStaticSubtree();
         _systemFontDirty = false;
     }
     _useDistanceField = distanceFieldEnabled;
@@ -671,6 +685,7 @@ void Label::setString(const std::string& text)
     {
         _utf8Text = text;
         _contentDirty = true;
+        invalidateStaticSubtree();
 
         std::u32string utf32String;
         if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
@@ -695,6 +710,7 @@ void Label::setAlignment(TextHAlignment hAlignment,TextVAlignment vAlignment)
         _vAlignment = vAlignment;
 
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -704,6 +720,7 @@ void Label::setMaxLineWidth(float maxLineWidth)
     {
         _maxLineWidth = maxLineWidth;
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -721,6 +738,7 @@ void Label::setDimensions(float width, float height)
 
         _maxLineWidth = width;
         _contentDirty = true;
+        invalidateStaticSubtree();
 
         if(_overflow == Overflow::SHRINK){
             if (_originalFontSize > 0) {
@@ -748,7 +766,8 @@ void Label::setLineBreakWithoutSpace(bool breakWithoutSpace)
     if (breakWithoutSpace != _lineBreakWithoutSpaces)
     {
         _lineBreakWithoutSpaces = breakWithoutSpace;
-        _contentDirty = true;     
+        _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -821,6 +840,7 @@ bool Label::alignText()
     bool ret = true;
     do {
         _fontAtlas->prepareLetterDefinitions(_utf32Text);
+        _waitingForGlyphs = _fontAtlas->hasPendingGlyphs(_utf32Text);
         auto& textures = _fontAtlas->getTextures();
         auto size = textures.size();
         if (size > static_cast<size_t>(_batchNodes.size()))
@@ -880,8 +900,6 @@ bool Label::alignText()
         }
     
         updateLabelLetters();
-        
-        updateColor();
     }while (0);
 
     return ret;
@@ -889,19 +907,36 @@ bool Label::alignText()
 
 bool Label::computeHorizontalKernings(const std::u32string& stringToRender)
 {
+    auto font = _fontAtlas->getFont();
+    auto getKernings = [font](const std::u32string& text) {
+        int letterCount = 0;
+        return font->getHorizontalKerningForTextUTF32(text, letterCount);
+    };
+
+    if (font == _kerningsFont && LabelUtils::spliceHorizontalKernings(_horizontalKernings, _kerningsText, stringToRender, getKernings))
+    {
+        _kerningsText = stringToRender;
+        return true;
+    }
+
     if (_horizontalKernings)
     {
         delete [] _horizontalKernings;
         _horizontalKernings = nullptr;
     }
+    _kerningsText.clear();
+    _kerningsFont = nullptr;
 
-    int letterCount = 0;
-    _horizontalKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(stringToRender, letterCount);
+    _horizontalKernings = getKernings(stringToRender);
 
     if(!_horizontalKernings)
         return false;
     else
+    {
+        _kerningsText = stringToRender;
+        _kerningsFont = font;
         return true;
+    }
 }
 
 bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
@@ -918,9 +953,37 @@ bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
 bool Label::updateQuads()
 {
     bool ret = true;
-    for (auto&& batchNode : _batchNodes)
+
+    // the scale is the same for all the letters, the quads written with another one are all outdated
+    this->updateLetterSpriteScale(_reusedLetter);
+    Vec2 letterScale(_reusedLetter->getScaleX(), _reusedLetter->getScaleY());
+    if (letterScale != _batchQuadsScale)
+    {
+        _batchQuads.clear();
+        _batchQuadsScale = letterScale;
+    }
+
+    auto batchCount = _batchNodes.size();
+    _batchQuads.resize(batchCount);
+    for (ssize_t i = 0; i < batchCount; ++i)
+    {
+        auto textureAtlas = _batchNodes.at(i)->getTextureAtlas();
+        auto& batchQuads = _batchQuads[i];
+        if (batchQuads.textureAtlas != textureAtlas || (ssize_t)batchQuads.quads.size() != textureAtlas->getTotalQuads())
+        {
+            textureAtlas->removeAllQuads();
+            batchQuads.textureAtlas = textureAtlas;
+            batchQuads.quads.clear();
+        }
+    }
+    std::vector<int> quadCounts(batchCount, 0);
+
+    Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
+    if (_isOpacityModifyRGB)
     {
-        batchNode->getTextureAtlas()->removeAllQuads();
+        color4.r *= _displayedOpacity/255.0f;
+        color4.g *= _displayedOpacity/255.0f;
+        color4.b *= _displayedOpacity/255.0f;
     }
     
     for (int ctr = 0; ctr < _lengthOfString; ++ctr)
@@ -971,19 +1034,54 @@ bool Label::updateQuads()
 
             if (_reusedRect.size.height > 0.f && _reusedRect.size.width > 0.f)
             {
-                _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
                 float letterPositionX = _lettersInfo[ctr].positionX + _linesOffsetX[_lettersInfo[ctr].lineIndex];
-                _reusedLetter->setPosition(letterPositionX, py);
-                auto index = static_cast<int>(_batchNodes.at(letterDef.textureID)->getTextureAtlas()->getTotalQuads());
+                auto index = quadCounts[letterDef.textureID]++;
                 _lettersInfo[ctr].atlasIndex = index;
 
-                this->updateLetterSpriteScale(_reusedLetter);
+                if (!LabelUtils::recordLetterQuad(_batchQuads[letterDef.textureID].quads, index, _reusedRect, letterPositionX, py))
+                {
+                    continue;
+                }
+
+                _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
+                _reusedLetter->setPosition(letterPositionX, py);
+
+                auto batchNode = _batchNodes.at(letterDef.textureID);
+                auto textureAtlas = batchNode->getTextureAtlas();
+                if (index < textureAtlas->getTotalQuads())
+                {
+                    // the quad is there already, updateTransform writes it
+                    _reusedLetter->setBatchNode(batchNode);
+                    _reusedLetter->setAtlasIndex(index);
+                    _reusedLetter->setDirty(true);
+                    _reusedLetter->updateTransform();
+                }
+                else
+                {
+                    batchNode->insertQuadFromSprite(_reusedLetter, index);
+                }
 
-                _batchNodes.at(letterDef.textureID)->insertQuadFromSprite(_reusedLetter, index);
+                auto& quad = textureAtlas->getQuads()[index];
+                quad.bl.colors = color4;
+                quad.br.colors = color4;
+                quad.tl.colors = color4;
+                quad.tr.colors = color4;
+                textureAtlas->updateQuad(&quad, index);
             }
         }     
     }
 
+    // drop the quads of the letters which are gone
+    for (ssize_t i = 0; i < batchCount; ++i)
+    {
+        auto textureAtlas = _batchQuads[i].textureAtlas;
+        auto totalQuads = textureAtlas->getTotalQuads();
+        if (totalQuads > quadCounts[i])
+        {
+            textureAtlas->removeQuadsAtIndex(quadCounts[i], totalQuads - quadCounts[i]);
+        }
+        _batchQuads[i].quads.resize(quadCounts[i]);
+    }
 
     return ret;
 }
@@ -1034,6 +1132,7 @@ void Label::setBMFontSizeInternal(float fontSize)
     if(_currentLabelType == LabelType::BMFONT){
         this->setBMFontFilePath(_bmFontPath, Vec2::ZERO, fontSize);
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1070,6 +1169,7 @@ void Label::enableGlow(const Color4B& glowColor)
             config.distanceFieldEnabled = true;
             setTTFConfig(config);
             _contentDirty = true;
+            invalidateStaticSubtree();
         }
         _currLabelEffect = LabelEffect::GLOW;
         _effectColorF.r = glowColor.r / 255.0f;
@@ -1107,6 +1207,7 @@ void Label::enableOutline(const Color4B& outlineColor,int outlineSize /* = -1 */
             _effectColorF.a = outlineColor.a / 255.f;
             _currLabelEffect = LabelEffect::OUTLINE;
             _contentDirty = true;
+            invalidateStaticSubtree();
         }
         _outlineSize = outlineSize;
     }
@@ -1118,6 +1219,7 @@ void Label::enableShadow(const Color4B& shadowColor /* = Color4B::BLACK */,
 {
     _shadowEnabled = true;
     _shadowDirty = true;
+    invalidateStaticSubtree();
 
     _shadowOffset.width = offset.width;
     _shadowOffset.height = offset.height;
@@ -1186,6 +1288,7 @@ void Label::enableUnderline()
         _underlineNode = DrawNode::create();
         addChild(_underlineNode, 100000);
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1219,6 +1322,7 @@ void Label::disableEffect(LabelEffect effect)
                 }
                 _currLabelEffect = LabelEffect::NORMAL;
                 _contentDirty = true;
+                invalidateStaticSubtree();
             }
             break;
         case cocos2d::LabelEffect::SHADOW:
@@ -1738,6 +1842,7 @@ void Label::setSystemFontName(const std::string& systemFont)
         _systemFont = systemFont;
         _currentLabelType = LabelType::STRING_TEXTURE;
         _systemFontDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1749,6 +1854,7 @@ void Label::setSystemFontSize(float fontSize)
         _originalFontSize = fontSize;
         _currentLabelType = LabelType::STRING_TEXTURE;
         _systemFontDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1826,6 +1932,7 @@ void Label::setLineHeight(float height)
     {
         _lineHeight = height;
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1841,6 +1948,7 @@ void Label::setLineSpacing(float height)
     {
         _lineSpacing = height;
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -1858,6 +1966,7 @@ void Label::setAdditionalKerning(float space)
         {
             _additionalKerning = space;
             _contentDirty = true;
+            invalidateStaticSubtree();
         }
     }
     else
@@ -1947,6 +2056,7 @@ void Label::updateDisplayedColor(const Color3B& parentColor)
         // Correct solution is to update the DrawNode directly since we know it is
         // a line. Returning a pointer to the line is an option
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 
     for (auto&& it : _letters)
@@ -1984,6 +2094,7 @@ void Label::setTextColor(const Color4B &color)
     if (_currentLabelType == LabelType::STRING_TEXTURE && _textColor != color)
     {
         _contentDirty = true;
+        invalidateStaticSubtree();
     }
 
     _textColor = color;
@@ -2059,6 +2170,7 @@ void Label::setBlendFunc(const BlendFunc &blendFunc)
 {
     _blendFunc = blendFunc;
     _blendFuncDirty = true;
+    invalidateStaticSubtree();
     if (_textSprite)
     {
         _textSprite->setBlendFunc(blendFunc);
@@ -2174,6 +2286,7 @@ void Label::enableWrap(bool enable)
     this->rescaleWithOriginalFontSize();
     
     _contentDirty = true;
+    invalidateStaticSubtree();
 }
 
 bool Label::isWrapEnabled()const
@@ -2202,6 +2315,7 @@ void Label::setOverflow(Overflow overflow)
     this->rescaleWithOriginalFontSize();
     
     _contentDirty = true;
+    invalidateStaticSubtree();
 }
 
 void Label::rescaleWithOriginalFontSize()
@@ -31,6 +31,7 @@
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCQuadCommand.h"
 #include "2d/CCFontAtlas.h"
+#include "2d/CCLabelUtils.h"
 #include "base/ccTypes.h"
 
 NS_CC_BEGIN
@@ -85,6 +86,7 @@ typedef struct _ttfConfig
 
 class Sprite;
 class SpriteBatchNode;
+class TextureAtlas;
 class DrawNode;
 class EventListenerCustom;
 
@@ -648,6 +650,13 @@ protected:
         int lineIndex;
     };
 
+    // what updateQuads wrote in the quads of a batch node
+    struct BatchQuads
+    {
+        TextureAtlas* textureAtlas;
+        std::vector<LabelUtils::LetterQuad> quads;
+    };
+
     virtual void setFontAtlas(FontAtlas* atlas, bool distanceFieldEnabled = false, bool useA8Shader = false);
     bool getFontLetterDef(char32_t character, FontLetterDefinition& letterDef) const;
 
@@ -719,12 +728,18 @@ protected:
     Sprite *_reusedLetter;
     Rect _reusedRect;
     int _lengthOfString;
+    // the quads of the letters which did not move or change are not written again
+    std::vector<BatchQuads> _batchQuads;
+    Vec2 _batchQuadsScale;
 
     //layout relevant properties.
     float _lineHeight;
     float _lineSpacing;
     float _additionalKerning;
     int* _horizontalKernings;
+    // the text and the font of _horizontalKernings, only the kernings around the changed letters are computed again
+    std::u32string _kerningsText;
+    const Font* _kerningsFont;
     bool _lineBreakWithoutSpaces;
     float _maxLineWidth;
     Size _labelDimensions;
@@ -776,6 +791,9 @@ protected:
 
     EventListenerCustom* _purgeTextureListener;
     EventListenerCustom* _resetTextureListener;
+    EventListenerCustom* _glyphsReadyListener;
+    // some glyphs of the text are rasterized in the background, lay it out again when they are ready
+    bool _waitingForGlyphs;
 
 #if CC_LABEL_DEBUG_DRAW
     DrawNode* _debugDrawNode;
@@ -0,0 +1,149 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __COCOS2D_CCLABELUTILS_H__
+#define __COCOS2D_CCLABELUTILS_H__
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "math/CCGeometry.h"
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+NS_CC_BEGIN
+
+/** The parts of the Label update which only write the letters that changed since the previous update. */
+namespace LabelUtils
+{
+    /**
+     * Changes the kernings of a text to the ones of a new text, only the kernings around the letters which changed
+     * are computed again.
+     *
+     * @param kernings The kernings of oldText, allocated with new[], replaced by the ones of text.
+     * @param oldText The text of the kernings.
+     * @param text The new text.
+     * @param getKernings Returns the kernings of a part of the text allocated with new[] or nullptr, like
+     *        Font::getHorizontalKerningForTextUTF32.
+     * @return False if the kernings of the whole text must be computed instead, they are left unchanged then.
+     */
+    template <typename GetKernings>
+    bool spliceHorizontalKernings(int*& kernings, const std::u32string& oldText, const std::u32string& text,
+                                  GetKernings getKernings)
+    {
+        const size_t newLength = text.length();
+        const size_t oldLength = oldText.length();
+        if (kernings == nullptr || newLength == 0 || oldLength == 0)
+        {
+            return false;
+        }
+
+        // the kerning of a letter depends on it and on the previous one, keep the ones of the unchanged prefix and suffix
+        const size_t minLength = std::min(newLength, oldLength);
+        size_t prefix = 0;
+        while (prefix < minLength && text[prefix] == oldText[prefix])
+            ++prefix;
+        if (prefix == newLength && newLength == oldLength)
+            return true;
+
+        size_t suffix = 0;
+        while (suffix < minLength - prefix && text[newLength - 1 - suffix] == oldText[oldLength - 1 - suffix])
+            ++suffix;
+
+        const size_t begin = prefix > 0 ? prefix - 1 : 0;
+        const size_t end = std::min(newLength, newLength - suffix + 1);
+        int* changed = getKernings(text.substr(begin, end - begin));
+        if (changed == nullptr)
+        {
+            return false;
+        }
+
+        auto spliced = new (std::nothrow) int[newLength];
+        if (spliced == nullptr)
+        {
+            delete [] changed;
+            return false;
+        }
+
+        for (size_t i = 0; i <= begin; ++i)
+            spliced[i] = kernings[i];
+        for (size_t i = begin + 1; i < end; ++i)
+            spliced[i] = changed[i - begin];
+        for (size_t i = end; i < newLength; ++i)
+            spliced[i] = kernings[i + oldLength - newLength];
+        spliced[0] = 0;
+
+        delete [] changed;
+        delete [] kernings;
+        kernings = spliced;
+        return true;
+    }
+
+    /** What was written in a letter quad. */
+    struct LetterQuad
+    {
+        Rect rect;
+        float positionX;
+        float positionY;
+    };
+
+    /**
+     * Records what a letter quad is written with.
+     *
+     * @param quads What the quads were written with, indexed like them.
+     * @param index The index of the quad, at most the number of quads recorded.
+     * @return False if the quad was written with the same rect and position already, it is left as is then.
+     */
+    inline bool recordLetterQuad(std::vector<LetterQuad>& quads, int index, const Rect& rect, float positionX, float positionY)
+    {
+        if (index < (int)quads.size())
+        {
+            auto& written = quads[index];
+            if (written.positionX == positionX && written.positionY == positionY && written.rect.equals(rect))
+            {
+                return false;
+            }
+            written.rect = rect;
+            written.positionX = positionX;
+            written.positionY = positionY;
+        }
+        else
+        {
+            LetterQuad letterQuad = { rect, positionX, positionY };
+            quads.push_back(letterQuad);
+        }
+        return true;
+    }
+}
+
+NS_CC_END
+
+// end group
+/// @}
+
+#endif // __COCOS2D_CCLABELUTILS_H__
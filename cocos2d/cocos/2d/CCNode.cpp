@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "base/CCScheduler.h"
 #include "base/CCEventDispatcher.h"
 #include "base/ccUTF8.h"
+#include "base/ccSortUtils.h"
 #include "2d/CCCamera.h"
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
@@ -44,7 +45,9 @@ THE SOFTWARE.
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
+#include "renderer/CCRenderer.h"
 #include "math/TransformUtils.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 
 #if CC_NODE_RENDER_SUBPIXEL
@@ -56,9 +59,12 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Node, 128)
+
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 std::uint32_t Node::s_globalOrderOfArrival = 0;
 int Node::__attachedNodeCount = 0;
+int Node::s_staticSubtreeCount = 0;
 
 // MARK: Constructor, Destructor, Init
 
@@ -100,6 +106,8 @@ Node::Node()
 , _visible(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
+, _reorderPending(false)
+, _reorderedChildCount(0)
 , _isTransitionFinished(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
@@ -112,6 +120,9 @@ Node::Node()
 , _cascadeColorEnabled(false)
 , _cascadeOpacityEnabled(false)
 , _cameraMask(1)
+, _staticCommands(nullptr)
+, _staticCommandsCamera(nullptr)
+, _staticCommandsValid(false)
 , _onEnterCallback(nullptr)
 , _onExitCallback(nullptr)
 , _onEnterTransitionDidFinishCallback(nullptr)
@@ -176,6 +187,8 @@ Node::~Node()
     removeAllComponents();
     
     CC_SAFE_DELETE(_componentContainer);
+
+    setStaticSubtree(false);
     
     stopAllActions();
     unscheduleAllCallbacks();
@@ -251,6 +264,7 @@ void Node::setSkewX(float skewX)
     
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 float Node::getSkewY() const
@@ -265,6 +279,7 @@ void Node::setSkewY(float skewY)
     
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 void Node::setLocalZOrder(std::int32_t z)
@@ -298,6 +313,7 @@ void Node::setGlobalZOrder(float globalZOrder)
     if (_globalZOrder != globalZOrder)
     {
         _globalZOrder = globalZOrder;
+        invalidateStaticSubtree();
         _eventDispatcher->setDirtyForNode(this);
     }
 }
@@ -317,6 +333,7 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
     
     updateRotationQuat();
 }
@@ -334,6 +351,7 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -385,6 +403,7 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     updateRotation3D();
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -399,6 +418,7 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
     
     updateRotationQuat();
 }
@@ -415,6 +435,7 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
     
     updateRotationQuat();
 }
@@ -434,6 +455,7 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 /// scaleX getter
@@ -451,6 +473,7 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 /// scaleX setter
@@ -461,6 +484,7 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 /// scaleY getter
@@ -477,6 +501,7 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 /// scaleY getter
@@ -493,6 +518,7 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 
@@ -523,6 +549,7 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
     _usingNormalizedPosition = false;
 }
 
@@ -568,6 +595,7 @@ void Node::setPositionZ(float positionZ)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 
     _positionZ = positionZ;
 }
@@ -588,6 +616,7 @@ void Node::setPositionNormalized(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -609,6 +638,7 @@ void Node::setVisible(bool visible)
         _visible = visible;
         if(_visible)
             _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -630,6 +660,7 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -647,6 +678,7 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -661,6 +693,7 @@ void Node::setParent(Node * parent)
 {
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 /// isRelativeAnchorPoint getter
@@ -676,6 +709,7 @@ void Node::setIgnoreAnchorPointForPosition(bool newValue)
     {
         _ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        invalidateStaticSubtree();
     }
 }
 
@@ -741,6 +775,7 @@ void Node::setGLProgramState(cocos2d::GLProgramState* glProgramState)
 
         if (_glProgramState)
             _glProgramState->setNodeBinding(this);
+        invalidateStaticSubtree();
     }
 }
 
@@ -754,6 +789,7 @@ void Node::setGLProgram(GLProgram* glProgram)
         _glProgramState->retain();
 
         _glProgramState->setNodeBinding(this);
+        invalidateStaticSubtree();
     }
 }
 
@@ -1113,9 +1149,11 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
         // set parent nil at the end
         child->setParent(nullptr);
+        child->_reorderPending = false;
     }
     
     _children.clear();
+    _reorderedChildCount = 0;
 }
 
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
@@ -1143,9 +1181,16 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
         sEngine->releaseScriptObject(this, child);
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
+    invalidateStaticSubtree();
     // set parent nil at the end
     child->setParent(nullptr);
 
+    if (child->_reorderPending)
+    {
+        child->_reorderPending = false;
+        --_reorderedChildCount;
+    }
+
     _children.erase(childIndex);
 }
 
@@ -1162,30 +1207,84 @@ void Node::insertChild(Node* child, int z)
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
     _transformUpdated = true;
     _reorderChildDirty = true;
+    invalidateStaticSubtree();
     _children.pushBack(child);
     child->_setLocalZOrder(z);
+    child->_reorderPending = true;
+    ++_reorderedChildCount;
 }
 
 void Node::reorderChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Child must be non-nil");
     _reorderChildDirty = true;
+    invalidateStaticSubtree();
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
+    if (!child->_reorderPending)
+    {
+        child->_reorderPending = true;
+        ++_reorderedChildCount;
+    }
 }
 
 void Node::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        sortReorderedChildren();
         _reorderChildDirty = false;
         _eventDispatcher->setDirtyForNode(this);
     }
 }
 
+void Node::sortReorderedChildren()
+{
+    // the children which kept their order are still sorted, the reordered ones are merged back
+    static std::vector<Node*> moved;
+    utils::sortMovedElements(_children.begin(), _children.end(), _reorderedChildCount, moved,
+                             [](Node* child) {
+                                 bool reordered = child->_reorderPending;
+                                 child->_reorderPending = false;
+                                 return reordered;
+                             },
+                             localOrderLess);
+    _reorderedChildCount = 0;
+}
+
 // MARK: draw / visit
 
+void Node::setStaticSubtree(bool isStatic)
+{
+    if (isStatic == isStaticSubtree())
+        return;
+
+    if (isStatic)
+    {
+        _staticCommands = new (std::nothrow) RenderCommandRecording();
+        ++s_staticSubtreeCount;
+    }
+    else
+    {
+        CC_SAFE_DELETE(_staticCommands);
+        --s_staticSubtreeCount;
+    }
+    _staticCommandsValid = false;
+    _staticCommandsCamera = nullptr;
+}
+
+void Node::invalidateStaticSubtree()
+{
+    // fast path, most of the scenes don't use static subtrees
+    if (s_staticSubtreeCount == 0)
+        return;
+
+    for (Node* node = this; node != nullptr; node = node->_parent)
+    {
+        node->_staticCommandsValid = false;
+    }
+}
+
 void Node::draw()
 {
     auto renderer = _director->getRenderer();
@@ -1254,6 +1353,23 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+    // static subtree: add the commands recorded in a previous frame if nothing changed since then.
+    // a moved camera changes which descendants are culled, so the subtree is visited again
+    if (_staticCommands)
+    {
+        auto camera = Camera::getVisitingCamera();
+        if (_staticCommandsValid && !(flags & FLAGS_DIRTY_MASK) && _staticCommandsCamera == camera
+            && (camera == nullptr || !camera->isViewProjectionUpdated()))
+        {
+            renderer->addRecordedCommands(*_staticCommands);
+            return;
+        }
+
+        _staticCommands->clear();
+        _staticCommandsCamera = camera;
+        renderer->pushCommandRecording(_staticCommands);
+    }
+
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
@@ -1290,6 +1406,12 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     }
 
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+
+    if (_staticCommands)
+    {
+        renderer->popCommandRecording();
+        _staticCommandsValid = true;
+    }
     
     // FIX ME: Why need to set _orderOfArrival to 0??
     // Please refer to https://github.com/cocos2d/cocos2d-x/pull/6920
@@ -1808,6 +1930,7 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    invalidateStaticSubtree();
 
     if (_additionalTransform)
         // _additionalTransform[1] has a copy of lastest transform
@@ -1841,6 +1964,7 @@ void Node::setAdditionalTransform(const Mat4* additionalTransform)
         _additionalTransform[0] = *additionalTransform;
     }
     _transformUpdated = _additionalTransformDirty = _inverseDirty = true;
+    invalidateStaticSubtree();
 }
 
 void Node::setAdditionalTransform(const Mat4& additionalTransform)
@@ -2013,6 +2137,7 @@ void Node::updateDisplayedOpacity(GLubyte parentOpacity)
 {
     _displayedOpacity = _realOpacity * parentOpacity/255.0;
     updateColor();
+    invalidateStaticSubtree();
     
     if (_cascadeOpacityEnabled)
     {
@@ -2100,6 +2225,7 @@ void Node::updateDisplayedColor(const Color3B& parentColor)
     _displayedColor.g = _realColor.g * parentColor.g/255.0;
     _displayedColor.b = _realColor.b * parentColor.b/255.0;
     updateColor();
+    invalidateStaticSubtree();
     
     if (_cascadeColorEnabled)
     {
@@ -35,6 +35,7 @@
 #include "base/CCVector.h"
 #include "base/CCProtocols.h"
 #include "base/CCScriptSupport.h"
+#include "base/allocator/CCAllocatorMacros.h"
 #include "math/CCAffineTransform.h"
 #include "math/CCMath.h"
 #include "2d/CCComponentContainer.h"
@@ -57,6 +58,7 @@ class ComponentContainer;
 class EventDispatcher;
 class Scene;
 class Renderer;
+class RenderCommandRecording;
 class Director;
 class GLProgram;
 class GLProgramState;
@@ -109,6 +111,8 @@ class EventListener;
 class CC_DLL Node : public Ref
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(Node)
+
     /** Default tag used for all the nodes */
     static const int INVALID_TAG = -1;
 
@@ -957,6 +961,19 @@ public:
 #endif
     }
 
+    /**
+    * Whether a sibling node is sorted before another one, in the order of sortNodes.
+    *
+    */
+    static bool localOrderLess(const Node* n1, const Node* n2)
+    {
+#if CC_64BITS
+        return n1->_localZOrder$Arrival < n2->_localZOrder$Arrival;
+#else
+        return (n1->_localZOrder == n2->_localZOrder && n1->_orderOfArrival < n2->_orderOfArrival) || n1->_localZOrder < n2->_localZOrder;
+#endif
+    }
+
     /// @} end of Children and Parent
     
     /// @{
@@ -1180,6 +1197,34 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Sets whether the node is the root of a static subtree.
+     * A static subtree records the render commands generated by the node and its descendants once, and adds the
+     * same commands again in the following frames without visiting them, until the transform, color, texture or
+     * children of any node in the subtree change, or the camera moves.
+     * The vertices of the replayed triangles commands are transformed once and reused by the following frames.
+     * Labels, particle systems and draw nodes invalidate the subtree when their content changes; other nodes whose
+     * rendering changes in other ways must call invalidateStaticSubtree() themselves, or should not be added to a
+     * static subtree.
+     * Only nodes using Node::visit() can be the root of a static subtree.
+     *
+     * @param isStatic True to record and replay the render commands of the subtree.
+     */
+    void setStaticSubtree(bool isStatic);
+
+    /**
+     * Returns whether the node is the root of a static subtree.
+     *
+     * @return True if the node is the root of a static subtree.
+     */
+    bool isStaticSubtree() const { return _staticCommands != nullptr; }
+
+    /**
+     * Marks the recorded render commands of every static subtree containing this node as outdated,
+     * they will be recorded again the next time the subtree is visited.
+     */
+    void invalidateStaticSubtree();
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1871,6 +1916,9 @@ protected:
     /// helper that reorder a child
     void insertChild(Node* child, int z);
 
+    /// Sorts the children, only moving the ones added or reordered since the last sort when they are few.
+    void sortReorderedChildren();
+
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
@@ -1990,6 +2038,8 @@ protected:
                                           ///< Used by Layer and Scene.
 
     bool _reorderChildDirty;          ///< children order dirty flag
+    bool _reorderPending;             ///< added or reordered since the parent sorted its children
+    ssize_t _reorderedChildCount;     ///< children added or reordered since the last sort
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -2010,6 +2060,12 @@ protected:
 
     // camera mask, it is visible only when _cameraMask & current camera' camera flag is true
     unsigned short _cameraMask;
+
+    // static subtree, _staticCommands is only allocated for the root of a static subtree
+    RenderCommandRecording* _staticCommands;
+    const Camera* _staticCommandsCamera;
+    bool _staticCommandsValid;
+    static int s_staticSubtreeCount;
     
     std::function<void()> _onEnterCallback;
     std::function<void()> _onExitCallback;
@@ -865,6 +865,8 @@ void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
+    const int previousParticleCount = _particleCount;
+
     if (_isActive && _emissionRate)
     {
         float rate = 1.0f / _emissionRate;
@@ -1029,6 +1031,12 @@ void ParticleSystem::update(float dt)
         _transformSystemDirty = false;
     }
 
+    // the quads change every frame while there are particles, a static subtree can't replay them
+    if (_particleCount > 0 || previousParticleCount > 0)
+    {
+        invalidateStaticSubtree();
+    }
+
     // only update gl buffer when visible
     if (_visible && ! _batchNode)
     {
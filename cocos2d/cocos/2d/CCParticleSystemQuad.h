@@ -59,6 +59,8 @@ Special features and Limitations:
 class CC_DLL ParticleSystemQuad : public ParticleSystem
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(ParticleSystemQuad)
+
 
     /** Creates a Particle Emitter.
      *
@@ -40,9 +40,12 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Sprite, 256)
+
 // MARK: create, init, dealloc
 Sprite* Sprite::createWithTexture(Texture2D *texture)
 {
@@ -312,6 +315,7 @@ Sprite::Sprite()
 , _shouldBeHidden(false)
 , _texture(nullptr)
 , _spriteFrame(nullptr)
+, _instancedGLProgramState(nullptr)
 , _centerRectNormalized(0,0,1,1)
 , _renderMode(Sprite::RenderMode::QUAD)
 , _stretchFactor(Vec2::ONE)
@@ -333,6 +337,7 @@ Sprite::~Sprite()
     CC_SAFE_FREE(_trianglesIndex);
     CC_SAFE_RELEASE(_spriteFrame);
     CC_SAFE_RELEASE(_texture);
+    CC_SAFE_RELEASE(_instancedGLProgramState);
 }
 
 /*
@@ -409,6 +414,7 @@ void Sprite::setTexture(Texture2D *texture)
         }
         updateBlendFunc();
     }
+    invalidateStaticSubtree();
 }
 
 Texture2D* Sprite::getTexture() const
@@ -431,6 +437,7 @@ void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimme
     setVertexRect(rect);
     updateStretchFactor();
     updatePoly();
+    invalidateStaticSubtree();
 }
 
 void Sprite::updatePoly()
@@ -1075,15 +1082,32 @@ void Sprite::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     if(_insideBounds)
 #endif
     {
-        _trianglesCommand.init(_globalZOrder,
-                               _texture,
-                               getGLProgramState(),
-                               _blendFunc,
-                               _polyInfo.triangles,
-                               transform,
-                               flags);
-
-        renderer->addCommand(&_trianglesCommand);
+        if (_instancedGLProgramState && _renderMode == RenderMode::QUAD && InstancedQuadCommand::isSupported(transform, flags))
+        {
+            _instancedQuadCommand.init(_globalZOrder,
+                                       _texture,
+                                       _instancedGLProgramState,
+                                       _blendFunc,
+                                       _quad,
+                                       transform,
+                                       flags,
+                                       _instanceParams0,
+                                       _instanceParams1);
+
+            renderer->addCommand(&_instancedQuadCommand);
+        }
+        else
+        {
+            _trianglesCommand.init(_globalZOrder,
+                                   _texture,
+                                   getGLProgramState(),
+                                   _blendFunc,
+                                   _polyInfo.triangles,
+                                   transform,
+                                   flags);
+
+            renderer->addCommand(&_trianglesCommand);
+        }
 
 #if CC_SPRITE_DEBUG_DRAW
         _debugDrawNode->clear();
@@ -1206,7 +1230,7 @@ void Sprite::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        sortReorderedChildren();
 
         if (_renderMode == RenderMode::QUAD_BATCHNODE)
         {
@@ -1438,6 +1462,7 @@ void Sprite::setFlippedX(bool flippedX)
     {
         _flippedX = flippedX;
         flipX();
+        invalidateStaticSubtree();
     }
 }
 
@@ -1452,6 +1477,7 @@ void Sprite::setFlippedY(bool flippedY)
     {
         _flippedY = flippedY;
         flipY();
+        invalidateStaticSubtree();
     }
 }
 
@@ -1730,6 +1756,28 @@ void Sprite::setPolygonInfo(const PolygonInfo& info)
 {
     _polyInfo = info;
     _renderMode = RenderMode::POLYGON;
+    invalidateStaticSubtree();
+}
+
+void Sprite::setInstancedGLProgramState(GLProgramState* glProgramState)
+{
+    if (_instancedGLProgramState != glProgramState)
+    {
+        CC_SAFE_RETAIN(glProgramState);
+        CC_SAFE_RELEASE(_instancedGLProgramState);
+        _instancedGLProgramState = glProgramState;
+        invalidateStaticSubtree();
+    }
+}
+
+void Sprite::setInstanceParams(const Vec4& params0, const Vec4& params1)
+{
+    if (_instanceParams0 != params0 || _instanceParams1 != params1)
+    {
+        _instanceParams0 = params0;
+        _instanceParams1 = params1;
+        invalidateStaticSubtree();
+    }
 }
 
 NS_CC_END
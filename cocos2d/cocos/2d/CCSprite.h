@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "base/CCProtocols.h"
 #include "renderer/CCTextureAtlas.h"
 #include "renderer/CCTrianglesCommand.h"
+#include "renderer/CCInstancedQuadCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "2d/CCAutoPolygon.h"
 
@@ -96,6 +97,8 @@ struct transformValues_;
 class CC_DLL Sprite : public Node, public TextureProtocol
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(Sprite)
+
     enum class RenderMode {
         QUAD,
         POLYGON,
@@ -469,6 +472,29 @@ public:
      */
     void setPolygonInfo(const PolygonInfo& info);
 
+    /**
+     * Sets the GLProgramState used to draw the sprite with instanced drawing, see InstancedQuadCommand.
+     * It is used only when the sprite is rendered as a quad in 2D and the GPU supports instanced arrays,
+     * otherwise the sprite is drawn with its regular GLProgramState.
+     *
+     * @param glProgramState A GLProgramState whose glProgram expands the quad from the instance attributes,
+     *  eg: GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED. nullptr disables instanced drawing.
+     */
+    void setInstancedGLProgramState(GLProgramState* glProgramState);
+
+    /**
+     * Returns the GLProgramState used to draw the sprite with instanced drawing, nullptr if it is disabled.
+     */
+    GLProgramState* getInstancedGLProgramState() const { return _instancedGLProgramState; }
+
+    /**
+     * Sets the free parameters sent to the instanced shader with the quad of the sprite.
+     *
+     * @param params0 Value of the attribute `a_instanceParams0`.
+     * @param params1 Value of the attribute `a_instanceParams1`.
+     */
+    void setInstanceParams(const Vec4& params0, const Vec4& params1 = Vec4::ZERO);
+
     /** whether or not contentSize stretches the sprite's texture */
     void setStretchEnabled(bool enabled);
 
@@ -493,7 +519,7 @@ public:
     *In lua: local setBlendFunc(local src, local dst).
     *@endcode
     */
-    void setBlendFunc(const BlendFunc &blendFunc) override { _blendFunc = blendFunc; }
+    void setBlendFunc(const BlendFunc &blendFunc) override { _blendFunc = blendFunc; invalidateStaticSubtree(); }
     /**
     * @js  NA
     * @lua NA
@@ -684,6 +710,10 @@ protected:
     Texture2D*       _texture;              /// Texture2D object that is used to render the sprite
     SpriteFrame*     _spriteFrame;
     TrianglesCommand _trianglesCommand;     ///
+    InstancedQuadCommand _instancedQuadCommand;
+    GLProgramState* _instancedGLProgramState;
+    Vec4 _instanceParams0;
+    Vec4 _instanceParams1;
 #if CC_SPRITE_DEBUG_DRAW
     DrawNode *_debugDrawNode;
 #endif //CC_SPRITE_DEBUG_DRAW
@@ -260,7 +260,7 @@ void SpriteBatchNode::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        sortReorderedChildren();
 
         //sorted now check all children
         if (!_children.empty())
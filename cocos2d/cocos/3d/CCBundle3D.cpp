@@ -162,13 +162,9 @@ void Bundle3D::clear()
 {
     if (_isBinary)
     {
-        _binaryBuffer.clear();
         CC_SAFE_DELETE_ARRAY(_references);
     }
-    else
-    {
-        _jsonBuffer.clear();
-    }
+    _fileBuffer.reset();
 }
 
 bool Bundle3D::load(const std::string& path)
@@ -1056,9 +1052,10 @@ bool Bundle3D::loadJson(const std::string& path)
 {
     clear();
 
-    _jsonBuffer = FileUtils::getInstance()->getStringFromFile(path);
+    // the mapping is read-only, so the document copies its strings instead of parsing in situ
+    _fileBuffer = FileUtils::getInstance()->mapFile(path);
 
-    if (_jsonReader.ParseInsitu<0>((char*)_jsonBuffer.c_str()).HasParseError())
+    if (!_fileBuffer || _jsonReader.Parse<0>((const char*)_fileBuffer->getBytes(), _fileBuffer->getSize()).HasParseError())
     {
         clear();
         CCLOG("Parse json failed in Bundle3D::loadJson function");
@@ -1080,9 +1077,8 @@ bool Bundle3D::loadBinary(const std::string& path)
     clear();
     
     // get file data
-    _binaryBuffer.clear();
-    _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer.isNull())
+    _fileBuffer = FileUtils::getInstance()->mapFile(path);
+    if (!_fileBuffer)
     {
         clear();
         CCLOG("warning: Failed to read file: %s", path.c_str());
@@ -1090,7 +1086,7 @@ bool Bundle3D::loadBinary(const std::string& path)
     }
     
     // Initialise bundle reader
-    _binaryReader.init( (char*)_binaryBuffer.getBytes(),  _binaryBuffer.getSize() );
+    _binaryReader.init( (char*)_fileBuffer->getBytes(),  _fileBuffer->getSize() );
     
     // Read identifier info
     char identifier[] = { 'C', '3', 'B', '\0'};
@@ -27,6 +27,7 @@
 #define __CCBUNDLE3D_H__
 
 #include "base/CCData.h"
+#include "platform/CCFileUtils.h"
 #include "3d/CCBundle3DData.h"
 #include "3d/CCBundleReader.h"
 #include "json/document-wrapper.h"
@@ -177,12 +178,13 @@ protected:
     std::string _path;
     std::string _version;// the c3b or c3t version
     
+    // contents of the file being read, mapped when possible
+    std::shared_ptr<const MappedFile> _fileBuffer;
+
     // for json reading
-    std::string _jsonBuffer;
     rapidjson::Document _jsonReader;
 
     // for binary reading
-    Data _binaryBuffer;
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
@@ -46,11 +46,57 @@ void AsyncTaskPool::destroyInstance()
 }
 
 AsyncTaskPool::AsyncTaskPool()
+: _pendingCount(0)
 {
+    for (auto& generation : _generations)
+    {
+        generation = 0;
+    }
 }
 
 AsyncTaskPool::~AsyncTaskPool()
 {
+    // skip the tasks which did not start, and wait for the running ones
+    for (auto& generation : _generations)
+    {
+        ++generation;
+    }
+
+    std::unique_lock<std::mutex> lock(_pendingMutex);
+    _pendingCondition.wait(lock, [this]() { return _pendingCount == 0; });
+}
+
+void AsyncTaskPool::stopTasks(TaskType type)
+{
+    ++_generations[(int)type];
+}
+
+void AsyncTaskPool::enqueue(AsyncTaskPool::TaskType type, TaskCallBack callback, void* callbackParam, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        ++_pendingCount;
+    }
+
+    const unsigned int generation = _generations[(int)type];
+    JobSystem::getInstance()->schedule([this, type, generation, callback, callbackParam, task]() {
+        runTask(type, generation, callback, callbackParam, task);
+    });
+}
+
+void AsyncTaskPool::runTask(TaskType type, unsigned int generation, const TaskCallBack& callback, void* callbackParam, const std::function<void()>& task)
+{
+    if (generation == _generations[(int)type])
+    {
+        task();
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(callback, callbackParam));
+    }
+
+    std::lock_guard<std::mutex> lock(_pendingMutex);
+    if (--_pendingCount == 0)
+    {
+        _pendingCondition.notify_all();
+    }
 }
 
 NS_CC_END
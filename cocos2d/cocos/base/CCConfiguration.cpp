@@ -46,11 +46,14 @@ Configuration::Configuration()
 , _supportsETC1(false)
 , _supportsS3TC(false)
 , _supportsATITC(false)
+, _supportsETC2(false)
+, _supportsASTC(false)
 , _supportsNPOT(false)
 , _supportsBGRA8888(false)
 , _supportsDiscardFramebuffer(false)
 , _supportsShareableVAO(false)
 , _supportsOESMapBuffer(false)
+, _supportsInstancedArrays(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
 , _maxSamplesAllowed(0)
@@ -139,6 +142,15 @@ void Configuration::gatherGPUInfo()
     _supportsATITC = checkForGLExtension("GL_AMD_compressed_ATC_texture");
     _valueDict["gl.supports_ATITC"] = Value(_supportsATITC);
     
+    const char* version = (const char*)glGetString(GL_VERSION);
+    _supportsETC2 = (version != nullptr && strncmp(version, "OpenGL ES 3", 11) == 0)
+                    || checkForGLExtension("GL_ARB_ES3_compatibility")
+                    || checkForGLExtension("GL_OES_compressed_ETC2_RGBA8_texture");
+    _valueDict["gl.supports_ETC2"] = Value(_supportsETC2);
+    
+    _supportsASTC = checkForGLExtension("GL_KHR_texture_compression_astc_ldr");
+    _valueDict["gl.supports_ASTC"] = Value(_supportsASTC);
+    
     _supportsPVRTC = checkForGLExtension("GL_IMG_texture_compression_pvrtc");
 	_valueDict["gl.supports_PVRTC"] = Value(_supportsPVRTC);
 
@@ -161,6 +173,17 @@ void Configuration::gatherGPUInfo()
     _supportsOESMapBuffer = checkForGLExtension("GL_OES_mapbuffer");
     _valueDict["gl.supports_OES_map_buffer"] = Value(_supportsOESMapBuffer);
 
+#ifdef CC_PLATFORM_PC
+    _supportsInstancedArrays = checkForGLExtension("instanced_arrays");
+#else
+    _supportsInstancedArrays = checkForGLExtension("GL_EXT_instanced_arrays");
+#endif
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    // the functions are loaded at runtime, the extension string alone is not enough
+    _supportsInstancedArrays = _supportsInstancedArrays && glDrawArraysInstanced != nullptr && glVertexAttribDivisor != nullptr;
+#endif
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancedArrays);
+
     _supportsOESDepth24 = checkForGLExtension("GL_OES_depth24");
     _valueDict["gl.supports_OES_depth24"] = Value(_supportsOESDepth24);
 
@@ -259,6 +282,16 @@ bool Configuration::supportsATITC() const
     return _supportsATITC;
 }
 
+bool Configuration::supportsETC2() const
+{
+    return _supportsETC2;
+}
+
+bool Configuration::supportsASTC() const
+{
+    return _supportsASTC;
+}
+
 bool Configuration::supportsBGRA8888() const
 {
 	return _supportsBGRA8888;
@@ -278,6 +311,11 @@ bool Configuration::supportsShareableVAO() const
 #endif
 }
 
+bool Configuration::supportsInstancedArrays() const
+{
+    return _supportsInstancedArrays;
+}
+
 bool Configuration::supportsMapBuffer() const
 {
     // Fixes Github issue #16123
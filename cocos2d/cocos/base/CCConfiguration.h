@@ -127,6 +127,19 @@ public:
      */
     bool supportsATITC() const;
     
+    /** Whether or not ETC2 Texture Compressed is supported.
+     * ETC2 is part of OpenGL ES 3, desktop drivers expose it with GL_ARB_ES3_compatibility.
+     *
+     * @return Is true if supports ETC2 Texture Compressed.
+     */
+    bool supportsETC2() const;
+    
+    /** Whether or not ASTC (LDR profile) Texture Compressed is supported.
+     *
+     * @return Is true if supports ASTC Texture Compressed.
+     */
+    bool supportsASTC() const;
+    
     /** Whether or not BGRA8888 textures are supported.
      *
      * @return Is true if supports BGRA8888 textures.
@@ -171,6 +184,15 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not instanced drawing with per instance vertex attributes is supported.
+     *
+     * On Desktop it checks for `GL_ARB_instanced_arrays`.
+     * On Mobile it checks for the extension `GL_EXT_instanced_arrays`.
+     *
+     * @return Whether or not `glDrawArraysInstanced()` and `glVertexAttribDivisor()` are supported.
+     */
+    bool supportsInstancedArrays() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -263,11 +285,14 @@ protected:
     bool            _supportsETC1;
     bool            _supportsS3TC;
     bool            _supportsATITC;
+    bool            _supportsETC2;
+    bool            _supportsASTC;
     bool            _supportsNPOT;
     bool            _supportsBGRA8888;
     bool            _supportsDiscardFramebuffer;
     bool            _supportsShareableVAO;
     bool            _supportsOESMapBuffer;
+    bool            _supportsInstancedArrays;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
     
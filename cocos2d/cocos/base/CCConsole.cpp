@@ -1142,8 +1142,12 @@ void Console::createCommandVersion()
 void Console::commandAllocator(int fd, const std::string& /*args*/)
 {
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
-    auto info = allocator::AllocatorDiagnostics::instance()->diagnostics();
-    Console::Utility::mydprintf(fd, info.c_str());
+    // the diagnostics read the pools without locking them, read them on the cocos thread where most of their objects live
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto info = allocator::AllocatorDiagnostics::instance()->diagnostics();
+        Console::Utility::mydprintf(fd, "%s", info.c_str());
+    });
 #else
     Console::Utility::mydprintf(fd, "allocator diagnostics not available. CC_ENABLE_ALLOCATOR_DIAGNOSTICS must be set to 1 in ccConfig.h\n");
 #endif
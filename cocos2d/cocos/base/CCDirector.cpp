@@ -61,6 +61,8 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
+#include "base/CCFrameProfiler.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -167,6 +169,7 @@ Director::~Director()
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_drawnVerticesLabel);
     CC_SAFE_RELEASE(_drawnBatchesLabel);
+    CC_SAFE_RELEASE(_savedBatchesLabel);
 
     CC_SAFE_RELEASE(_runningScene);
     CC_SAFE_RELEASE(_notificationNode);
@@ -251,17 +254,21 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_FRAME_PROFILER_BEGIN_FRAME();
+
     // calculate "global" dt
     calculateDeltaTime();
     
     if (_openGLView)
     {
+        CC_FRAME_PROFILER_SCOPE("GLView::pollEvents");
         _openGLView->pollEvents();
     }
 
     //tick before glClear: issue #533
     if (! _paused)
     {
+        CC_FRAME_PROFILER_SCOPE("Scheduler::update");
         _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
         _scheduler->update(_deltaTime);
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
@@ -284,6 +291,7 @@ void Director::drawScene()
     
     if (_runningScene)
     {
+        CC_FRAME_PROFILER_SCOPE("Director::renderScene");
 #if (CC_USE_PHYSICS || (CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION) || CC_USE_NAVMESH)
         _runningScene->stepPhysicsAndNavigation(_deltaTime);
 #endif
@@ -323,9 +331,12 @@ void Director::drawScene()
     // swap buffers
     if (_openGLView)
     {
+        CC_FRAME_PROFILER_SCOPE("GLView::swapBuffers");
         _openGLView->swapBuffers();
     }
 
+    CC_FRAME_PROFILER_END_FRAME();
+
     if (_displayStats)
     {
 #if !CC_STRIP_FPS
@@ -1073,6 +1084,7 @@ void Director::reset()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
     CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+    CC_SAFE_RELEASE_NULL(_savedBatchesLabel);
     
     // purge bitmap cache
     FontFNT::purgeCachedData();
@@ -1101,8 +1113,13 @@ void Director::reset()
     SpriteFrameCache::destroyInstance();
     GLProgramCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
+    FrameProfiler::destroyInstance();
+    // the texture loading jobs read files, stop them first
+    if (_textureCache)
+    {
+        _textureCache->waitForQuit();
+    }
     FileUtils::destroyInstance();
-    AsyncTaskPool::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
@@ -1112,6 +1129,10 @@ void Director::reset()
     RenderState::finalize();
     
     destroyTextureCache();
+
+    // after the texture cache, which waits for its loading jobs
+    AsyncTaskPool::destroyInstance();
+    JobSystem::destroyInstance();
 }
 
 void Director::purgeDirector()
@@ -1254,11 +1275,12 @@ void Director::showStats()
 
     static unsigned long prevCalls = 0;
     static unsigned long prevVerts = 0;
+    static unsigned long prevSaved = 0;
 
     ++_frames;
     _accumDt += _deltaTime;
     
-    if (_displayStats && _FPSLabel && _drawnBatchesLabel && _drawnVerticesLabel)
+    if (_displayStats && _FPSLabel && _drawnBatchesLabel && _drawnVerticesLabel && _savedBatchesLabel)
     {
         char buffer[30] = {0};
 
@@ -1287,7 +1309,16 @@ void Director::showStats()
             prevVerts = currentVerts;
         }
 
+        auto currentSaved = (unsigned long)_renderer->getSavedBatches();
+        if( currentSaved != prevSaved) {
+            sprintf(buffer, "GL saved:%6lu", currentSaved);
+            _savedBatchesLabel->setString(buffer);
+            prevSaved = currentSaved;
+        }
+
         const Mat4& identity = Mat4::IDENTITY;
+        if (_renderer->isBatchReorderingEnabled())
+            _savedBatchesLabel->visit(_renderer, identity, 0);
         _drawnVerticesLabel->visit(_renderer, identity, 0);
         _drawnBatchesLabel->visit(_renderer, identity, 0);
         _FPSLabel->visit(_renderer, identity, 0);
@@ -1317,15 +1348,18 @@ void Director::createStatsLabel()
     std::string fpsString = "00.0";
     std::string drawBatchString = "000";
     std::string drawVerticesString = "00000";
+    std::string savedBatchesString = "000";
     if (_FPSLabel)
     {
         fpsString = _FPSLabel->getString();
         drawBatchString = _drawnBatchesLabel->getString();
         drawVerticesString = _drawnVerticesLabel->getString();
+        savedBatchesString = _savedBatchesLabel->getString();
         
         CC_SAFE_RELEASE_NULL(_FPSLabel);
         CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
         CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+        CC_SAFE_RELEASE_NULL(_savedBatchesLabel);
         _textureCache->removeTextureForKey("/cc_fps_images");
         FileUtils::getInstance()->purgeCachedEntries();
     }
@@ -1376,10 +1410,17 @@ void Director::createStatsLabel()
     _drawnVerticesLabel->initWithString(drawVerticesString, texture, 12, 32, '.');
     _drawnVerticesLabel->setScale(scaleFactor);
 
+    _savedBatchesLabel = LabelAtlas::create();
+    _savedBatchesLabel->retain();
+    _savedBatchesLabel->setIgnoreContentScaleFactor(true);
+    _savedBatchesLabel->initWithString(savedBatchesString, texture, 12, 32, '.');
+    _savedBatchesLabel->setScale(scaleFactor);
+
 
     Texture2D::setDefaultAlphaPixelFormat(currentFormat);
 
     const int height_spacing = 22 / CC_CONTENT_SCALE_FACTOR();
+    _savedBatchesLabel->setPosition(Vec2(0, height_spacing*3) + CC_DIRECTOR_STATS_POSITION);
     _drawnVerticesLabel->setPosition(Vec2(0, height_spacing*2) + CC_DIRECTOR_STATS_POSITION);
     _drawnBatchesLabel->setPosition(Vec2(0, height_spacing*1) + CC_DIRECTOR_STATS_POSITION);
     _FPSLabel->setPosition(Vec2(0, height_spacing*0)+CC_DIRECTOR_STATS_POSITION);
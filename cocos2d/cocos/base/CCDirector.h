@@ -668,6 +668,7 @@ protected:
     LabelAtlas *_FPSLabel = nullptr;
     LabelAtlas *_drawnBatchesLabel = nullptr;
     LabelAtlas *_drawnVerticesLabel = nullptr;
+    LabelAtlas *_savedBatchesLabel = nullptr;
     
     /** Whether or not the Director is paused */
     bool _paused = false;
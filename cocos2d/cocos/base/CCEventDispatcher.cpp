@@ -38,6 +38,7 @@
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
+#include "base/CCFrameProfiler.h"
 #include "2d/CCCamera.h"
 
 #define DUMP_LISTENER_ITEM_PRIORITY_INFO 0
@@ -200,7 +201,9 @@ void EventDispatcher::EventListenerVector::clear()
 
 
 EventDispatcher::EventDispatcher()
-: _inDispatch(0)
+: _sceneGraphOrderDirty(false)
+, _dispatchBuffersInUse(0)
+, _inDispatch(0)
 , _isEnabled(false)
 , _nodePriorityIndex(0)
 {
@@ -220,75 +223,84 @@ EventDispatcher::~EventDispatcher()
     // so removeAllEventListeners would clean internal custom listeners.
     _internalCustomListenerIDs.clear();
     removeAllEventListeners();
+
+    for (auto buffers : _dispatchBuffers)
+    {
+        delete buffers;
+    }
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
+EventDispatcher::DispatchBuffersScope::DispatchBuffersScope(EventDispatcher* dispatcher)
+: _dispatcher(dispatcher)
 {
-    node->sortAllChildren();
-    
-    int i = 0;
-    auto& children = node->getChildren();
-    
-    auto childrenCount = children.size();
-    
-    if(childrenCount > 0)
+    auto& dispatchBuffers = dispatcher->_dispatchBuffers;
+    if (dispatcher->_dispatchBuffersInUse == dispatchBuffers.size())
     {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
-        
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-        
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
-        }
+        auto buffers = new DispatchBuffers();
+        buffers->touches.reserve(EventTouch::MAX_TOUCHES);
+        dispatchBuffers.push_back(buffers);
     }
-    else
+    _buffers = dispatchBuffers[dispatcher->_dispatchBuffersInUse++];
+}
+
+EventDispatcher::DispatchBuffersScope::~DispatchBuffersScope()
+{
+    // don't keep dangling pointers in the buffers
+    _buffers->touches.clear();
+    _buffers->listeners.clear();
+    _buffers->cameras.clear();
+    --_dispatcher->_dispatchBuffersInUse;
+}
+
+bool EventDispatcher::addNodeOrder(Node* node, Node* rootNode)
+{
+    size_t pathBegin = _nodeOrderPaths.size();
+    Node* current = node;
+    for (; current != nullptr && current != rootNode; current = current->getParent())
     {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
+        _nodeOrderPaths.push_back(current);
     }
-    
-    if (isRootNode)
+
+    if (current == nullptr)
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::stable_sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
+        _nodeOrderPaths.resize(pathBegin);
+        return false;
     }
+
+    std::reverse(_nodeOrderPaths.begin() + pathBegin, _nodeOrderPaths.end());
+    _nodeOrders.push_back({node, node->getGlobalZOrder(), pathBegin, _nodeOrderPaths.size() - pathBegin});
+    return true;
+}
+
+bool EventDispatcher::isVisitedBefore(const NodeOrder& n1, const NodeOrder& n2) const
+{
+    const Node* const* path1 = _nodeOrderPaths.data() + n1.pathBegin;
+    const Node* const* path2 = _nodeOrderPaths.data() + n2.pathBegin;
+    size_t length = std::min(n1.pathLength, n2.pathLength);
+
+    size_t i = 0;
+    while (i < length && path1[i] == path2[i])
+    {
+        ++i;
+    }
+
+    if (i < length)
+    {
+        // siblings are visited in their sorted order
+        return Node::localOrderLess(path1[i], path2[i]);
+    }
+
+    if (n1.pathLength == n2.pathLength)
+    {
+        return false;
+    }
+
+    // a parent is visited after its children of negative local Z order, and before the others
+    if (n1.pathLength < n2.pathLength)
+    {
+        return path2[i]->getLocalZOrder() >= 0;
+    }
+    return path1[i]->getLocalZOrder() < 0;
 }
 
 void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/* = false */)
@@ -739,7 +751,7 @@ void EventDispatcher::setPriority(EventListener* listener, int fixedPriority)
     }
 }
 
-void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, const ListenerCallback& onEvent)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -801,7 +813,7 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, c
     }
 }
 
-void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const ListenerCallback& onEvent)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -834,8 +846,10 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
         {
             // priority == 0, scene graph priority
             
+            DispatchBuffersScope buffers(this);
+
             // first, get all enabled, unPaused and registered listeners
-            std::vector<EventListener*> sceneListeners;
+            auto& sceneListeners = buffers->listeners;
             for (auto& l : *sceneGraphPriorityListeners)
             {
                 if (l->isEnabled() && !l->isPaused() && l->isRegistered())
@@ -846,7 +860,8 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
             // second, for all camera call all listeners
             // get a copy of cameras, prevent it's been modified in listener callback
             // if camera's depth is greater, process it earlier
-            auto cameras = scene->getCameras();
+            auto& cameras = buffers->cameras;
+            cameras.assign(scene->getCameras().begin(), scene->getCameras().end());
             for (auto rit = cameras.rbegin(), ritRend = cameras.rend(); rit != ritRend; ++rit)
             {
                 Camera* camera = *rit;
@@ -902,6 +917,8 @@ void EventDispatcher::dispatchEvent(Event* event)
 {
     if (!_isEnabled)
         return;
+
+    CC_FRAME_PROFILER_SCOPE("EventDispatcher::dispatchEvent");
     
     updateDirtyFlagForSceneGraph();
     
@@ -966,8 +983,9 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
     bool isNeedsMutableSet = (oneByOneListeners && allAtOnceListeners);
     
     const std::vector<Touch*>& originalTouches = event->getTouches();
-    std::vector<Touch*> mutableTouches(originalTouches.size());
-    std::copy(originalTouches.begin(), originalTouches.end(), mutableTouches.begin());
+    DispatchBuffersScope buffers(this);
+    auto& mutableTouches = buffers->touches;
+    mutableTouches.assign(originalTouches.begin(), originalTouches.end());
 
     //
     // process the target handlers 1st
@@ -1258,6 +1276,20 @@ void EventDispatcher::updateListeners(Event* event)
 
 void EventDispatcher::updateDirtyFlagForSceneGraph()
 {
+    if (_sceneGraphOrderDirty)
+    {
+        // the subtrees aren't walked, every scene graph priority listener is sorted again
+        for (const auto& item : _listenerMap)
+        {
+            auto sceneGraphListeners = item.second->getSceneGraphPriorityListeners();
+            if (sceneGraphListeners != nullptr && !sceneGraphListeners->empty())
+            {
+                setDirty(item.first, DirtyFlag::SCENE_GRAPH_PRIORITY);
+            }
+        }
+        _sceneGraphOrderDirty = false;
+    }
+
     if (!_dirtyNodes.empty())
     {
         for (auto& node : _dirtyNodes)
@@ -1326,7 +1358,31 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     _nodePriorityIndex = 0;
     _nodePriorityMap.clear();
 
-    visitTarget(rootNode, true);
+    // Only the nodes of the listeners are ranked, by global Z order then in the order they are visited.
+    // The nodes which aren't in the running scene keep the priority 0.
+    _nodeOrders.clear();
+    _nodeOrderPaths.clear();
+    for (auto& l : *sceneGraphListeners)
+    {
+        Node* node = l->getAssociatedNode();
+        if (_nodePriorityMap.emplace(node, 0).second)
+        {
+            addNodeOrder(node, rootNode);
+        }
+    }
+
+    std::sort(_nodeOrders.begin(), _nodeOrders.end(), [this](const NodeOrder& n1, const NodeOrder& n2) {
+        if (n1.globalZOrder != n2.globalZOrder)
+        {
+            return n1.globalZOrder < n2.globalZOrder;
+        }
+        return isVisitedBefore(n1, n2);
+    });
+
+    for (const auto& nodeOrder : _nodeOrders)
+    {
+        _nodePriorityMap[nodeOrder.node] = ++_nodePriorityIndex;
+    }
     
     // After sort: priority < 0, > 0
     std::stable_sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
@@ -1535,11 +1591,11 @@ void EventDispatcher::setDirtyForNode(Node* node)
         _dirtyNodes.insert(node);
     }
 
-    // Also set the dirty flag for node's children
-    const auto& children = node->getChildren();
-    for (const auto& child : children)
+    // The listeners of node's descendants are dirty too, instead of walking the subtree
+    // they are all sorted again, which only costs the number of listeners.
+    if (!node->getChildren().empty())
     {
-        setDirtyForNode(child);
+        _sceneGraphOrderDirty = true;
     }
 }
 
@@ -47,6 +47,8 @@ NS_CC_BEGIN
 class Event;
 class EventTouch;
 class Node;
+class Touch;
+class Camera;
 class EventCustom;
 class EventListenerCustom;
 
@@ -236,6 +238,45 @@ protected:
         std::vector<EventListener*>* _sceneGraphListeners;
         ssize_t _gt0Index;
     };
+
+    /** Non owning reference to the callable called on the listeners while dispatching, unlike std::function it never allocates */
+    class ListenerCallback
+    {
+    public:
+        template <typename F>
+        ListenerCallback(const F& callable)
+        : _callable(&callable)
+        , _invoke([](const void* target, EventListener* listener) -> bool { return (*static_cast<const F*>(target))(listener); })
+        {}
+
+        bool operator()(EventListener* listener) const { return _invoke(_callable, listener); }
+
+    private:
+        const void* _callable;
+        bool (*_invoke)(const void*, EventListener*);
+    };
+
+    /** Buffers reused while dispatching touch and mouse events, so that dispatching doesn't allocate */
+    struct DispatchBuffers
+    {
+        std::vector<Touch*> touches;
+        std::vector<EventListener*> listeners;
+        std::vector<Camera*> cameras;
+    };
+
+    /** Takes free dispatch buffers until the end of the scope, a nested dispatch takes the next ones */
+    class DispatchBuffersScope
+    {
+    public:
+        explicit DispatchBuffersScope(EventDispatcher* dispatcher);
+        ~DispatchBuffersScope();
+
+        DispatchBuffers* operator->() const { return _buffers; }
+
+    private:
+        EventDispatcher* _dispatcher;
+        DispatchBuffers* _buffers;
+    };
     
     /** Adds an event listener with item
      *  @note if it is dispatching event, the added operation will be delayed to the end of current dispatch
@@ -283,7 +324,7 @@ protected:
     void dissociateNodeAndEventListener(Node* node, EventListener* listener);
     
     /** Dispatches event to listeners with a specified listener type */
-    void dispatchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    void dispatchEventToListeners(EventListenerVector* listeners, const ListenerCallback& onEvent);
     
     /** Special version dispatchEventToListeners for touch/mouse event.
      *
@@ -293,7 +334,7 @@ protected:
      *      to 3D world space is different by different camera.
      *  When listener process touch event, can get current camera by Camera::getVisitingCamera().
      */
-    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    void dispatchTouchEventToListeners(EventListenerVector* listeners, const ListenerCallback& onEvent);
     
     void releaseListener(EventListener* listener);
     
@@ -309,8 +350,20 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
+    /** Draw order of a node associated with scene graph priority listeners */
+    struct NodeOrder
+    {
+        Node* node;
+        float globalZOrder;
+        size_t pathBegin;   ///< path in _nodeOrderPaths, from the child of the root node down to the node
+        size_t pathLength;
+    };
+
+    /** Adds the draw order of a node, returns false if the node isn't in the tree of the root node */
+    bool addNodeOrder(Node* node, Node* rootNode);
+
+    /** Whether the first node is visited before the second one, in the order of Node::visit */
+    bool isVisitedBefore(const NodeOrder& n1, const NodeOrder& n2) const;
 
     /** Remove all listeners in _toRemoveListeners list and cleanup */
     void cleanToRemovedListeners();
@@ -327,8 +380,9 @@ protected:
     /** The map of node and its event priority */
     std::unordered_map<Node*, int> _nodePriorityMap;
     
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** The draw orders of the nodes being sorted, and their paths in the scene graph */
+    std::vector<NodeOrder> _nodeOrders;
+    std::vector<Node*> _nodeOrderPaths;
     
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
@@ -338,6 +392,13 @@ protected:
 
     /** The nodes were associated with scene graph based priority listeners */
     std::set<Node*> _dirtyNodes;
+
+    /** Whether a node with children changed its order, which may reorder the listeners of its descendants */
+    bool _sceneGraphOrderDirty;
+
+    /** The dispatch buffers, the first _dispatchBuffersInUse ones are taken by the current dispatches */
+    std::vector<DispatchBuffers*> _dispatchBuffers;
+    size_t _dispatchBuffersInUse;
     
     /** Whether the dispatcher is dispatching event */
     int _inDispatch;
@@ -0,0 +1,444 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCFrameProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "base/CCConfiguration.h"
+#include "platform/CCFileUtils.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#include <EGL/egl.h>
+#endif
+
+NS_CC_BEGIN
+
+struct FrameProfiler::ThreadEvents
+{
+    int threadIndex;
+    // number of events recorded by the thread, only the thread writes it
+    std::atomic<uint32_t> head;
+    Event events[EVENT_BUFFER_SIZE];
+};
+
+const uint32_t FrameProfiler::EVENT_BUFFER_SIZE;
+const uint32_t FrameProfiler::GPU_FRAME_BUFFER_SIZE;
+
+static FrameProfiler* s_sharedFrameProfiler = nullptr;
+// incremented when the shared instance is destroyed, invalidates the buffers cached by the threads
+static std::atomic<uint32_t> s_frameProfilerGeneration(0);
+static const std::chrono::steady_clock::time_point s_frameProfilerEpoch = std::chrono::steady_clock::now();
+
+static const int GPU_THREAD_INDEX = 1000;
+
+//
+// GPU timer queries, the entry points differ between platforms
+//
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+
+static PFNGLGENQUERIESEXTPROC s_glGenQueries = nullptr;
+static PFNGLDELETEQUERIESEXTPROC s_glDeleteQueries = nullptr;
+static PFNGLBEGINQUERYEXTPROC s_glBeginQuery = nullptr;
+static PFNGLENDQUERYEXTPROC s_glEndQuery = nullptr;
+static PFNGLGETQUERYOBJECTUIVEXTPROC s_glGetQueryObjectuiv = nullptr;
+static PFNGLGETQUERYOBJECTUI64VEXTPROC s_glGetQueryObjectui64v = nullptr;
+
+static bool loadTimerQueries()
+{
+    if (!Configuration::getInstance()->checkForGLExtension("GL_EXT_disjoint_timer_query"))
+        return false;
+
+    s_glGenQueries = (PFNGLGENQUERIESEXTPROC)eglGetProcAddress("glGenQueriesEXT");
+    s_glDeleteQueries = (PFNGLDELETEQUERIESEXTPROC)eglGetProcAddress("glDeleteQueriesEXT");
+    s_glBeginQuery = (PFNGLBEGINQUERYEXTPROC)eglGetProcAddress("glBeginQueryEXT");
+    s_glEndQuery = (PFNGLENDQUERYEXTPROC)eglGetProcAddress("glEndQueryEXT");
+    s_glGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVEXTPROC)eglGetProcAddress("glGetQueryObjectuivEXT");
+    s_glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+    return s_glGenQueries && s_glDeleteQueries && s_glBeginQuery && s_glEndQuery && s_glGetQueryObjectuiv && s_glGetQueryObjectui64v;
+}
+
+static void genTimerQueries(GLsizei n, GLuint* ids) { s_glGenQueries(n, ids); }
+static void deleteTimerQueries(GLsizei n, const GLuint* ids) { s_glDeleteQueries(n, ids); }
+static void beginTimerQuery(GLuint id) { s_glBeginQuery(GL_TIME_ELAPSED_EXT, id); }
+static void endTimerQuery() { s_glEndQuery(GL_TIME_ELAPSED_EXT); }
+static bool isTimerQueryAvailable(GLuint id)
+{
+    GLuint available = 0;
+    s_glGetQueryObjectuiv(id, GL_QUERY_RESULT_AVAILABLE_EXT, &available);
+    return available != 0;
+}
+static uint64_t getTimerQueryResult(GLuint id)
+{
+    GLuint64 elapsed = 0;
+    s_glGetQueryObjectui64v(id, GL_QUERY_RESULT_EXT, &elapsed);
+    return elapsed;
+}
+// the results are meaningless when the GPU changed its frequency or was reset
+static bool isTimerQueryDisjoint()
+{
+    GLint disjoint = 0;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+    return disjoint != 0;
+}
+
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+#define CC_GL_TIME_ELAPSED GL_TIME_ELAPSED_EXT
+#define CC_GL_GET_QUERY_OBJECT_UI64V glGetQueryObjectui64vEXT
+#else
+#define CC_GL_TIME_ELAPSED GL_TIME_ELAPSED
+#define CC_GL_GET_QUERY_OBJECT_UI64V glGetQueryObjectui64v
+#endif
+
+static bool loadTimerQueries()
+{
+    auto conf = Configuration::getInstance();
+    if (!conf->checkForGLExtension("GL_ARB_timer_query") && !conf->checkForGLExtension("GL_EXT_timer_query"))
+        return false;
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
+    // loaded by GLEW
+    return glGenQueries && glDeleteQueries && glBeginQuery && glEndQuery && glGetQueryObjectiv && glGetQueryObjectui64v;
+#else
+    return true;
+#endif
+}
+
+static void genTimerQueries(GLsizei n, GLuint* ids) { glGenQueries(n, ids); }
+static void deleteTimerQueries(GLsizei n, const GLuint* ids) { glDeleteQueries(n, ids); }
+static void beginTimerQuery(GLuint id) { glBeginQuery(CC_GL_TIME_ELAPSED, id); }
+static void endTimerQuery() { glEndQuery(CC_GL_TIME_ELAPSED); }
+static bool isTimerQueryAvailable(GLuint id)
+{
+    GLint available = 0;
+    glGetQueryObjectiv(id, GL_QUERY_RESULT_AVAILABLE, &available);
+    return available != 0;
+}
+static uint64_t getTimerQueryResult(GLuint id)
+{
+    GLuint64 elapsed = 0;
+    CC_GL_GET_QUERY_OBJECT_UI64V(id, GL_QUERY_RESULT, &elapsed);
+    return elapsed;
+}
+static bool isTimerQueryDisjoint() { return false; }
+
+#else
+
+// no timer queries, eg: iOS
+static bool loadTimerQueries() { return false; }
+static void genTimerQueries(GLsizei /*n*/, GLuint* /*ids*/) {}
+static void deleteTimerQueries(GLsizei /*n*/, const GLuint* /*ids*/) {}
+static void beginTimerQuery(GLuint /*id*/) {}
+static void endTimerQuery() {}
+static bool isTimerQueryAvailable(GLuint /*id*/) { return false; }
+static uint64_t getTimerQueryResult(GLuint /*id*/) { return 0; }
+static bool isTimerQueryDisjoint() { return false; }
+
+#endif
+
+//
+// ScopedEvent
+//
+FrameProfiler::ScopedEvent::ScopedEvent(const char* name)
+: _name(nullptr)
+, _begin(0)
+{
+    if (FrameProfiler::getInstance()->isEnabled())
+    {
+        _name = name;
+        _begin = FrameProfiler::now();
+    }
+}
+
+FrameProfiler::ScopedEvent::~ScopedEvent()
+{
+    if (_name)
+    {
+        FrameProfiler::getInstance()->recordEvent(_name, _begin, FrameProfiler::now());
+    }
+}
+
+//
+// FrameProfiler
+//
+FrameProfiler* FrameProfiler::getInstance()
+{
+    if (!s_sharedFrameProfiler)
+    {
+        s_sharedFrameProfiler = new (std::nothrow) FrameProfiler();
+    }
+    return s_sharedFrameProfiler;
+}
+
+void FrameProfiler::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedFrameProfiler);
+}
+
+FrameProfiler::FrameProfiler()
+: _enabled(false)
+, _frameBegin(0)
+, _lastFrameCPUTime(0)
+, _lastFrameGPUTime(0)
+, _gpuTimerSupported(false)
+, _gpuTimerInitialized(false)
+, _gpuFrameIndex(0)
+, _runningQuery(-1)
+, _gpuEventCount(0)
+{
+    memset(_gpuFrames, 0, sizeof(_gpuFrames));
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    ++s_frameProfilerGeneration;
+
+    if (_gpuTimerSupported)
+    {
+        GLuint queries[GPU_QUERY_COUNT];
+        for (int i = 0; i < GPU_QUERY_COUNT; ++i)
+        {
+            queries[i] = _gpuFrames[i].query;
+        }
+        deleteTimerQueries(GPU_QUERY_COUNT, queries);
+    }
+
+    for (auto threadEvents : _threadEvents)
+    {
+        delete threadEvents;
+    }
+}
+
+uint64_t FrameProfiler::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_frameProfilerEpoch).count();
+}
+
+void FrameProfiler::setEnabled(bool enabled)
+{
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+FrameProfiler::ThreadEvents* FrameProfiler::getThreadEvents()
+{
+    // the buffer of the calling thread, registered the first time the thread records an event
+    static thread_local ThreadEvents* threadEvents = nullptr;
+    static thread_local uint32_t threadEventsGeneration = 0;
+
+    const uint32_t generation = s_frameProfilerGeneration.load(std::memory_order_relaxed);
+    if (!threadEvents || threadEventsGeneration != generation)
+    {
+        threadEvents = new (std::nothrow) ThreadEvents();
+        if (!threadEvents)
+            return nullptr;
+        threadEvents->head.store(0, std::memory_order_relaxed);
+        threadEventsGeneration = generation;
+
+        std::lock_guard<std::mutex> lock(_threadEventsMutex);
+        threadEvents->threadIndex = (int)_threadEvents.size();
+        _threadEvents.push_back(threadEvents);
+    }
+    return threadEvents;
+}
+
+void FrameProfiler::recordEvent(const char* name, uint64_t begin, uint64_t end)
+{
+    auto threadEvents = getThreadEvents();
+    if (!threadEvents)
+        return;
+
+    const uint32_t head = threadEvents->head.load(std::memory_order_relaxed);
+    Event& event = threadEvents->events[head & (EVENT_BUFFER_SIZE - 1)];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    // publish the event to the readers
+    threadEvents->head.store(head + 1, std::memory_order_release);
+}
+
+void FrameProfiler::initGPUTimer()
+{
+    _gpuTimerInitialized = true;
+    _gpuTimerSupported = loadTimerQueries();
+    if (!_gpuTimerSupported)
+        return;
+
+    GLuint queries[GPU_QUERY_COUNT];
+    genTimerQueries(GPU_QUERY_COUNT, queries);
+    for (int i = 0; i < GPU_QUERY_COUNT; ++i)
+    {
+        _gpuFrames[i].query = queries[i];
+        _gpuFrames[i].pending = false;
+    }
+}
+
+void FrameProfiler::beginFrame()
+{
+    if (!isEnabled())
+        return;
+
+    _frameBegin = now();
+
+    if (!_gpuTimerInitialized)
+    {
+        initGPUTimer();
+    }
+
+    // when the query of this slot is still pending, the GPU is too many frames behind: this frame isn't measured
+    if (_gpuTimerSupported && !_gpuFrames[_gpuFrameIndex].pending)
+    {
+        _runningQuery = _gpuFrameIndex;
+        _gpuFrames[_runningQuery].cpuBegin = _frameBegin;
+        beginTimerQuery(_gpuFrames[_runningQuery].query);
+    }
+}
+
+void FrameProfiler::endFrame()
+{
+    // the frame began while the profiler was disabled
+    if (_frameBegin == 0)
+        return;
+
+    if (_runningQuery >= 0)
+    {
+        endTimerQuery();
+        _gpuFrames[_runningQuery].pending = true;
+        _runningQuery = -1;
+        _gpuFrameIndex = (_gpuFrameIndex + 1) % GPU_QUERY_COUNT;
+    }
+
+    const uint64_t end = now();
+    recordEvent("Frame", _frameBegin, end);
+    _lastFrameCPUTime = (end - _frameBegin) / 1000000.0f;
+    _frameBegin = 0;
+
+    collectGPUTimes(false);
+}
+
+void FrameProfiler::collectGPUTimes(bool wait)
+{
+    if (!_gpuTimerSupported)
+        return;
+
+    // from the oldest query, the results of a query are available after the ones of the previous queries
+    for (int i = 0; i < GPU_QUERY_COUNT; ++i)
+    {
+        auto& frame = _gpuFrames[(_gpuFrameIndex + i) % GPU_QUERY_COUNT];
+        if (!frame.pending)
+            continue;
+        if (!wait && !isTimerQueryAvailable(frame.query))
+            break;
+
+        const uint64_t elapsed = getTimerQueryResult(frame.query);
+        frame.pending = false;
+        if (isTimerQueryDisjoint())
+            continue;
+
+        Event& event = _gpuEvents[_gpuEventCount % GPU_FRAME_BUFFER_SIZE];
+        event.name = "GPU Frame";
+        event.begin = frame.cpuBegin;
+        event.end = frame.cpuBegin + elapsed;
+        ++_gpuEventCount;
+        _lastFrameGPUTime = elapsed / 1000000.0f;
+    }
+}
+
+static void appendTraceEvent(std::string& out, const FrameProfiler::Event& event, int tid)
+{
+    char buffer[256];
+    // Chrome trace times are in microseconds
+    snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n",
+             event.name, tid, event.begin / 1000.0, (event.end - event.begin) / 1000.0);
+    out += buffer;
+}
+
+static void appendThreadName(std::string& out, const char* name, int tid)
+{
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", tid, name);
+    out += buffer;
+}
+
+std::string FrameProfiler::getChromeTrace() const
+{
+    std::string out;
+    out.reserve(1024 * 64);
+    out += "{\"traceEvents\":[\n";
+
+    std::vector<Event> events;
+    events.reserve(EVENT_BUFFER_SIZE);
+
+    std::vector<ThreadEvents*> threads;
+    {
+        std::lock_guard<std::mutex> lock(_threadEventsMutex);
+        threads = _threadEvents;
+    }
+
+    for (auto threadEvents : threads)
+    {
+        // the writer doesn't wait for the readers: copy the events, then drop the ones it may have overwritten meanwhile
+        const uint32_t head = threadEvents->head.load(std::memory_order_acquire);
+        const uint32_t count = std::min(head, EVENT_BUFFER_SIZE);
+        events.clear();
+        for (uint32_t i = head - count; i != head; ++i)
+        {
+            events.push_back(threadEvents->events[i & (EVENT_BUFFER_SIZE - 1)]);
+        }
+        const uint32_t headAfterCopy = threadEvents->head.load(std::memory_order_acquire);
+        const uint32_t overwritten = std::min(count, headAfterCopy - head);
+
+        char name[32];
+        snprintf(name, sizeof(name), "Thread %d", threadEvents->threadIndex);
+        appendThreadName(out, name, threadEvents->threadIndex);
+        for (size_t i = overwritten; i < events.size(); ++i)
+        {
+            appendTraceEvent(out, events[i], threadEvents->threadIndex);
+        }
+    }
+
+    // GPU frames are only written by the main thread, like this method is expected to be called
+    appendThreadName(out, "GPU", GPU_THREAD_INDEX);
+    const uint32_t gpuCount = std::min(_gpuEventCount, GPU_FRAME_BUFFER_SIZE);
+    for (uint32_t i = _gpuEventCount - gpuCount; i != _gpuEventCount; ++i)
+    {
+        appendTraceEvent(out, _gpuEvents[i % GPU_FRAME_BUFFER_SIZE], GPU_THREAD_INDEX);
+    }
+
+    // remove the last separator
+    if (out.size() >= 2 && out[out.size() - 2] == ',')
+    {
+        out.erase(out.size() - 2, 1);
+    }
+    out += "],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
+
+bool FrameProfiler::writeChromeTrace(const std::string& fullPath) const
+{
+    return FileUtils::getInstance()->writeStringToFile(getChromeTrace(), fullPath);
+}
+
+NS_CC_END
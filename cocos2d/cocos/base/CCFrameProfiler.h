@@ -0,0 +1,176 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCFRAMEPROFILER_H__
+#define __BASE_CCFRAMEPROFILER_H__
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCGL.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class FrameProfiler
+ * @brief Hierarchical profiler of the frame time.
+ *
+ * Scoped events are recorded with CC_FRAME_PROFILER_SCOPE() into a ring buffer owned by the thread that records them,
+ * so recording needs no lock: an event is two clock reads and one store. Events nest by time, the frame loop records
+ * the main phases (poll events, scheduler update, event dispatch, visit, render, swap).
+ * When the GPU supports timer queries, the GPU time of each frame is measured too, and read back a few frames later
+ * without stalling the pipeline.
+ * The recorded events can be exported in the Chrome trace format (chrome://tracing, Perfetto).
+ *
+ * The macros compile to nothing unless CC_ENABLE_FRAME_PROFILER is set, and recording is off until setEnabled(true).
+ */
+class CC_DLL FrameProfiler
+{
+public:
+    /** Number of events kept per thread, older events are overwritten. */
+    static const uint32_t EVENT_BUFFER_SIZE = 1 << 13;
+    /** Number of GPU frame times kept. */
+    static const uint32_t GPU_FRAME_BUFFER_SIZE = 256;
+
+    /** A recorded event, times are in nanoseconds since the profiler was created. */
+    struct Event
+    {
+        /** Name of the event, must be a string with static storage, eg: a literal. */
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /** Records an event from its construction to its destruction. */
+    class CC_DLL ScopedEvent
+    {
+    public:
+        explicit ScopedEvent(const char* name);
+        ~ScopedEvent();
+
+    private:
+        const char* _name;
+        uint64_t _begin;
+    };
+
+    /** Returns the shared instance of the profiler. */
+    static FrameProfiler* getInstance();
+
+    /** Destroys the shared instance, and all the recorded events. */
+    static void destroyInstance();
+
+    /** Enables or disables the recording of events. Disabled by default. */
+    void setEnabled(bool enabled);
+    /** Whether events are recorded. */
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    /** Starts a frame: records the beginning of the frame event and starts the GPU timer. Main thread only. */
+    void beginFrame();
+    /** Ends the frame started by beginFrame() and collects the GPU times that are available. Main thread only. */
+    void endFrame();
+
+    /** Returns the CPU time of the last frame, in milliseconds. */
+    float getLastFrameCPUTime() const { return _lastFrameCPUTime; }
+    /** Returns the GPU time of the last frame whose timer query completed, in milliseconds. 0 if not measured. */
+    float getLastFrameGPUTime() const { return _lastFrameGPUTime; }
+    /** Whether the GPU time of the frames can be measured. */
+    bool isGPUTimerSupported() const { return _gpuTimerSupported; }
+
+    /** Returns the recorded events of all the threads in the Chrome trace JSON format. */
+    std::string getChromeTrace() const;
+    /** Writes the recorded events in the Chrome trace JSON format.
+     * @param fullPath Full path of the file to write.
+     * @return true if the file was written.
+     */
+    bool writeChromeTrace(const std::string& fullPath) const;
+
+    /** Returns the time elapsed since the profiler was created, in nanoseconds. */
+    static uint64_t now();
+
+protected:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    struct ThreadEvents;
+
+    ThreadEvents* getThreadEvents();
+    void recordEvent(const char* name, uint64_t begin, uint64_t end);
+
+    void initGPUTimer();
+    void collectGPUTimes(bool wait);
+
+    std::atomic<bool> _enabled;
+
+    // one per thread that recorded an event, the buffers are registered under the mutex and are never removed
+    mutable std::mutex _threadEventsMutex;
+    std::vector<ThreadEvents*> _threadEvents;
+
+    uint64_t _frameBegin;
+    float _lastFrameCPUTime;
+    float _lastFrameGPUTime;
+
+    struct GPUFrame
+    {
+        GLuint query;
+        uint64_t cpuBegin;
+        bool pending;
+    };
+    static const int GPU_QUERY_COUNT = 4;
+    bool _gpuTimerSupported;
+    bool _gpuTimerInitialized;
+    GPUFrame _gpuFrames[GPU_QUERY_COUNT];
+    int _gpuFrameIndex;
+    int _runningQuery;
+    Event _gpuEvents[GPU_FRAME_BUFFER_SIZE];
+    uint32_t _gpuEventCount;
+};
+
+NS_CC_END
+
+#define CC_FRAME_PROFILER_CONCAT_(a, b) a##b
+#define CC_FRAME_PROFILER_CONCAT(a, b) CC_FRAME_PROFILER_CONCAT_(a, b)
+
+#if CC_ENABLE_FRAME_PROFILER
+#define CC_FRAME_PROFILER_SCOPE(__name__) NS_CC::FrameProfiler::ScopedEvent CC_FRAME_PROFILER_CONCAT(__frameProfilerEvent, __LINE__)(__name__)
+#define CC_FRAME_PROFILER_BEGIN_FRAME() NS_CC::FrameProfiler::getInstance()->beginFrame()
+#define CC_FRAME_PROFILER_END_FRAME() NS_CC::FrameProfiler::getInstance()->endFrame()
+#else
+#define CC_FRAME_PROFILER_SCOPE(__name__) do {} while (0)
+#define CC_FRAME_PROFILER_BEGIN_FRAME() do {} while (0)
+#define CC_FRAME_PROFILER_END_FRAME() do {} while (0)
+#endif
+
+// end of base group
+/** @} */
+
+#endif // __BASE_CCFRAMEPROFILER_H__
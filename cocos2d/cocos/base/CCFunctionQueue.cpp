@@ -0,0 +1,235 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCFunctionQueue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+NS_CC_BEGIN
+
+// nanoseconds, only differences are used
+static uint64_t queueTime()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// positions of the ring wrap around, compare them by difference
+static bool isPositionBefore(size_t a, size_t b)
+{
+    return (ptrdiff_t)(a - b) < 0;
+}
+
+FunctionQueue::FunctionQueue(size_t capacity)
+: _cells(nullptr)
+, _mask(0)
+, _enqueuePos(0)
+, _dequeuePos(0)
+, _discardPos(0)
+, _overflowSize(0)
+, _overflowTotal(0)
+, _clearCount(0)
+, _batchIndex(0)
+, _batchPos(0)
+, _batchClearCount(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+
+    _cells = new Cell[size];
+    for (size_t i = 0; i < size; ++i)
+    {
+        _cells[i].sequence.store(i, std::memory_order_relaxed);
+        _cells[i].entry.time = 0;
+    }
+    _mask = size - 1;
+
+    _stats = Stats();
+}
+
+FunctionQueue::~FunctionQueue()
+{
+    delete [] _cells;
+}
+
+void FunctionQueue::push(InlineFunction&& function)
+{
+    const uint64_t time = queueTime();
+
+    // while functions wait in the spill list, the next ones go there too, so that they keep their order
+    if (_overflowSize.load(std::memory_order_acquire) == 0)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell* cell = &_cells[pos & _mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = (ptrdiff_t)(sequence - pos);
+            if (diff == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    cell->entry.function = std::move(function);
+                    cell->entry.time = time;
+                    cell->sequence.store(pos + 1, std::memory_order_release);
+                    return;
+                }
+            }
+            else if (diff < 0)
+            {
+                // the ring is full
+                break;
+            }
+            else
+            {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflow.push_back(Entry());
+    _overflow.back().function = std::move(function);
+    _overflow.back().time = time;
+    _overflowSize.store(_overflow.size(), std::memory_order_release);
+    _overflowTotal.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FunctionQueue::clear()
+{
+    size_t pos = _enqueuePos.load(std::memory_order_acquire);
+    size_t discardPos = _discardPos.load(std::memory_order_relaxed);
+    while (isPositionBefore(discardPos, pos) && !_discardPos.compare_exchange_weak(discardPos, pos, std::memory_order_release))
+    {
+    }
+
+    std::lock_guard<std::mutex> lock(_overflowMutex);
+    _overflow.clear();
+    _overflowSize.store(0, std::memory_order_release);
+    _clearCount.fetch_add(1, std::memory_order_release);
+}
+
+bool FunctionQueue::performEntry(Entry& entry, uint64_t now)
+{
+    if (!entry.function)
+        return false;
+
+    const float latency = (now > entry.time ? now - entry.time : 0) / 1000000.0f;
+    _stats.maxLatency = std::max(_stats.maxLatency, latency);
+    _stats.averageLatency += latency;
+
+    entry.function();
+    entry.function.reset();
+    return true;
+}
+
+size_t FunctionQueue::perform(float timeBudget)
+{
+    const uint64_t start = queueTime();
+    const uint64_t deadline = timeBudget > 0 ? start + (uint64_t)(timeBudget * 1000000000.0) : std::numeric_limits<uint64_t>::max();
+
+    // functions pushed from now on wait for the next call
+    const size_t end = _enqueuePos.load(std::memory_order_acquire);
+
+    // take the spill list once the previous one is done, it runs after the functions pushed in the ring before it
+    if (_batchIndex == _batch.size() && _overflowSize.load(std::memory_order_acquire) > 0)
+    {
+        std::lock_guard<std::mutex> lock(_overflowMutex);
+        _batch.clear();
+        _batch.swap(_overflow);
+        _batchIndex = 0;
+        _batchPos = _enqueuePos.load(std::memory_order_relaxed);
+        _batchClearCount = _clearCount.load(std::memory_order_relaxed);
+        _overflowSize.store(0, std::memory_order_release);
+    }
+
+    _stats.pendingCount = (end - _dequeuePos) + (_batch.size() - _batchIndex) + _overflowSize.load(std::memory_order_relaxed);
+    _stats.peakPendingCount = std::max(_stats.peakPendingCount, _stats.pendingCount);
+    _stats.maxLatency = 0;
+    _stats.averageLatency = 0;
+
+    size_t performed = 0;
+    uint64_t now = start;
+    while (now < deadline || performed == 0)
+    {
+        if (_batchIndex < _batch.size() && !isPositionBefore(_dequeuePos, _batchPos))
+        {
+            if (_clearCount.load(std::memory_order_acquire) != _batchClearCount)
+            {
+                _batch.clear();
+                _batchIndex = 0;
+                continue;
+            }
+
+            // the function may push others, they go to _overflow and not to _batch
+            if (!performEntry(_batch[_batchIndex++], now))
+                continue;
+        }
+        else if (isPositionBefore(_dequeuePos, end))
+        {
+            Cell& cell = _cells[_dequeuePos & _mask];
+            if (cell.sequence.load(std::memory_order_acquire) != _dequeuePos + 1)
+            {
+                // its producer is still writing it
+                break;
+            }
+
+            // free the cell before running the function, so producers can use it
+            Entry entry = std::move(cell.entry);
+            const bool discarded = isPositionBefore(_dequeuePos, _discardPos.load(std::memory_order_acquire));
+            cell.sequence.store(_dequeuePos + _mask + 1, std::memory_order_release);
+            ++_dequeuePos;
+
+            if (discarded || !performEntry(entry, now))
+                continue;
+        }
+        else
+        {
+            break;
+        }
+
+        ++performed;
+        now = queueTime();
+    }
+
+    if (_batchIndex == _batch.size())
+    {
+        _batch.clear();
+        _batchIndex = 0;
+    }
+
+    _stats.overflowCount = _overflowTotal.load(std::memory_order_relaxed);
+    _stats.performedCount = performed;
+    _stats.totalPerformedCount += performed;
+    _stats.performTime = (queueTime() - start) / 1000000.0f;
+    if (performed > 0)
+        _stats.averageLatency /= performed;
+    _stats.peakLatency = std::max(_stats.peakLatency, _stats.maxLatency);
+
+    return performed;
+}
+
+NS_CC_END
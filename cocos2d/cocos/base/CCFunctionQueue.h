@@ -0,0 +1,274 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCFUNCTIONQUEUE_H__
+#define __BASE_CCFUNCTIONQUEUE_H__
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class InlineFunction
+ * @brief A move only `void()` callable which stores small functors (lambdas with a few captures, std::function,
+ * std::bind results) inline, without allocating.
+ * Functors larger than INLINE_SIZE, or which may throw when moved, are allocated on the heap.
+ */
+class InlineFunction
+{
+public:
+    /** Size of the inline storage, in bytes. */
+    static const size_t INLINE_SIZE = 7 * sizeof(void*);
+
+    InlineFunction() : _ops(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+    InlineFunction(F&& function)
+    : _ops(nullptr)
+    {
+        typedef typename std::decay<F>::type Functor;
+        typedef typename std::conditional<fitsInline<Functor>(), InlineOps<Functor>, HeapOps<Functor>>::type Ops;
+        Ops::create(&_storage, std::forward<F>(function));
+        _ops = &Ops::ops;
+    }
+
+    InlineFunction(InlineFunction&& other)
+    : _ops(other._ops)
+    {
+        if (_ops)
+        {
+            _ops->move(&_storage, &other._storage);
+            other._ops = nullptr;
+        }
+    }
+
+    InlineFunction& operator=(InlineFunction&& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            if (other._ops)
+            {
+                other._ops->move(&_storage, &other._storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~InlineFunction() { reset(); }
+
+    /** Destroys the stored functor. */
+    void reset()
+    {
+        if (_ops)
+        {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
+
+    void operator()() { _ops->invoke(&_storage); }
+
+    explicit operator bool() const { return _ops != nullptr; }
+
+private:
+    InlineFunction(const InlineFunction&) = delete;
+    InlineFunction& operator=(const InlineFunction&) = delete;
+
+    typedef std::aligned_storage<INLINE_SIZE>::type Storage;
+
+    struct Ops
+    {
+        void (*invoke)(void* storage);
+        // move constructs the functor of src into dst, and destroys the one of src
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void* storage);
+    };
+
+    template <typename Functor>
+    static constexpr bool fitsInline()
+    {
+        return sizeof(Functor) <= sizeof(Storage) && std::alignment_of<Storage>::value % std::alignment_of<Functor>::value == 0
+            && std::is_nothrow_move_constructible<Functor>::value;
+    }
+
+    template <typename Functor>
+    struct InlineOps
+    {
+        template <typename F>
+        static void create(void* storage, F&& function) { new (storage) Functor(std::forward<F>(function)); }
+        static void invoke(void* storage) { (*static_cast<Functor*>(storage))(); }
+        static void move(void* dst, void* src)
+        {
+            new (dst) Functor(std::move(*static_cast<Functor*>(src)));
+            static_cast<Functor*>(src)->~Functor();
+        }
+        static void destroy(void* storage) { static_cast<Functor*>(storage)->~Functor(); }
+        static const Ops ops;
+    };
+
+    template <typename Functor>
+    struct HeapOps
+    {
+        template <typename F>
+        static void create(void* storage, F&& function) { *static_cast<Functor**>(storage) = new Functor(std::forward<F>(function)); }
+        static void invoke(void* storage) { (**static_cast<Functor**>(storage))(); }
+        static void move(void* dst, void* src) { *static_cast<Functor**>(dst) = *static_cast<Functor**>(src); }
+        static void destroy(void* storage) { delete *static_cast<Functor**>(storage); }
+        static const Ops ops;
+    };
+
+    Storage _storage;
+    const Ops* _ops;
+};
+
+template <typename Functor>
+const InlineFunction::Ops InlineFunction::InlineOps<Functor>::ops = { &InlineOps::invoke, &InlineOps::move, &InlineOps::destroy };
+
+template <typename Functor>
+const InlineFunction::Ops InlineFunction::HeapOps<Functor>::ops = { &HeapOps::invoke, &HeapOps::move, &HeapOps::destroy };
+
+/** @class FunctionQueue
+ * @brief A queue of functions pushed by any number of threads and performed by one thread.
+ *
+ * The functions are stored in a bounded lock free ring, pushing one costs a compare and swap and no allocation
+ * for small functors. When the ring is full the functions spill into a list protected by a mutex, so none is lost.
+ * Functions pushed by the same thread are performed in the order they were pushed.
+ */
+class CC_DLL FunctionQueue
+{
+public:
+    /** Counters of the queue, updated by perform(). Times are in milliseconds. */
+    struct Stats
+    {
+        /** Functions waiting when perform() was last called. */
+        size_t pendingCount;
+        /** Highest pendingCount seen. */
+        size_t peakPendingCount;
+        /** Functions run by the last call to perform(). */
+        size_t performedCount;
+        /** Functions run since the queue was created. */
+        uint64_t totalPerformedCount;
+        /** Functions which did not fit in the ring since the queue was created. */
+        uint64_t overflowCount;
+        /** Time spent in the last call to perform(). */
+        float performTime;
+        /** Longest and average time between pushing and running a function, for the functions of the last call to perform(). */
+        float maxLatency;
+        float averageLatency;
+        /** Longest latency seen. */
+        float peakLatency;
+    };
+
+    /**
+     * @param capacity Number of functions held by the lock free ring, rounded up to a power of two.
+     */
+    explicit FunctionQueue(size_t capacity = 1024);
+    ~FunctionQueue();
+
+    /** Pushes a function. Thread safe. */
+    void push(InlineFunction&& function);
+
+    /** Drops all the functions which are waiting. Thread safe. */
+    void clear();
+
+    /**
+     * Runs the functions pushed before the call, in order. Must always be called from the same thread.
+     * Functions pushed while performing are run by the next call.
+     * @param timeBudget Time after which the remaining functions are left to the next call, in seconds.
+     * At least one function is run per call. 0 means no limit.
+     * @return The number of functions which were run.
+     */
+    size_t perform(float timeBudget = 0);
+
+    /** Returns the counters, only valid on the thread which calls perform(). */
+    const Stats& getStats() const { return _stats; }
+
+private:
+    FunctionQueue(const FunctionQueue&) = delete;
+    FunctionQueue& operator=(const FunctionQueue&) = delete;
+
+    struct Entry
+    {
+        InlineFunction function;
+        // time of the push, in nanoseconds
+        uint64_t time;
+    };
+
+    struct Cell
+    {
+        // equals the position of the cell when it is free, the position + 1 when it holds a function
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    bool performEntry(Entry& entry, uint64_t now);
+
+    Cell* _cells;
+    size_t _mask;
+
+    // the producers and the consumer write to different cache lines
+    char _padding0[64];
+    std::atomic<size_t> _enqueuePos;
+    char _padding1[64];
+    size_t _dequeuePos;
+    // functions pushed before this position were dropped by clear()
+    std::atomic<size_t> _discardPos;
+
+    // spill list of the functions pushed while the ring was full, or before the spill list was taken by the consumer
+    std::mutex _overflowMutex;
+    std::vector<Entry> _overflow;
+    std::atomic<size_t> _overflowSize;
+    std::atomic<size_t> _overflowTotal;
+    std::atomic<uint32_t> _clearCount;
+
+    // spill list taken by the consumer, it runs once the ring has been read up to _batchPos
+    std::vector<Entry> _batch;
+    size_t _batchIndex;
+    size_t _batchPos;
+    uint32_t _batchClearCount;
+
+    Stats _stats;
+};
+
+NS_CC_END
+
+// end of base group
+/** @} */
+
+#endif // __BASE_CCFUNCTIONQUEUE_H__
@@ -0,0 +1,367 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCJobSystem.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+
+NS_CC_BEGIN
+
+struct JobSystem::Job
+{
+    std::function<void()> function;
+    JobSystem::Priority priority;
+    bool mainThread;
+    // dependencies which are not done, plus one until the job is created
+    std::atomic<int> pendingCount;
+    std::atomic<bool> done;
+    // guards dependents, and done against dependents being added
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Job>> dependents;
+};
+
+struct JobSystem::Worker
+{
+    std::thread thread;
+    // jobs scheduled by the worker, it takes the newest, the other workers steal the oldest
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Job>> jobs[PRIORITY_COUNT];
+};
+
+std::atomic<JobSystem*> JobSystem::s_jobSystem(nullptr);
+static std::mutex s_instanceMutex;
+
+// index of the worker running on the thread, in the job system s_workerJobSystem
+static thread_local int s_workerIndex = -1;
+static thread_local JobSystem* s_workerJobSystem = nullptr;
+
+bool JobSystem::Handle::isDone() const
+{
+    return _job == nullptr || _job->done.load(std::memory_order_acquire);
+}
+
+JobSystem* JobSystem::getInstance()
+{
+    // the loaders, the fonts and parallelFor reach it from several threads
+    JobSystem* jobSystem = s_jobSystem.load(std::memory_order_acquire);
+    if (jobSystem == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(s_instanceMutex);
+        jobSystem = s_jobSystem.load(std::memory_order_relaxed);
+        if (jobSystem == nullptr)
+        {
+            // leave a core to the cocos2d thread
+            const int cores = (int)std::thread::hardware_concurrency();
+            jobSystem = new (std::nothrow) JobSystem(std::max(cores - 1, 1));
+            s_jobSystem.store(jobSystem, std::memory_order_release);
+        }
+    }
+    return jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    std::lock_guard<std::mutex> lock(s_instanceMutex);
+    delete s_jobSystem.exchange(nullptr);
+}
+
+JobSystem::JobSystem(int workerCount)
+: _queuedCount(0)
+, _sleepingCount(0)
+, _quit(false)
+{
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers.push_back(new Worker());
+    }
+    for (int i = 0; i < workerCount; ++i)
+    {
+        _workers[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _quit.store(true);
+    }
+    _sleepCondition.notify_all();
+
+    // the workers finish the jobs they are running, the jobs which did not start are dropped with the queues
+    for (auto worker : _workers)
+    {
+        worker->thread.join();
+        delete worker;
+    }
+}
+
+JobSystem::Handle JobSystem::schedule(std::function<void()> job, Priority priority)
+{
+    return createJob(std::move(job), std::vector<Handle>(), priority, false);
+}
+
+JobSystem::Handle JobSystem::schedule(std::function<void()> job, const std::vector<Handle>& dependencies, Priority priority)
+{
+    return createJob(std::move(job), dependencies, priority, false);
+}
+
+JobSystem::Handle JobSystem::scheduleOnMainThread(std::function<void()> job, const std::vector<Handle>& dependencies)
+{
+    return createJob(std::move(job), dependencies, Priority::NORMAL, true);
+}
+
+JobSystem::Handle JobSystem::createJob(std::function<void()> function, const std::vector<Handle>& dependencies, Priority priority, bool mainThread)
+{
+    auto job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->priority = priority;
+    job->mainThread = mainThread;
+    job->pendingCount.store(1, std::memory_order_relaxed);
+    job->done.store(false, std::memory_order_relaxed);
+
+    for (const auto& dependency : dependencies)
+    {
+        if (dependency._job == nullptr)
+            continue;
+
+        std::lock_guard<std::mutex> lock(dependency._job->mutex);
+        if (!dependency._job->done.load(std::memory_order_relaxed))
+        {
+            job->pendingCount.fetch_add(1, std::memory_order_relaxed);
+            dependency._job->dependents.push_back(job);
+        }
+    }
+
+    if (job->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        submit(job);
+    }
+    return Handle(job);
+}
+
+void JobSystem::submit(const std::shared_ptr<Job>& job)
+{
+    if (job->mainThread)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([job]() {
+            job->function();
+            job->function = nullptr;
+            JobSystem* jobSystem = s_jobSystem.load(std::memory_order_acquire);
+            if (jobSystem)
+                jobSystem->finish(job);
+            else
+                job->done.store(true, std::memory_order_release);
+        });
+        return;
+    }
+
+    const int priority = (int)job->priority;
+    if (s_workerJobSystem == this)
+    {
+        Worker* worker = _workers[s_workerIndex];
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->jobs[priority].push_back(job);
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(_sharedMutex);
+        _sharedJobs[priority].push_back(job);
+    }
+
+    // a worker going to sleep counts itself before it checks _queuedCount, so one of the two sees the other
+    _queuedCount.fetch_add(1);
+    if (_sleepingCount.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_sleepMutex);
+        }
+        _sleepCondition.notify_one();
+    }
+}
+
+void JobSystem::finish(const std::shared_ptr<Job>& job)
+{
+    std::vector<std::shared_ptr<Job>> dependents;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done.store(true, std::memory_order_release);
+        dependents.swap(job->dependents);
+    }
+
+    for (const auto& dependent : dependents)
+    {
+        if (dependent->pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            submit(dependent);
+        }
+    }
+}
+
+std::shared_ptr<JobSystem::Job> JobSystem::takeJob(int workerIndex)
+{
+    std::shared_ptr<Job> job;
+    const int workerCount = (int)_workers.size();
+
+    for (int priority = 0; priority < PRIORITY_COUNT && !job; ++priority)
+    {
+        if (workerIndex >= 0)
+        {
+            Worker* worker = _workers[workerIndex];
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            auto& jobs = worker->jobs[priority];
+            if (!jobs.empty())
+            {
+                job = std::move(jobs.back());
+                jobs.pop_back();
+                break;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_sharedMutex);
+            auto& jobs = _sharedJobs[priority];
+            if (!jobs.empty())
+            {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                break;
+            }
+        }
+
+        // steal from the other workers
+        for (int i = 1; i <= workerCount; ++i)
+        {
+            const int victimIndex = (std::max(workerIndex, 0) + i) % workerCount;
+            if (victimIndex == workerIndex)
+                continue;
+
+            Worker* victim = _workers[victimIndex];
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            auto& jobs = victim->jobs[priority];
+            if (!jobs.empty())
+            {
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                break;
+            }
+        }
+    }
+
+    if (job)
+    {
+        _queuedCount.fetch_sub(1);
+    }
+    return job;
+}
+
+bool JobSystem::runJob(int workerIndex)
+{
+    auto job = takeJob(workerIndex);
+    if (!job)
+        return false;
+
+    job->function();
+    job->function = nullptr;
+    finish(job);
+    return true;
+}
+
+void JobSystem::workerLoop(int workerIndex)
+{
+    s_workerIndex = workerIndex;
+    s_workerJobSystem = this;
+
+    while (!_quit.load())
+    {
+        if (runJob(workerIndex))
+            continue;
+
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _sleepingCount.fetch_add(1);
+        _sleepCondition.wait(lock, [this]() { return _quit.load() || _queuedCount.load() > 0; });
+        _sleepingCount.fetch_sub(1);
+    }
+
+    s_workerJobSystem = nullptr;
+    s_workerIndex = -1;
+}
+
+void JobSystem::wait(const Handle& handle)
+{
+    if (handle._job == nullptr)
+        return;
+
+    const int workerIndex = s_workerJobSystem == this ? s_workerIndex : -1;
+    while (!handle._job->done.load(std::memory_order_acquire))
+    {
+        if (!runJob(workerIndex))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t minBlockSize, const std::function<void(size_t begin, size_t end)>& func)
+{
+    size_t blockCount = std::min(_workers.size() + 1, minBlockSize > 0 ? count / minBlockSize : count);
+    if (blockCount <= 1)
+    {
+        if (count > 0)
+            func(0, count);
+        return;
+    }
+
+    // the blocks are claimed from a shared counter by the calling thread and by helper jobs, so that the calling
+    // thread only runs blocks of this range, never an unrelated job which could take much longer.
+    // Helpers which start once every block is claimed return at once, they may outlive the call so the state is shared
+    struct Range
+    {
+        std::atomic<size_t> nextBlock;
+        std::atomic<size_t> doneCount;
+    };
+    auto range = std::make_shared<Range>();
+    range->nextBlock.store(0);
+    range->doneCount.store(0);
+    const std::function<void(size_t, size_t)>* function = &func;
+    auto runBlocks = [range, function, count, blockCount]() {
+        size_t block;
+        while ((block = range->nextBlock.fetch_add(1)) < blockCount)
+        {
+            (*function)(count * block / blockCount, count * (block + 1) / blockCount);
+            range->doneCount.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    for (size_t i = 0; i < blockCount - 1; ++i)
+        schedule(runBlocks, Priority::HIGH);
+    runBlocks();
+
+    // the last blocks may still run on the workers
+    while (range->doneCount.load(std::memory_order_acquire) < blockCount)
+        std::this_thread::yield();
+}
+
+NS_CC_END
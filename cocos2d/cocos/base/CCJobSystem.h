@@ -0,0 +1,174 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCJOBSYSTEM_H__
+#define __BASE_CCJOBSYSTEM_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class JobSystem
+ * @brief Runs jobs on a pool of worker threads, one per core not used by the cocos2d thread.
+ *
+ * Each worker has its own queues and takes the newest job it scheduled itself first, idle workers steal the oldest
+ * jobs of the others, so jobs which schedule other jobs keep all the cores busy. Jobs scheduled from other threads
+ * are shared by all the workers in the order they were scheduled.
+ * A job can depend on other jobs, it runs once all of them are done. Jobs with a higher priority run first.
+ * Jobs scheduled with scheduleOnMainThread() run on the cocos2d thread, use them as continuations to hand the results
+ * of background jobs to the engine.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+private:
+    struct Job;
+
+public:
+    enum class Priority
+    {
+        HIGH,
+        NORMAL,
+        LOW,
+    };
+
+    /** Reference to a scheduled job, used to wait for it or to make other jobs depend on it. */
+    class CC_DLL Handle
+    {
+    public:
+        Handle() {}
+
+        /** Whether the handle refers to a job. */
+        bool isValid() const { return _job != nullptr; }
+        /** Whether the job has run, an invalid handle is done. Thread safe. */
+        bool isDone() const;
+
+    private:
+        friend class JobSystem;
+        explicit Handle(const std::shared_ptr<Job>& job) : _job(job) {}
+
+        std::shared_ptr<Job> _job;
+    };
+
+    /** Returns the shared instance of the job system, the workers are started with it. Thread safe. */
+    static JobSystem* getInstance();
+
+    /** Destroys the shared instance. Running jobs complete, jobs which did not start are dropped. */
+    static void destroyInstance();
+
+    /**
+     * Schedules a job on the workers. Thread safe.
+     * @param job The function to run.
+     * @param priority Jobs with a higher priority are taken first.
+     * @return The handle of the job.
+     */
+    Handle schedule(std::function<void()> job, Priority priority = Priority::NORMAL);
+
+    /**
+     * Schedules a job on the workers, it runs once all its dependencies are done. Thread safe.
+     * @param job The function to run.
+     * @param dependencies The jobs to wait for, invalid handles are ignored.
+     * @param priority Jobs with a higher priority are taken first.
+     * @return The handle of the job.
+     */
+    Handle schedule(std::function<void()> job, const std::vector<Handle>& dependencies, Priority priority = Priority::NORMAL);
+
+    /**
+     * Schedules a job on the cocos2d thread, it runs in the Scheduler update once all its dependencies are done.
+     * Thread safe.
+     * @param job The function to run.
+     * @param dependencies The jobs to wait for, invalid handles are ignored.
+     * @return The handle of the job.
+     */
+    Handle scheduleOnMainThread(std::function<void()> job, const std::vector<Handle>& dependencies = std::vector<Handle>());
+
+    /**
+     * Waits for a job, the calling thread runs pending jobs in the meantime.
+     * Waiting on the cocos2d thread for a job which depends on a job of the cocos2d thread never returns.
+     */
+    void wait(const Handle& handle);
+
+    /**
+     * Runs a function over the range [0, count) split in blocks, on the workers and the calling thread.
+     * It returns once every block has run. While it waits, the calling thread only runs blocks of the range.
+     * @param count The size of the range.
+     * @param minBlockSize The smallest block worth a job, smaller ranges run on the calling thread only.
+     * @param func The function to run, called with the begin and the end of a block.
+     */
+    void parallelFor(size_t count, size_t minBlockSize, const std::function<void(size_t begin, size_t end)>& func);
+
+    /** Returns the number of worker threads. */
+    int getWorkerCount() const { return (int)_workers.size(); }
+
+protected:
+    static const int PRIORITY_COUNT = 3;
+
+    explicit JobSystem(int workerCount);
+    ~JobSystem();
+
+    struct Worker;
+
+    Handle createJob(std::function<void()> job, const std::vector<Handle>& dependencies, Priority priority, bool mainThread);
+    void submit(const std::shared_ptr<Job>& job);
+    void finish(const std::shared_ptr<Job>& job);
+    std::shared_ptr<Job> takeJob(int workerIndex);
+    bool runJob(int workerIndex);
+    void workerLoop(int workerIndex);
+
+    std::vector<Worker*> _workers;
+
+    // jobs scheduled by threads which are not workers, in order
+    std::mutex _sharedMutex;
+    std::deque<std::shared_ptr<Job>> _sharedJobs[PRIORITY_COUNT];
+
+    // number of jobs waiting in the queues, idle workers sleep while it is 0
+    std::atomic<int> _queuedCount;
+    std::atomic<int> _sleepingCount;
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCondition;
+    std::atomic<bool> _quit;
+
+    static std::atomic<JobSystem*> s_jobSystem;
+};
+
+NS_CC_END
+
+// end of base group
+/** @} */
+
+#endif // __BASE_CCJOBSYSTEM_H__
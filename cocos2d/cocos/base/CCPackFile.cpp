@@ -0,0 +1,169 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/CCPackFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+static const char PACK_MAGIC[4] = { 'C', 'C', 'P', 'K' };
+
+PackFile* PackFile::createWithMappedFile(const std::shared_ptr<const MappedFile>& file)
+{
+    PackFile* pack = new (std::nothrow) PackFile();
+    if (pack && pack->initWithMappedFile(file))
+        return pack;
+
+    delete pack;
+    return nullptr;
+}
+
+uint32_t PackFile::hashName(const char* name, size_t length)
+{
+    // FNV-1a, simple enough to be computed the same way by the packing tool
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+PackFile::PackFile()
+: _header(nullptr)
+, _entries(nullptr)
+, _names(nullptr)
+{
+}
+
+bool PackFile::initWithMappedFile(const std::shared_ptr<const MappedFile>& file)
+{
+    if (!file || file->getSize() < (ssize_t)sizeof(Header))
+        return false;
+
+    const unsigned char* bytes = file->getBytes();
+    uint64_t fileSize = (uint64_t)file->getSize();
+    auto header = reinterpret_cast<const Header*>(bytes);
+    if (memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header->version != VERSION)
+    {
+        CCLOG("cocos2d: PackFile: invalid header");
+        return false;
+    }
+
+    uint64_t namesOffset = sizeof(Header) + (uint64_t)header->entryCount * sizeof(Entry);
+    if (namesOffset + header->namesSize > fileSize)
+    {
+        CCLOG("cocos2d: PackFile: truncated index");
+        return false;
+    }
+
+    auto entries = reinterpret_cast<const Entry*>(bytes + sizeof(Header));
+    for (uint32_t i = 0; i < header->entryCount; ++i)
+    {
+        const Entry& entry = entries[i];
+        if ((uint64_t)entry.nameOffset + entry.nameLength > header->namesSize
+            || entry.offset + entry.storedSize > fileSize
+            || (entry.compression == Compression::NONE && entry.storedSize != entry.size)
+            || (entry.compression != Compression::NONE && entry.compression != Compression::ZLIB))
+        {
+            CCLOG("cocos2d: PackFile: invalid entry %u", i);
+            return false;
+        }
+    }
+
+    _file = file;
+    _header = header;
+    _entries = entries;
+    _names = reinterpret_cast<const char*>(bytes + namesOffset);
+    return true;
+}
+
+const PackFile::Entry* PackFile::findEntry(const std::string& name) const
+{
+    uint32_t hash = hashName(name.c_str(), name.length());
+
+    const Entry* end = _entries + _header->entryCount;
+    const Entry* it = std::lower_bound(_entries, end, hash, [](const Entry& entry, uint32_t value) {
+        return entry.hash < value;
+    });
+
+    // entries with the same hash are sorted by name
+    for (; it != end && it->hash == hash; ++it)
+    {
+        if (it->nameLength == name.length() && memcmp(_names + it->nameOffset, name.c_str(), name.length()) == 0)
+            return it;
+    }
+    return nullptr;
+}
+
+FileUtils::Status PackFile::getContents(const Entry* entry, ResizableBuffer* buffer) const
+{
+    CCASSERT(entry, "Invalid entry");
+
+    const unsigned char* stored = _file->getBytes() + entry->offset;
+    buffer->resize(entry->size);
+    if (entry->size == 0)
+        return FileUtils::Status::OK;
+
+    if (entry->compression == Compression::NONE)
+    {
+        memcpy(buffer->buffer(), stored, entry->size);
+        return FileUtils::Status::OK;
+    }
+
+    uLongf size = entry->size;
+    if (uncompress((Bytef*)buffer->buffer(), &size, stored, entry->storedSize) != Z_OK || size != entry->size)
+    {
+        CCLOG("cocos2d: PackFile: failed to uncompress %.*s", (int)entry->nameLength, _names + entry->nameOffset);
+        buffer->resize(0);
+        return FileUtils::Status::ReadFailed;
+    }
+    return FileUtils::Status::OK;
+}
+
+std::shared_ptr<const MappedFile> PackFile::mapEntry(const Entry* entry) const
+{
+    CCASSERT(entry, "Invalid entry");
+
+    if (entry->compression == Compression::NONE)
+    {
+        // the view keeps the whole pack mapped
+        auto file = _file;
+        return std::make_shared<const MappedFile>(file->getBytes() + entry->offset, (ssize_t)entry->size, [file]() {});
+    }
+
+    Data data;
+    ResizableBufferAdapter<Data> buffer(&data);
+    if (getContents(entry, &buffer) != FileUtils::Status::OK)
+        return nullptr;
+    return std::make_shared<const MappedFile>(std::move(data));
+}
+
+NS_CC_END
@@ -0,0 +1,127 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCPACKFILE_H__
+#define __BASE_CCPACKFILE_H__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "platform/CCFileUtils.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * @brief Read-only archive of assets, mounted with FileUtils::mountPack().
+ *
+ * A pack is built by tools/pack_assets.py and read in place from a single mapped file.
+ * All the integers are little endian:
+ *
+ *     Header        "CCPK", version, entry count, size of the names
+ *     Entry[count]  sorted by name hash, then by name
+ *     names         entry names, not null terminated, '/' separated
+ *     data          entries aligned on PackFile::DATA_ALIGNMENT, stored as is or zlib compressed
+ *
+ * An entry is found with a binary search on the FNV-1a hash of its name.
+ */
+class CC_DLL PackFile
+{
+public:
+    static const uint32_t VERSION = 1;
+    static const uint32_t DATA_ALIGNMENT = 16;
+
+    enum class Compression : uint32_t
+    {
+        NONE = 0,
+        ZLIB = 1,
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t namesSize;
+    };
+
+    struct Entry
+    {
+        uint32_t hash;
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        Compression compression;
+        uint64_t offset;
+        uint32_t size;
+        uint32_t storedSize;
+    };
+
+    /**
+     * Opens a pack from the contents of a file.
+     * @param file The contents of the pack, kept alive by the pack and the entries mapped from it.
+     * @return The pack, or nullptr if the contents are not a valid pack. The caller owns it.
+     */
+    static PackFile* createWithMappedFile(const std::shared_ptr<const MappedFile>& file);
+
+    /** Hash of an entry name, as stored in the pack. */
+    static uint32_t hashName(const char* name, size_t length);
+
+    /** Finds an entry by name, "images/piece.png" for instance. Returns nullptr if there is none. */
+    const Entry* findEntry(const std::string& name) const;
+
+    /** Number of entries. */
+    uint32_t getEntryCount() const { return _header->entryCount; }
+
+    /** Reads an entry into a buffer, uncompressing it if needed. */
+    FileUtils::Status getContents(const Entry* entry, ResizableBuffer* buffer) const;
+
+    /**
+     * Gets a read-only view of an entry.
+     * Stored entries point into the pack, compressed ones are uncompressed into a buffer.
+     */
+    std::shared_ptr<const MappedFile> mapEntry(const Entry* entry) const;
+
+private:
+    PackFile();
+    bool initWithMappedFile(const std::shared_ptr<const MappedFile>& file);
+
+    std::shared_ptr<const MappedFile> _file;
+    const Header* _header;
+    const Entry* _entries;
+    const char* _names;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(PackFile);
+};
+
+NS_CC_END
+
+// end group
+/// @}
+
+#endif // __BASE_CCPACKFILE_H__
@@ -27,6 +27,9 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCScheduler.h"
+
+#include <algorithm>
+
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/utlist.h"
@@ -62,12 +65,22 @@ typedef struct _hashSelectorEntry
 {
     ccArray             *timers;
     void                *target;
-    int                 timerIndex;
     Timer               *currentTimer;
     bool                paused;
+    uint64_t            order;          // position in the hash, timers of earlier targets are updated first
+    double              pauseTime;      // scheduler time at which the target was paused
+    double              pausedDuration; // scheduler time spent paused, the target time excludes it
     UT_hash_handle      hh;
 } tHashTimerEntry;
 
+// Length of a tick of the first level of the timer wheel
+static const double TIMER_WHEEL_TICKS_PER_SECOND = 64.0;
+
+static inline uint64_t timerWheelTick(double time)
+{
+    return time > 0.0 ? (uint64_t)(time * TIMER_WHEEL_TICKS_PER_SECOND) : 0;
+}
+
 // implementation Timer
 
 Timer::Timer()
@@ -80,6 +93,15 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _schedulerEntry(nullptr)
+, _wheelPrev(nullptr)
+, _wheelNext(nullptr)
+, _wheelList(nullptr)
+, _wheelDue(false)
+, _wakeTime(0.0)
+, _lastTime(0.0)
+, _targetOrder(0)
+, _order(0)
 {
 }
 
@@ -151,6 +173,22 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+float Timer::getTimeToNextUpdate() const
+{
+    // the first update only starts counting the elapsed time
+    if (_elapsed == -1)
+        return 0.0f;
+
+    if (_useDelay)
+        return std::max(_delay - _elapsed, 0.0f);
+
+    // if _interval == 0, triggered every frame
+    if (_interval > 0)
+        return std::max(_interval - _elapsed, 0.0f);
+
+    return 0.0f;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -260,12 +298,19 @@ Scheduler::Scheduler(void)
 , _currentTarget(nullptr)
 , _currentTargetSalvaged(false)
 , _updateHashLocked(false)
+, _timersNear(nullptr)
+, _timersDueIndex(0)
+, _updatingTimers(false)
+, _timerClock(0.0)
+, _timerFrameStart(0.0)
+, _timerWheelTick(0)
+, _timerOrder(0)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _performFunctionTimeBudget(0)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
+    memset(_timerWheel, 0, sizeof(_timerWheel));
 }
 
 Scheduler::~Scheduler(void)
@@ -280,6 +325,328 @@ void Scheduler::removeHashElement(_hashSelectorEntry *element)
     free(element);
 }
 
+// timer wheel
+
+void Scheduler::attachTimer(_hashSelectorEntry *element, Timer *timer)
+{
+    timer->_schedulerEntry = element;
+    timer->_targetOrder = element->order;
+    timer->_order = ++_timerOrder;
+    scheduleTimerUpdate(timer);
+}
+
+void Scheduler::detachTimer(Timer *timer)
+{
+    unlinkTimer(timer);
+    timer->_schedulerEntry = nullptr;
+}
+
+void Scheduler::scheduleTimerUpdate(Timer *timer)
+{
+    // already waiting to be updated in this frame
+    if (timer->_wheelDue)
+        return;
+
+    unlinkTimer(timer);
+
+    tHashTimerEntry *element = timer->_schedulerEntry;
+    const Timer *currentTimer = _updatingTimers ? _timersDue[_timersDueIndex] : nullptr;
+
+    // like walking the hash of targets, a timer after the one being updated is updated in this frame.
+    // The pause state of the target being updated is not checked again.
+    if (currentTimer && isTimerBefore(currentTimer, timer)
+        && (!element->paused || element->order == currentTimer->_targetOrder))
+    {
+        timer->_wakeTime = _timerFrameStart;
+        insertDueTimer(timer);
+    }
+    else if (element->paused)
+    {
+        // filed when the target is resumed
+        timer->_wakeTime = element->pauseTime;
+    }
+    else
+    {
+        // not later than a pause of the target in this frame, so that it stays due after resumeTarget
+        timer->_wakeTime = _timerFrameStart;
+        linkTimer(timer, &_timersNear);
+    }
+}
+
+void Scheduler::insertDueTimer(Timer *timer)
+{
+    auto pos = std::upper_bound(_timersDue.begin() + _timersDueIndex + 1, _timersDue.end(), timer, &Scheduler::isTimerBefore);
+    timer->retain();
+    timer->_wheelDue = true;
+    _timersDue.insert(pos, timer);
+}
+
+void Scheduler::setTimersPaused(_hashSelectorEntry *element, bool paused)
+{
+    if (element->paused == paused)
+        return;
+
+    element->paused = paused;
+
+    // a target not reached yet by the update of the timers is paused or resumed from the start of the frame
+    const bool pending = _updatingTimers && element->order > _timersDue[_timersDueIndex]->_targetOrder;
+    const double time = pending ? _timerFrameStart : _timerClock;
+
+    if (paused)
+    {
+        // the target time stops, take its timers out of the wheel
+        element->pauseTime = time;
+        for (int i = 0; element->timers && i < element->timers->num; ++i)
+        {
+            unlinkTimer((Timer*)element->timers->arr[i]);
+        }
+    }
+    else
+    {
+        const double pausedTime = time - element->pauseTime;
+        element->pausedDuration += pausedTime;
+        for (int i = 0; element->timers && i < element->timers->num; ++i)
+        {
+            Timer *timer = (Timer*)element->timers->arr[i];
+            if (timer->_wheelDue)
+                continue;
+
+            // timers not initialized yet start with the first update after resuming
+            if (timer->getTimeToNextUpdate() == 0.0f)
+                timer->_wakeTime = time;
+            else
+                timer->_wakeTime += pausedTime;
+
+            // the update of the frame visits all the timers of a target, whether due or not
+            if (pending)
+                insertDueTimer(timer);
+            else
+                insertTimer(timer);
+        }
+    }
+}
+
+void Scheduler::linkTimer(Timer *timer, Timer **list)
+{
+    timer->_wheelList = list;
+    timer->_wheelPrev = nullptr;
+    timer->_wheelNext = *list;
+    if (*list)
+        (*list)->_wheelPrev = timer;
+    *list = timer;
+}
+
+void Scheduler::unlinkTimer(Timer *timer)
+{
+    if (timer->_wheelList == nullptr)
+        return;
+
+    if (timer->_wheelPrev)
+        timer->_wheelPrev->_wheelNext = timer->_wheelNext;
+    else
+        *timer->_wheelList = timer->_wheelNext;
+
+    if (timer->_wheelNext)
+        timer->_wheelNext->_wheelPrev = timer->_wheelPrev;
+
+    timer->_wheelList = nullptr;
+    timer->_wheelPrev = timer->_wheelNext = nullptr;
+}
+
+void Scheduler::insertTimer(Timer *timer)
+{
+    const uint64_t tick = timerWheelTick(timer->_wakeTime);
+    if (tick <= _timerWheelTick)
+    {
+        linkTimer(timer, &_timersNear);
+        return;
+    }
+
+    const uint64_t delta = tick - _timerWheelTick;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (uint64_t(1) << (TIMER_WHEEL_BITS * (level + 1))))
+    {
+        ++level;
+    }
+
+    // too far for the wheel: file it in the farthest slot, it is filed again when that slot cascades
+    const uint64_t maxDelta = (uint64_t(1) << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    const uint64_t slotTick = delta > maxDelta ? _timerWheelTick + maxDelta : tick;
+    const int slot = (int)((slotTick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    linkTimer(timer, &_timerWheel[level][slot]);
+}
+
+void Scheduler::advanceTimerWheel()
+{
+    const uint64_t tick = timerWheelTick(_timerClock);
+
+    if (tick - _timerWheelTick > (uint64_t)(TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS))
+    {
+        // a very long frame: file every timer again instead of walking each tick
+        for (int level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+        {
+            for (int slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot)
+            {
+                while (_timerWheel[level][slot])
+                {
+                    Timer *timer = _timerWheel[level][slot];
+                    unlinkTimer(timer);
+                    linkTimer(timer, &_timersNear);
+                }
+            }
+        }
+        _timerWheelTick = tick;
+    }
+
+    while (_timerWheelTick < tick)
+    {
+        ++_timerWheelTick;
+
+        // when a level wraps around, the timers of the current slot of the next level move down
+        for (int level = 1; level < TIMER_WHEEL_LEVELS; ++level)
+        {
+            if ((_timerWheelTick >> (TIMER_WHEEL_BITS * (level - 1))) & (TIMER_WHEEL_SLOTS - 1))
+                break;
+
+            const int slot = (int)((_timerWheelTick >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+            while (_timerWheel[level][slot])
+            {
+                Timer *timer = _timerWheel[level][slot];
+                unlinkTimer(timer);
+                insertTimer(timer);
+            }
+        }
+
+        Timer **list = &_timerWheel[0][_timerWheelTick & (TIMER_WHEEL_SLOTS - 1)];
+        while (*list)
+        {
+            Timer *timer = *list;
+            unlinkTimer(timer);
+            linkTimer(timer, &_timersNear);
+        }
+    }
+
+    // timers of the current tick that are due
+    for (Timer *timer = _timersNear; timer != nullptr; )
+    {
+        Timer *next = timer->_wheelNext;
+        if (timer->_wakeTime <= _timerClock)
+        {
+            unlinkTimer(timer);
+            timer->retain();
+            timer->_wheelDue = true;
+            _timersDue.push_back(timer);
+        }
+        else if (timerWheelTick(timer->_wakeTime) > _timerWheelTick)
+        {
+            unlinkTimer(timer);
+            insertTimer(timer);
+        }
+        timer = next;
+    }
+}
+
+void Scheduler::updateTimers(float dt)
+{
+    _timerFrameStart = _timerClock;
+    _timerClock += dt;
+
+    advanceTimerWheel();
+    if (_timersDue.empty())
+        return;
+
+    // _timersNear is filled at its head and the timers updated in a frame are filed in update order:
+    // reversed, the due timers are sorted except the ones filed since, which are merged in
+    std::reverse(_timersDue.begin(), _timersDue.end());
+    auto sortedEnd = std::is_sorted_until(_timersDue.begin(), _timersDue.end(), &Scheduler::isTimerBefore);
+    if (sortedEnd != _timersDue.end())
+    {
+        std::sort(sortedEnd, _timersDue.end(), &Scheduler::isTimerBefore);
+        std::inplace_merge(_timersDue.begin(), sortedEnd, _timersDue.end(), &Scheduler::isTimerBefore);
+    }
+
+    _updatingTimers = true;
+
+    uint64_t targetOrder = 0;
+    bool targetPaused = false;
+
+    // The due list may grow while inside this loop
+    for (_timersDueIndex = 0; _timersDueIndex < _timersDue.size(); ++_timersDueIndex)
+    {
+        Timer *timer = _timersDue[_timersDueIndex];
+        tHashTimerEntry *elt = timer->_schedulerEntry;
+        bool updated = false;
+
+        // the pause state of a target is checked once, before updating its first due timer
+        if (elt && elt->order != targetOrder)
+        {
+            targetOrder = elt->order;
+            targetPaused = elt->paused;
+        }
+
+        // skip timers unscheduled by a timer updated before in this frame
+        if (elt && !targetPaused)
+        {
+            _currentTarget = elt;
+            _currentTargetSalvaged = false;
+
+            elt->currentTimer = timer;
+            CCASSERT
+              ( !timer->isAborted(),
+                "An aborted timer should not be updated" );
+
+            // the timer receives the target time elapsed since its last update
+            const double targetTime = _timerClock - elt->pausedDuration;
+            const float timerDelta = (float)(targetTime - timer->_lastTime);
+            timer->_lastTime = targetTime;
+            timer->update(timerDelta);
+            updated = true;
+
+            if (timer->isAborted())
+            {
+                // The currentTimer told the remove itself. To prevent the timer from
+                // accidentally deallocating itself before finishing its step, we retained
+                // it. Now that step is done, it's safe to release it.
+                timer->release();
+            }
+
+            elt->currentTimer = nullptr;
+
+            // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
+            if (_currentTargetSalvaged && elt->timers->num == 0)
+            {
+                removeHashElement(elt);
+            }
+            _currentTarget = nullptr;
+        }
+
+        timer->_wheelDue = false;
+
+        // file it by the time of its next update, timers of paused targets wait for resumeTarget
+        if (timer->_schedulerEntry && timer->_wheelList == nullptr)
+        {
+            if (updated)
+                timer->_wakeTime = _timerClock + timer->getTimeToNextUpdate();
+
+            if (!timer->_schedulerEntry->paused)
+                insertTimer(timer);
+        }
+
+        timer->release();
+    }
+
+    _updatingTimers = false;
+    _timersDue.clear();
+}
+
+bool Scheduler::isTimerBefore(const Timer *a, const Timer *b)
+{
+    // same order as walking the hash of targets and the timers array of each target
+    if (a->_targetOrder != b->_targetOrder)
+        return a->_targetOrder < b->_targetOrder;
+    return a->_order < b->_order;
+}
+
 void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
 {
     this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
@@ -297,11 +664,13 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = ++_timerOrder;
 
         HASH_ADD_PTR(_hashForTimers, target, element);
 
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
         element->paused = paused;
+        element->pauseTime = _timerClock;
     }
     else
     {
@@ -322,6 +691,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                scheduleTimerUpdate(timer);
                 return;
             }
         }
@@ -331,6 +701,7 @@ void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float in
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    attachTimer(element, timer);
     timer->release();
 }
 
@@ -362,14 +733,9 @@ void Scheduler::unschedule(const std::string &key, void *target)
                     timer->setAborted();
                 }
 
+                detachTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
@@ -642,6 +1008,10 @@ void Scheduler::unscheduleAllForTarget(void *target)
             element->currentTimer->retain();
             element->currentTimer->setAborted();
         }
+        for (int i = 0; i < element->timers->num; ++i)
+        {
+            detachTimer((Timer*)element->timers->arr[i]);
+        }
         ccArrayRemoveAllObjects(element->timers);
 
         if (_currentTarget == element)
@@ -690,7 +1060,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        setTimersPaused(element, false);
     }
 
     // update selector
@@ -712,7 +1082,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
     }
 
     // update selector
@@ -761,7 +1131,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        setTimersPaused(element, true);
         idsWithSelectors.insert(element->target);
     }
 
@@ -809,13 +1179,11 @@ void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
 
 void Scheduler::performFunctionInCocosThread(std::function<void ()> function)
 {
-    std::lock_guard<std::mutex> lock(_performMutex);
-    _functionsToPerform.push_back(std::move(function));
+    _functionsToPerform.push(InlineFunction(std::move(function)));
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
-    std::unique_lock<std::mutex> lock(_performMutex);
     _functionsToPerform.clear();
 }
 
@@ -863,46 +1231,8 @@ void Scheduler::update(float dt)
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
-
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
-        }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
-    }
+    // Iterate over the custom selectors that are due
+    updateTimers(dt);
  
     // delete all updates that are removed in update
     for (auto &e : _updateDeleteVector)
@@ -939,18 +1269,8 @@ void Scheduler::update(float dt)
     // Functions allocated from another thread
     //
 
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
-        _performMutex.unlock();
-        
-        for (const auto &function : temp) {
-            function();
-        }
-    }
+    // Functions queued while performing wait for the next frame, fixed #4123.
+    _functionsToPerform.perform(_performFunctionTimeBudget);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
@@ -964,11 +1284,13 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     {
         element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
         element->target = target;
+        element->order = ++_timerOrder;
         
         HASH_ADD_PTR(_hashForTimers, target, element);
         
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
         element->paused = paused;
+        element->pauseTime = _timerClock;
     }
     else
     {
@@ -989,6 +1311,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
             {
                 CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
                 timer->setupTimerWithInterval(interval, repeat, delay);
+                scheduleTimerUpdate(timer);
                 return;
             }
         }
@@ -998,6 +1321,7 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
     ccArrayAppendObject(element->timers, timer);
+    attachTimer(element, timer);
     timer->release();
 }
 
@@ -1062,14 +1386,9 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
                     timer->setAborted();
                 }
                 
+                detachTimer(timer);
                 ccArrayRemoveObjectAtIndex(element->timers, i, true);
                 
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
                 if (element->timers->num == 0)
                 {
                     if (_currentTarget == element)
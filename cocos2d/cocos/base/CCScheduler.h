@@ -35,11 +35,13 @@ THE SOFTWARE.
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
+#include "base/CCFunctionQueue.h"
 #include "base/uthash.h"
 
 NS_CC_BEGIN
 
 class Scheduler;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 
@@ -48,6 +50,7 @@ typedef std::function<void(float)> ccSchedulerFunc;
  */
 class CC_DLL Timer : public Ref
 {
+    friend class Scheduler;
 protected:
     Timer();
 public:
@@ -61,6 +64,9 @@ public:
     
     /** triggers the timer */
     void update(float dt);
+
+    /** time left until the timer triggers, 0 if it has to be updated on the next frame */
+    float getTimeToNextUpdate() const;
     
 protected:
     Scheduler* _scheduler; // weak ref
@@ -72,6 +78,17 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    // timer wheel bookkeeping, owned by the Scheduler
+    struct _hashSelectorEntry* _schedulerEntry; // weak ref, nullptr once unscheduled
+    Timer* _wheelPrev;
+    Timer* _wheelNext;
+    Timer** _wheelList;     // list the timer is linked in, nullptr if not linked
+    bool _wheelDue;         // waiting in the list of timers to update in this frame
+    double _wakeTime;       // scheduler time of the next update
+    double _lastTime;       // target time of the last update
+    uint64_t _targetOrder;  // timers due in the same frame are updated in target order,
+    uint64_t _order;        // then in scheduling order
 };
 
 
@@ -428,6 +445,35 @@ public:
      @js NA
      */
     void performFunctionInCocosThread(std::function<void()> function);
+
+    /** Calls a function on the cocos2d thread, small functors (eg: lambdas with a few captures) are queued without
+     allocating. This function is thread safe.
+     @param function The functor to be run in cocos2d thread.
+     @js NA
+     */
+    template <typename F>
+    void performFunctionInCocosThread(F&& function)
+    {
+        _functionsToPerform.push(InlineFunction(std::forward<F>(function)));
+    }
+
+    /** Sets the time spent each frame running the functions queued with performFunctionInCocosThread.
+     When it is exceeded the remaining functions are run in the next frames, in order. At least one function is run
+     per frame. 0, the default, runs all the functions queued before the frame.
+     @param seconds The time budget, in seconds.
+     @js NA
+     */
+    void setPerformFunctionTimeBudget(float seconds) { _performFunctionTimeBudget = seconds; }
+    /** Returns the time spent each frame running the functions queued with performFunctionInCocosThread, in seconds.
+     @js NA
+     */
+    float getPerformFunctionTimeBudget() const { return _performFunctionTimeBudget; }
+
+    /** Returns the queue depth and latency counters of the functions queued with performFunctionInCocosThread.
+     Must be called from the cocos2d thread.
+     @js NA
+     */
+    const FunctionQueue::Stats& getPerformFunctionStats() const { return _functionsToPerform.getStats(); }
     
     /**
      * Remove all pending functions queued to be performed with Scheduler::performFunctionInCocosThread
@@ -510,6 +556,20 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // timer wheel specific
+
+    void attachTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void detachTimer(Timer *timer);
+    void scheduleTimerUpdate(Timer *timer);
+    void insertDueTimer(Timer *timer);
+    void setTimersPaused(struct _hashSelectorEntry *element, bool paused);
+    void linkTimer(Timer *timer, Timer **list);
+    void unlinkTimer(Timer *timer);
+    void insertTimer(Timer *timer);
+    void advanceTimerWheel();
+    void updateTimers(float dt);
+    static bool isTimerBefore(const Timer *a, const Timer *b);
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -533,14 +593,29 @@ protected:
     bool _currentTargetSalvaged;
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
+
+    // Hierarchical timer wheel of the "selectors with interval", only due timers are updated each frame.
+    // Each level has TIMER_WHEEL_SLOTS slots of TIMER_WHEEL_SLOTS times the tick length of the level below.
+    static const int TIMER_WHEEL_BITS = 6;
+    static const int TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_BITS;
+    static const int TIMER_WHEEL_LEVELS = 4;
+    Timer* _timerWheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+    Timer* _timersNear;                 // timers whose update falls into the current tick
+    std::vector<Timer*> _timersDue;     // timers updated in this frame, sorted by target and scheduling order
+    size_t _timersDueIndex;
+    bool _updatingTimers;
+    double _timerClock;                 // scaled time elapsed since the creation of the scheduler
+    double _timerFrameStart;            // _timerClock before the current frame
+    uint64_t _timerWheelTick;
+    uint64_t _timerOrder;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
 #endif
     
     // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    FunctionQueue _functionsToPerform;
+    float _performFunctionTimeBudget;
 };
 
 // end of base group
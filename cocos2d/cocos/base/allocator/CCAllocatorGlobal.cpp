@@ -27,7 +27,7 @@
 
 #include "base/allocator/CCAllocatorGlobal.h"
 
-#if CC_ENABLE_ALLOCATOR
+#if CC_ENABLE_ALLOCATOR || CC_ENABLE_ALLOCATOR_POOLS || CC_ENABLE_ALLOCATOR_DIAGNOSTICS
 
 NS_CC_BEGIN
 NS_CC_ALLOCATOR_BEGIN
@@ -38,4 +38,4 @@ CC_ALLOCATOR_GLOBAL ccAllocatorGlobal;
 NS_CC_ALLOCATOR_END
 NS_CC_END
 
-#endif // CC_ENABLE_ALLOCATOR
+#endif // CC_ENABLE_ALLOCATOR || CC_ENABLE_ALLOCATOR_POOLS || CC_ENABLE_ALLOCATOR_DIAGNOSTICS
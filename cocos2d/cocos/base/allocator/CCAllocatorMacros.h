@@ -28,6 +28,8 @@
 #define CC_ALLOCATOR_MACROS_H
 /// @cond DO_NOT_SHOW
 
+#include <new>
+
 #include "base/ccConfig.h"
 #include "platform/CCPlatformMacros.h"
 
@@ -128,5 +130,40 @@
     } \
 }
 
+#if CC_ENABLE_ALLOCATOR_POOLS
+
+    // @brief declares the operator new/delete of a class, backed by a pool defined with
+    // CC_DEFINE_ALLOCATOR_POOL in the source file of the class.
+    // Subclasses of another size fall back to the global allocator.
+    #define CC_DECLARE_ALLOCATOR_POOL(T) \
+        static void* operator new (size_t size); \
+        static void* operator new (size_t size, const std::nothrow_t&); \
+        static void* operator new (size_t /*size*/, void* address) { return address; } \
+        static void operator delete (void* object, size_t size); \
+        static void operator delete (void* object, const std::nothrow_t&); \
+        static void operator delete (void* /*object*/, void* /*address*/) {}
+
+    // @brief defines the pool of a class declared with CC_DECLARE_ALLOCATOR_POOL.
+    // The pool is created on first use and never destroyed, objects may be deleted during exit.
+    // Its page size can be overridden by the configuration key "cocos2d.x.allocator.pool.<T>".
+    // The pool is locked, T may be allocated and deleted on any thread (eg: nodes created by a loading thread).
+    #define CC_DEFINE_ALLOCATOR_POOL(T, pageSize) \
+        static NS_CC_ALLOCATOR::AllocatorStrategyPool<T, NS_CC_ALLOCATOR::StorageTraits<T>, NS_CC_ALLOCATOR::locking_semantics>& allocatorPool##T() \
+        { \
+            static auto pool = new NS_CC_ALLOCATOR::AllocatorStrategyPool<T, NS_CC_ALLOCATOR::StorageTraits<T>, NS_CC_ALLOCATOR::locking_semantics>("cocos2d.x.allocator.pool." #T, pageSize); \
+            return *pool; \
+        } \
+        void* T::operator new (size_t size) { return allocatorPool##T().allocate(size); } \
+        void* T::operator new (size_t size, const std::nothrow_t&) { return allocatorPool##T().allocate(size); } \
+        void T::operator delete (void* object, size_t size) { allocatorPool##T().deallocate(object, size); } \
+        void T::operator delete (void* object, const std::nothrow_t&) { allocatorPool##T().deallocate(object); }
+
+#else
+
+    #define CC_DECLARE_ALLOCATOR_POOL(...)
+    #define CC_DEFINE_ALLOCATOR_POOL(...)
+
+#endif
+
 /// @endcond
 #endif//CC_ALLOCATOR_MACROS_H
@@ -221,10 +221,20 @@ protected:
     
 protected:
         
+    // @brief Returns the distance between two blocks of a page.
+    // Small blocks are packed by their power of two size, larger ones only
+    // keep the default alignment instead of wasting up to half of the block.
+    size_t blockStride() const
+    {
+        if (block_size < AllocatorBase::kDefaultAlignment)
+            return AllocatorBase::nextPow2BlockSize(block_size);
+        return (block_size + AllocatorBase::kDefaultAlignment - 1) & ~(size_t)(AllocatorBase::kDefaultAlignment - 1);
+    }
+
     // @brief Returns the size of a page in bytes + overhead.
     size_t pageSize() const
     {
-        return AllocatorBase::kDefaultAlignment + AllocatorBase::nextPow2BlockSize(block_size) * _pageSize;
+        return AllocatorBase::kDefaultAlignment + blockStride() * _pageSize;
     }
     
     // @brief Allocates a new page from the global allocator,
@@ -247,7 +257,7 @@ protected:
         p += AllocatorBase::kDefaultAlignment; // step past the linked list node
         
         _allocated += _pageSize;
-        size_t aligned_size = AllocatorBase::nextPow2BlockSize(block_size);
+        size_t aligned_size = blockStride();
         uint8_t* block = (uint8_t*)p;
         for (unsigned int i = 0; i < _pageSize; ++i, block += aligned_size)
         {
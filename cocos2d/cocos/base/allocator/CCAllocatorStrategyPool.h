@@ -82,6 +82,27 @@ public:
     }
 };
 
+/**
+ * StorageTraits describes an object whose storage only comes from the pool.
+ *
+ * Used by pools backing the operator new and delete of a class, the new-expression
+ * constructs the object and the delete-expression destroys it.
+ *
+ * @param T Type of object.
+ * @param _alignment Alignment of object T.
+ */
+template <typename T, size_t _alignment = AllocatorBase::kDefaultAlignment>
+class StorageTraits : public ObjectTraits<T, _alignment>
+{
+public:
+    
+    void construct(T* /*address*/)
+    {}
+    
+    void destroy(T* /*address*/)
+    {}
+};
+
 /**
  * Fixed sized pool allocator strategy for objects of type T.
  *
@@ -138,6 +159,7 @@ public:
      * Deallocate block of size T.
      *
      * If size does not match sizeof(T) then the global allocator is called instead.
+     * A size of 0 looks up whether the block belongs to the pool.
      * @see CC_USE_ALLOCATOR_POOL
      */
     CC_ALLOCATOR_INLINE void deallocate(void* address, size_t size = 0)
@@ -145,7 +167,7 @@ public:
         if (address)
         {
             O::destroy((T*)address);
-            if (sizeof(T) == size)
+            if (sizeof(T) == size || (0 == size && tParentStrategy::owns(address)))
             {
                 tParentStrategy::deallocate(address, sizeof(T));
             }
@@ -160,7 +182,13 @@ public:
     std::string diagnostics() const
     {
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount << "\n";
+        s << AllocatorBase::tag() << " size:" << sizeof(T) << " stride:" << tParentStrategy::blockStride()
+          << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount;
+
+        size_t pages = 0;
+        for (auto page = (const uintptr_t*)tParentStrategy::_pages; page; page = (const uintptr_t*)*page)
+            ++pages;
+        s << " pages:" << pages << " reserved:" << pages * tParentStrategy::pageSize() << "\n";
         return s.str();
     }    
 #endif
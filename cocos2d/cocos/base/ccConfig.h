@@ -200,6 +200,26 @@ THE SOFTWARE.
 #define CC_LABEL_DEBUG_DRAW 0
 #endif
 
+/** @def CC_ENABLE_ASYNC_GLYPH_RASTERIZATION
+ * If enabled, the TTF font atlases rasterize the new glyphs on the job system, the labels show them
+ * a frame or more after their text changed and their content size is updated then.
+ * To enable set it to a value different than 0. Disabled by default.
+ * It can be changed per atlas with FontAtlas::setAsyncGlyphRasterization().
+ */
+#ifndef CC_ENABLE_ASYNC_GLYPH_RASTERIZATION
+#define CC_ENABLE_ASYNC_GLYPH_RASTERIZATION 0
+#endif
+
+/** @def CC_ENABLE_FONT_ATLAS_PERSISTENT_CACHE
+ * If enabled, the TTF font atlases are saved under the writable path and loaded on the next launch,
+ * the glyphs rasterized once are not rendered by FreeType again.
+ * To enable set it to a value different than 0. Disabled by default.
+ * It can be changed at runtime with FontAtlas::setPersistentCacheEnabled().
+ */
+#ifndef CC_ENABLE_FONT_ATLAS_PERSISTENT_CACHE
+#define CC_ENABLE_FONT_ATLAS_PERSISTENT_CACHE 0
+#endif
+
 /** @def CC_SPRITEBATCHNODE_DEBUG_DRAW
  * If enabled, all subclasses of Sprite that are rendered using an SpriteBatchNode draw a bounding box.
  * Useful for debugging purposes only. It is recommended to leave it disabled.
@@ -247,6 +267,16 @@ THE SOFTWARE.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_FRAME_PROFILER
+ * If enabled, the main phases of each frame are recorded by FrameProfiler, once it is enabled with
+ * FrameProfiler::setEnabled(), and can be exported in the Chrome trace format.
+ * When disabled, the CC_FRAME_PROFILER_* macros compile to nothing.
+ * To enable set it to a value different than 0. Disabled by default.
+ */
+#ifndef CC_ENABLE_FRAME_PROFILER
+#define CC_ENABLE_FRAME_PROFILER 0
+#endif
+
 /** Enable Lua engine debug log. */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
@@ -368,12 +398,25 @@ THE SOFTWARE.
 # define CC_ENABLE_ALLOCATOR 0
 #endif
 
+/** @def CC_ENABLE_ALLOCATOR_POOLS
+ * Turn on the per type pool allocators of Node, Sprite, ParticleSystemQuad and the common actions.
+ * Each pool is protected by a mutex, the pooled objects may be created and deleted on any thread.
+ */
+#ifndef CC_ENABLE_ALLOCATOR_POOLS
+# define CC_ENABLE_ALLOCATOR_POOLS 1
+#endif
+
 /** @def CC_ENABLE_ALLOCATOR_DIAGNOSTICS
  * Turn on debugging of allocators. This is slower, uses
  * more memory, and should not be used for production builds.
+ * The pool allocators are tracked in debug builds, see the "allocator" console command.
  */
 #ifndef CC_ENABLE_ALLOCATOR_DIAGNOSTICS
-# define CC_ENABLE_ALLOCATOR_DIAGNOSTICS CC_ENABLE_ALLOCATOR
+# if CC_ENABLE_ALLOCATOR || (CC_ENABLE_ALLOCATOR_POOLS && COCOS2D_DEBUG > 0)
+#  define CC_ENABLE_ALLOCATOR_DIAGNOSTICS 1
+# else
+#  define CC_ENABLE_ALLOCATOR_DIAGNOSTICS 0
+# endif
 #endif
 
 /** @def CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
@@ -410,6 +453,15 @@ THE SOFTWARE.
 # define CC_ENABLE_PREMULTIPLIED_ALPHA 1
 #endif
 
+/** @def CC_IMAGE_PARALLEL_MIN_PIXELS
+ * Images with at least this many pixels are premultiplied and converted to other pixel formats
+ * in blocks of rows on the job system, smaller images are processed on the calling thread.
+ * Set it to 0 to always process the images on the calling thread.
+ */
+#ifndef CC_IMAGE_PARALLEL_MIN_PIXELS
+# define CC_IMAGE_PARALLEL_MIN_PIXELS (512 * 512)
+#endif
+
 /** @def CC_STRIP_FPS
  * Whether to strip FPS related data and functions, such as cc_fps_images_png
  */
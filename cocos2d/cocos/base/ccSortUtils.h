@@ -0,0 +1,121 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __BASE_CCSORTUTILS_H__
+#define __BASE_CCSORTUTILS_H__
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+namespace utils
+{
+    /**
+     * Sorts a sequence which was sorted before some of its elements moved, like the children of a node after a few
+     * of them were reordered.
+     * The elements which didn't move are packed in front, the moved ones are sorted alone and merged back from the
+     * end. When half of the elements or more moved, or when the others aren't sorted anymore, the whole sequence is
+     * sorted instead.
+     *
+     * @param first, last The sequence to sort.
+     * @param movedCount The number of elements which moved.
+     * @param moved A buffer for the moved elements, reused between the sorts.
+     * @param takeMoved Returns whether an element moved, and clears that state.
+     * @param less The order of the elements.
+     */
+    template <typename RandomIt, typename T, typename TakeMoved, typename Less>
+    void sortMovedElements(RandomIt first, RandomIt last, std::ptrdiff_t movedCount, std::vector<T>& moved,
+                           TakeMoved takeMoved, Less less)
+    {
+        // with many moved elements a full sort is as fast
+        if (movedCount * 2 >= std::distance(first, last))
+        {
+            for (auto iter = first; iter != last; ++iter)
+            {
+                takeMoved(*iter);
+            }
+            std::sort(first, last, less);
+            return;
+        }
+
+        moved.clear();
+
+        bool keptSorted = true;
+        auto kept = first;
+        for (auto iter = first; iter != last; ++iter)
+        {
+            T element = *iter;
+            if (takeMoved(element))
+            {
+                moved.push_back(element);
+            }
+            else
+            {
+                // the order of an element may have changed without it being moved
+                if (kept != first && less(element, *(kept - 1)))
+                {
+                    keptSorted = false;
+                }
+                *kept++ = element;
+            }
+        }
+        std::copy(moved.begin(), moved.end(), kept);
+
+        if (!keptSorted)
+        {
+            std::sort(first, last, less);
+            return;
+        }
+
+        std::sort(moved.begin(), moved.end(), less);
+
+        auto write = last;
+        auto next = moved.end();
+        while (next != moved.begin())
+        {
+            if (kept != first && less(*(next - 1), *(kept - 1)))
+            {
+                *--write = *--kept;
+            }
+            else
+            {
+                *--write = *--next;
+            }
+        }
+    }
+}
+
+NS_CC_END
+// end group
+/// @}
+
+#endif // __BASE_CCSORTUTILS_H__
@@ -953,16 +953,17 @@ Node* CSLoader::nodeWithFlatBuffersFile(const std::string &fileName, const ccNod
     
     CC_ASSERT(FileUtils::getInstance()->isFileExist(fullPath));
     
-    Data buf = FileUtils::getInstance()->getDataFromFile(fullPath);
+    // the tree is only read while the nodes are created, so the file can be read in place
+    auto buf = FileUtils::getInstance()->mapFile(fullPath);
 
-    if (buf.isNull())
+    if (!buf)
     {
         CCLOG("CSLoader::nodeWithFlatBuffersFile - failed read file: %s", fileName.c_str());
         CC_ASSERT(false);
         return nullptr;
     }
 
-    auto csparsebinary = GetCSParseBinary(buf.getBytes());
+    auto csparsebinary = GetCSParseBinary(buf->getBytes());
     
     
     auto csBuildId = csparsebinary->version();
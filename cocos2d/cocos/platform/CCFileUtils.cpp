@@ -26,11 +26,13 @@ THE SOFTWARE.
 
 #include "platform/CCFileUtils.h"
 
+#include <algorithm>
 #include <stack>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCPackFile.h"
 #include "platform/CCSAXParser.h"
 //#include "base/ccUtils.h"
 
@@ -41,6 +43,11 @@ THE SOFTWARE.
 #include "unzip.h"
 #endif
 #include <sys/stat.h>
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #define DECLARE_GUARD std::lock_guard<std::recursive_mutex> mutexGuard(_mutex)
 
@@ -554,7 +561,9 @@ void FileUtils::setDelegate(FileUtils *delegate)
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _searchPathIndexEnabled(false)
+    , _searchPathIndexDirty(true)
+    , _writablePath("")
 {
 }
 
@@ -599,6 +608,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
 
         fclose(fp);
 
+        updateCachedEntry(fullPath, true);
         return true;
     } while (0);
 
@@ -625,6 +635,147 @@ void FileUtils::purgeCachedEntries()
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
+    _searchPathIndexDirty = true;
+}
+
+void FileUtils::setSearchPathIndexEnabled(bool enabled)
+{
+    DECLARE_GUARD;
+    if (_searchPathIndexEnabled == enabled)
+        return;
+
+    _searchPathIndexEnabled = enabled;
+    _searchPathIndex.clear();
+    _indexedSearchPaths.clear();
+    _searchPathIndexDirty = true;
+
+    // list the search paths now rather than on the first lookup
+    if (enabled)
+        buildSearchPathIndex();
+}
+
+bool FileUtils::isSearchPathIndexEnabled() const
+{
+    DECLARE_GUARD;
+    return _searchPathIndexEnabled;
+}
+
+bool FileUtils::mountPack(const std::string& packFile, bool front)
+{
+    std::string fullPath = fullPathForFilename(packFile);
+    if (fullPath.empty())
+        return false;
+
+    std::shared_ptr<PackFile> pack(PackFile::createWithMappedFile(mapFile(fullPath)));
+    if (!pack)
+    {
+        CCLOG("cocos2d: FileUtils: %s is not a valid pack", fullPath.c_str());
+        return false;
+    }
+
+    DECLARE_GUARD;
+    std::string searchPath = fullPath + "/";
+    bool remounted = _mountedPacks.find(searchPath) != _mountedPacks.end();
+    _mountedPacks[searchPath] = pack;
+
+    _fullPathCache.clear();
+    _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
+    if (!remounted)
+        addSearchPath(fullPath, front);
+    return true;
+}
+
+void FileUtils::unmountPack(const std::string& packFile)
+{
+    std::string fullPath = fullPathForFilename(packFile);
+    if (fullPath.empty())
+        return;
+
+    DECLARE_GUARD;
+    std::string searchPath = fullPath + "/";
+    if (_mountedPacks.erase(searchPath) == 0)
+        return;
+
+    _searchPathArray.erase(std::remove(_searchPathArray.begin(), _searchPathArray.end(), searchPath), _searchPathArray.end());
+    _originalSearchPaths.erase(std::remove_if(_originalSearchPaths.begin(), _originalSearchPaths.end(), [&](const std::string& path) {
+        return path == fullPath || path == searchPath;
+    }), _originalSearchPaths.end());
+
+    _fullPathCache.clear();
+    _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
+}
+
+std::shared_ptr<PackFile> FileUtils::findPack(const std::string& fullPath, std::string& entryName) const
+{
+    DECLARE_GUARD;
+    for (const auto& mounted : _mountedPacks)
+    {
+        if (fullPath.compare(0, mounted.first.size(), mounted.first) == 0)
+        {
+            entryName = fullPath.substr(mounted.first.size());
+            return mounted.second;
+        }
+    }
+    return nullptr;
+}
+
+bool FileUtils::lookupSearchPathIndex(const std::string& fullPath, bool& exists) const
+{
+    if (!_searchPathIndexEnabled && _mountedPacks.empty())
+        return false;
+
+    // the index and the packs only hold normalized paths, leave "./", "../" and "//" to the file system
+    if (fullPath.find("/.") != std::string::npos || fullPath.find("//") != std::string::npos)
+        return false;
+
+    std::string entryName;
+    if (auto pack = findPack(fullPath, entryName))
+    {
+        exists = pack->findEntry(entryName) != nullptr;
+        return true;
+    }
+
+    if (!_searchPathIndexEnabled)
+        return false;
+
+    if (_searchPathIndexDirty)
+        buildSearchPathIndex();
+
+    for (const auto& searchPath : _indexedSearchPaths)
+    {
+        if (fullPath.compare(0, searchPath.size(), searchPath) == 0)
+        {
+            exists = _searchPathIndex.find(fullPath) != _searchPathIndex.end();
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileUtils::updateCachedEntry(const std::string& fullPath, bool exists) const
+{
+    DECLARE_GUARD;
+
+    // a file that was missing may just have been created
+    _fullPathCacheMisses.clear();
+
+    if (!_searchPathIndexEnabled || _searchPathIndexDirty)
+        return;
+
+    for (const auto& searchPath : _indexedSearchPaths)
+    {
+        if (fullPath.compare(0, searchPath.size(), searchPath) == 0)
+        {
+            if (exists)
+                _searchPathIndex.insert(fullPath);
+            else
+                _searchPathIndex.erase(fullPath);
+            return;
+        }
+    }
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename) const
@@ -670,6 +821,13 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    std::string entryName;
+    if (auto pack = fs->findPack(fullPath, entryName))
+    {
+        auto entry = pack->findEntry(entryName);
+        return entry ? pack->getContents(entry, buffer) : Status::NotExists;
+    }
+
     std::string suitableFullPath = fs->getSuitableFOpen(fullPath);
 
     struct stat statBuf;
@@ -699,6 +857,74 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     return Status::OK;
 }
 
+MappedFile::MappedFile(Data&& data)
+: _bytes(nullptr)
+, _size(0)
+, _data(std::move(data))
+{
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+}
+
+MappedFile::MappedFile(const unsigned char* bytes, ssize_t size, std::function<void()> release)
+: _bytes(bytes)
+, _size(size)
+, _release(std::move(release))
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (_release)
+        _release();
+}
+
+std::shared_ptr<const MappedFile> FileUtils::mapFile(const std::string& filename) const
+{
+    std::string fullPath = fullPathForFilename(filename);
+
+    std::string entryName;
+    if (auto pack = findPack(fullPath, entryName))
+    {
+        auto entry = pack->findEntry(entryName);
+        return entry ? pack->mapEntry(entry) : nullptr;
+    }
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    // small files are cheaper to read than to map, a mapping costs at least a page and a few syscalls
+    static const off_t MIN_MAPPED_FILE_SIZE = 16 * 1024;
+
+    if (!fullPath.empty() && isAbsolutePath(fullPath))
+    {
+        int fd = open(getSuitableFOpen(fullPath).c_str(), O_RDONLY);
+        if (fd != -1)
+        {
+            void* bytes = MAP_FAILED;
+            struct stat statBuf;
+            if (fstat(fd, &statBuf) == 0 && S_ISREG(statBuf.st_mode) && statBuf.st_size >= MIN_MAPPED_FILE_SIZE)
+            {
+                bytes = mmap(nullptr, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            // the mapping keeps its own reference to the file
+            close(fd);
+
+            if (bytes != MAP_FAILED)
+            {
+                size_t size = statBuf.st_size;
+                return std::make_shared<const MappedFile>((const unsigned char*)bytes, (ssize_t)size, [bytes, size]() {
+                    munmap(bytes, size);
+                });
+            }
+        }
+    }
+#endif
+
+    Data data;
+    if (getContents(filename, &data) != Status::OK)
+        return nullptr;
+    return std::make_shared<const MappedFile>(std::move(data));
+}
+
 unsigned char* FileUtils::getFileData(const std::string& filename, const char* mode, ssize_t *size) const
 {
     CCASSERT(!filename.empty() && size != nullptr && mode != nullptr, "Invalid parameters.");
@@ -836,16 +1062,53 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return cacheIter->second;
     }
 
+    // Already known to be missing ?
+    if (_fullPathCacheMisses.find(filename) != _fullPathCacheMisses.end())
+    {
+        return "";
+    }
+
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
+    // Split it as getPathForFilename() does, to look the candidates up in the packs and the search path index
+    std::string fileDirectory;
+    std::string fileName = newFilename;
+    bool lookupIndex = _searchPathIndexEnabled || !_mountedPacks.empty();
+    if (lookupIndex)
+    {
+        size_t pos = newFilename.find_last_of('/');
+        if (pos != std::string::npos)
+        {
+            fileDirectory = newFilename.substr(0, pos + 1);
+            fileName = newFilename.substr(pos + 1);
+        }
+    }
+
     std::string fullpath;
 
     for (const auto& searchIt : _searchPathArray)
     {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            bool exists = false;
+            if (lookupIndex)
+            {
+                fullpath = searchIt + fileDirectory + resolutionIt + fileName;
+                if (lookupSearchPathIndex(fullpath, exists))
+                {
+                    if (!exists)
+                        fullpath.clear();
+                }
+                else
+                {
+                    fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+                }
+            }
+            else
+            {
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            }
 
             if (!fullpath.empty())
             {
@@ -857,6 +1120,8 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         }
     }
 
+    _fullPathCacheMisses.insert(filename);
+
     if(isPopupNotify()){
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -937,6 +1202,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -969,6 +1235,8 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     if (!resOrder.empty() && resOrder[resOrder.length()-1] != '/')
         resOrder.append("/");
 
+    _fullPathCacheMisses.clear();
+
     if (front) {
         _searchResolutionsOrderArray.insert(_searchResolutionsOrderArray.begin(), resOrder);
     } else {
@@ -1013,6 +1281,7 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
     {
         _fullPathCache.clear();
         _fullPathCacheDir.clear();
+        _fullPathCacheMisses.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
         {
@@ -1032,6 +1301,8 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
+    _searchPathIndexDirty = true;
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -1075,6 +1346,9 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         path += "/";
     }
 
+    _fullPathCacheMisses.clear();
+    _searchPathIndexDirty = true;
+
     if (front) {
         _originalSearchPaths.insert(_originalSearchPaths.begin(), searchpath);
         _searchPathArray.insert(_searchPathArray.begin(), path);
@@ -1089,6 +1363,7 @@ void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMisses.clear();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1131,6 +1406,10 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        // only the packs answer absolute paths, the search path index may miss the files written since it was built
+        std::string entryName;
+        if (auto pack = findPack(filename, entryName))
+            return pack->findEntry(entryName) != nullptr;
         return isFileExistInternal(filename);
     }
     else
@@ -1300,6 +1579,14 @@ bool FileUtils::renameFile(const std::string &path, const std::string &oldname,
     return false;
 }
 
+void FileUtils::buildSearchPathIndex() const
+{
+    // file names are not case sensitive on windows, the search paths are always checked on the disk
+    _searchPathIndex.clear();
+    _indexedSearchPaths.clear();
+    _searchPathIndexDirty = false;
+}
+
 std::string FileUtils::getSuitableFOpen(const std::string& filenameUtf8) const
 {
     CCASSERT(false, "getSuitableFOpen should be override by platform FileUtils");
@@ -1453,6 +1740,7 @@ bool FileUtils::removeFile(const std::string &path) const
     if (remove(path.c_str())) {
         return false;
     } else {
+        updateCachedEntry(path, false);
         return true;
     }
 }
@@ -1469,6 +1757,8 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    updateCachedEntry(oldfullpath, false);
+    updateCachedEntry(newfullpath, true);
     return true;
 }
 
@@ -1481,6 +1771,80 @@ bool FileUtils::renameFile(const std::string &path, const std::string &oldname,
     return this->renameFile(oldPath, newPath);
 }
 
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
+void FileUtils::buildSearchPathIndex() const
+{
+    // file names are not case sensitive on the default file system of macOS, which the iOS simulator uses too,
+    // the search paths are always checked on the disk
+    _searchPathIndex.clear();
+    _indexedSearchPaths.clear();
+    _searchPathIndexDirty = false;
+}
+#else
+// a link to a parent directory would make the listing endless
+static const int MAX_INDEXED_DIRECTORY_DEPTH = 32;
+
+static bool indexDirectory(const std::string& directory, std::unordered_set<std::string>& index, int depth)
+{
+    if (depth > MAX_INDEXED_DIRECTORY_DEPTH)
+        return false;
+
+    tinydir_dir dir;
+    if (tinydir_open(&dir, directory.c_str()) == -1)
+        return false;
+
+    bool ret = true;
+    while (ret && dir.has_next)
+    {
+        tinydir_file file;
+        if (tinydir_readfile(&dir, &file) == -1)
+        {
+            ret = false;
+            break;
+        }
+
+        std::string fileName = file.name;
+        if (fileName != "." && fileName != "..")
+        {
+            // built from the search path itself, so that it matches the paths built by fullPathForFilename()
+            std::string path = directory + fileName;
+            if (file.is_dir)
+                ret = indexDirectory(path + "/", index, depth + 1);
+            else
+                index.insert(path);
+        }
+
+        if (tinydir_next(&dir) == -1)
+        {
+            ret = false;
+        }
+    }
+    tinydir_close(&dir);
+    return ret;
+}
+
+void FileUtils::buildSearchPathIndex() const
+{
+    _searchPathIndex.clear();
+    _indexedSearchPaths.clear();
+    _searchPathIndexDirty = false;
+
+    for (const auto& searchPath : _searchPathArray)
+    {
+        // directories of the file system only, paths such as "assets/" on android are resolved by the platform
+        if (searchPath.empty() || searchPath[0] != '/' || searchPath[searchPath.length()-1] != '/'
+            || _indexedSearchPaths.find(searchPath) != _indexedSearchPaths.end()
+            || !isDirectoryExistInternal(searchPath))
+            continue;
+
+        if (indexDirectory(searchPath, _searchPathIndex, 0))
+            _indexedSearchPaths.insert(searchPath);
+        else
+            CCLOG("cocos2d: FileUtils: failed to index the search path %s", searchPath.c_str());
+    }
+}
+#endif
+
 std::string FileUtils::getSuitableFOpen(const std::string& filenameUtf8) const
 {
     return filenameUtf8;
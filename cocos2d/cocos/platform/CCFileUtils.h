@@ -26,9 +26,12 @@ THE SOFTWARE.
 #ifndef __CC_FILEUTILS_H__
 #define __CC_FILEUTILS_H__
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <mutex>
 
@@ -47,6 +50,7 @@ NS_CC_BEGIN
  * @{
  */
 
+class PackFile;
 
 class ResizableBuffer {
 public:
@@ -118,6 +122,33 @@ public:
     }
 };
 
+/** Read-only contents of a file returned by FileUtils::mapFile().
+ * The bytes are mapped from the file when the platform allows it, otherwise they are read into a buffer
+ * owned by the object. They stay valid as long as a reference to the object is kept.
+ */
+class CC_DLL MappedFile
+{
+public:
+    /** Takes the ownership of the buffer of data. */
+    explicit MappedFile(Data&& data);
+    /** Refers to bytes owned by the platform, release is called on destruction. */
+    MappedFile(const unsigned char* bytes, ssize_t size, std::function<void()> release);
+    ~MappedFile();
+
+    const unsigned char* getBytes() const { return _bytes; }
+    ssize_t getSize() const { return _size; }
+    /** Whether the bytes were mapped instead of being copied to the heap. */
+    bool isMapped() const { return _release != nullptr; }
+
+private:
+    const unsigned char* _bytes;
+    ssize_t _size;
+    Data _data;
+    std::function<void()> _release;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(MappedFile);
+};
+
 /** Helper class to handle file operations. */
 class CC_DLL FileUtils
 {
@@ -162,9 +193,26 @@ public:
 
     /**
      *  Purges full path caches.
+     *  Filenames that were not found are cached too, call this method after adding files to the
+     *  search paths without using FileUtils.
      */
     virtual void purgeCachedEntries();
 
+    /**
+     *  Sets whether to index the files of the search paths in memory.
+     *  When enabled, every search path that is a directory of the file system is listed once, and
+     *  fullPathForFilename() resolves the files in it without touching the disk. The index is rebuilt
+     *  when the search paths change or the caches are purged. Assets packed in the apk are not indexed.
+     *  Windows, macOS and iOS don't index the search paths since their file names are not case sensitive.
+     *  Disabled by default.
+     *
+     *  @param enabled True to index the search paths.
+     */
+    void setSearchPathIndexEnabled(bool enabled);
+
+    /** Checks whether the files of the search paths are indexed in memory. */
+    bool isSearchPathIndexEnabled() const;
+
     /**
      *  Gets string from a file.
      */
@@ -274,6 +322,17 @@ public:
     }
     virtual Status getContents(const std::string& filename, ResizableBuffer* buffer) const;
 
+    /**
+     *  Gets a read-only view of the contents of a file without copying it when possible.
+     *  Regular files on Linux and Android are mapped into memory, assets packed in the apk are
+     *  accessed through their uncompressed buffer. Other files are read with getContents().
+     *
+     *  @param[in]  filename The resource file name which contains the path.
+     *  @return The contents of the file, or nullptr if it could not be read.
+     *  @note Subclasses overriding getContents() should override this method too.
+     */
+    virtual std::shared_ptr<const MappedFile> mapFile(const std::string& filename) const;
+
     /**
      *  Gets resource file data
      *
@@ -464,6 +523,24 @@ public:
       */
     void addSearchPath(const std::string & path, const bool front=false);
 
+    /**
+     *  Mounts a pack file built by tools/pack_assets.py as a search path.
+     *  The files of the pack are found as if they were in a directory named like the pack,
+     *  "images/piece.png" in "/path/to/base.pack" is read from "/path/to/base.pack/images/piece.png".
+     *  The pack is read in place from a mapped file, on Android it should be stored uncompressed in the apk.
+     *
+     *  @param packFile The pack file, it could be a relative or an absolute path.
+     *  @param front Whether the pack is searched before the other search paths.
+     *  @return True if the pack was mounted.
+     */
+    bool mountPack(const std::string& packFile, bool front = false);
+
+    /**
+     *  Unmounts a pack file mounted by mountPack().
+     *  Files already read from the pack stay valid.
+     */
+    void unmountPack(const std::string& packFile);
+
     /**
      *  Gets the array of search paths.
      *
@@ -886,6 +963,32 @@ protected:
      */
     virtual bool isDirectoryExistInternal(const std::string& dirPath) const;
 
+    /**
+     *  Lists the files of the search paths into _searchPathIndex.
+     */
+    void buildSearchPathIndex() const;
+
+    /**
+     *  Checks a full path against the mounted packs and the search path index.
+     *  @param fullPath The full path built from a search path.
+     *  @param[out] exists Whether the file is in the index.
+     *  @return True if the path is covered by the index, false if it has to be checked on the disk.
+     */
+    bool lookupSearchPathIndex(const std::string& fullPath, bool& exists) const;
+
+    /**
+     *  Finds the mounted pack holding a full path.
+     *  @param fullPath The full path of a file.
+     *  @param[out] entryName The name of the file in the pack.
+     *  @return The pack, or nullptr if the path is not in a mounted pack.
+     */
+    std::shared_ptr<PackFile> findPack(const std::string& fullPath, std::string& entryName) const;
+
+    /**
+     *  Updates the path caches after a file was written or removed through FileUtils.
+     */
+    void updateCachedEntry(const std::string& fullPath, bool exists) const;
+
     /**
      *  Gets full path for filename, resolution directory and search path.
      *
@@ -968,6 +1071,25 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCacheDir;
 
+    /**
+     *  The filenames that were not found in the search paths, so that missing files are not looked up again.
+     */
+    mutable std::unordered_set<std::string> _fullPathCacheMisses;
+
+    /**
+     *  The index of the files in the search paths, see setSearchPathIndexEnabled().
+     *  _indexedSearchPaths holds the search paths listed in _searchPathIndex.
+     */
+    bool _searchPathIndexEnabled;
+    mutable bool _searchPathIndexDirty;
+    mutable std::unordered_set<std::string> _searchPathIndex;
+    mutable std::unordered_set<std::string> _indexedSearchPaths;
+
+    /**
+     *  The packs mounted with mountPack(), keyed by their search path ("/path/to/base.pack/").
+     */
+    std::unordered_map<std::string, std::shared_ptr<PackFile>> _mountedPacks;
+
     /**
      * Writable path.
      */
@@ -44,6 +44,35 @@ namespace {
     // System touch pointer ID (It may not be ascending order number) <-> Ascending order number from 0
     static std::map<intptr_t, int> g_touchIdReorderMap;
     
+    // Buffers of the touches of the dispatched events, reused so that a touch event doesn't allocate.
+    // A touch event dispatched by a touch listener takes the next buffer.
+    static std::vector<std::vector<Touch*>> g_touchBuffers;
+    static size_t g_touchBuffersInUse = 0;
+
+    class TouchBufferScope
+    {
+    public:
+        explicit TouchBufferScope(std::vector<Touch*>& touches)
+        : _touches(touches)
+        {
+            if (g_touchBuffersInUse == g_touchBuffers.size())
+            {
+                g_touchBuffers.push_back(std::vector<Touch*>());
+                g_touchBuffers.back().reserve(EventTouch::MAX_TOUCHES);
+            }
+            _touches.swap(g_touchBuffers[g_touchBuffersInUse++]);
+            _touches.clear();
+        }
+
+        ~TouchBufferScope()
+        {
+            _touches.swap(g_touchBuffers[--g_touchBuffersInUse]);
+        }
+
+    private:
+        std::vector<Touch*>& _touches;
+    };
+    
     static int getUnUsedIndex()
     {
         int i;
@@ -300,6 +329,7 @@ void GLView::handleTouchesBegin(int num, intptr_t ids[], float xs[], float ys[])
     float y = 0.0f;
     int unusedIndex = 0;
     EventTouch touchEvent;
+    TouchBufferScope touchBuffer(touchEvent._touches);
     
     for (int i = 0; i < num; ++i)
     {
@@ -355,6 +385,7 @@ void GLView::handleTouchesMove(int num, intptr_t ids[], float xs[], float ys[],
     float force = 0.0f;
     float maxForce = 0.0f;
     EventTouch touchEvent;
+    TouchBufferScope touchBuffer(touchEvent._touches);
     
     for (int i = 0; i < num; ++i)
     {
@@ -405,6 +436,7 @@ void GLView::handleTouchesOfEndOrCancel(EventTouch::EventCode eventCode, int num
     float x = 0.0f;
     float y = 0.0f;
     EventTouch touchEvent;
+    TouchBufferScope touchBuffer(touchEvent._touches);
     
     for (int i = 0; i < num; ++i)
     {
@@ -107,7 +107,18 @@ extern "C"
 #include "platform/CCStdC.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
+#include "base/CCJobSystem.h"
 #include "base/ccUtils.h"
+
+//#define USE_SSE2          : SSE2 code used for the pixel loops
+//#define USE_NEON          : NEON code used for the pixel loops
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
 #include "base/ZipUtils.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
@@ -116,6 +127,12 @@ extern "C"
 #define CC_GL_ATC_RGB_AMD                                          0x8C92
 #define CC_GL_ATC_RGBA_EXPLICIT_ALPHA_AMD                          0x8C93
 #define CC_GL_ATC_RGBA_INTERPOLATED_ALPHA_AMD                      0x87EE
+#define CC_GL_ETC1_RGB8_OES                                        0x8D64
+#define CC_GL_COMPRESSED_RGB8_ETC2                                 0x9274
+#define CC_GL_COMPRESSED_RGBA8_ETC2_EAC                            0x9278
+#define CC_GL_COMPRESSED_RGBA_ASTC_4x4_KHR                         0x93B0
+#define CC_GL_COMPRESSED_RGBA_ASTC_6x6_KHR                         0x93B4
+#define CC_GL_COMPRESSED_RGBA_ASTC_8x8_KHR                         0x93B7
 
 NS_CC_BEGIN
 
@@ -511,11 +528,12 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    // every decoder copies what it keeps, so the file can be read in place
+    auto file = FileUtils::getInstance()->mapFile(_filePath);
 
-    if (!data.isNull())
+    if (file)
     {
-        ret = initWithImageData(data.getBytes(), data.getSize());
+        ret = initWithImageData(file->getBytes(), file->getSize());
     }
 
     return ret;
@@ -526,11 +544,12 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    // every decoder copies what it keeps, so the file can be read in place
+    auto file = FileUtils::getInstance()->mapFile(fullpath);
 
-    if (!data.isNull())
+    if (file)
     {
-        ret = initWithImageData(data.getBytes(), data.getSize());
+        ret = initWithImageData(file->getBytes(), file->getSize());
     }
 
     return ret;
@@ -2005,7 +2024,8 @@ bool Image::initWithATITCData(const unsigned char *data, ssize_t dataLen)
             blockSize = 16;
             break;
         default:
-            break;
+            // the other compressed formats written in .ktx files (ETC1, ETC2, ASTC)
+            return initWithKTXData(data, dataLen);
     }
     
     /* pixelData point to the compressed data address */
@@ -2113,6 +2133,154 @@ bool Image::initWithATITCData(const unsigned char *data, ssize_t dataLen)
     return true;
 }
 
+bool Image::initWithKTXData(const unsigned char *data, ssize_t dataLen)
+{
+    if (dataLen < (ssize_t)sizeof(ATITCTexHeader))
+    {
+        return false;
+    }
+
+    const ATITCTexHeader *header = (const ATITCTexHeader *)data;
+    if (header->endianness != 0x04030201)
+    {
+        CCLOG("cocos2d: WARNING: ktx files in big endian are not supported");
+        return false;
+    }
+    if (header->pixelDepth > 1 || header->numberOfArrayElements > 1 || header->numberOfFaces > 1)
+    {
+        CCLOG("cocos2d: WARNING: only 2D ktx textures are supported");
+        return false;
+    }
+
+    Texture2D::PixelFormat format = Texture2D::PixelFormat::NONE;
+    bool supported = false;
+    switch (header->glInternalFormat)
+    {
+        case CC_GL_ETC1_RGB8_OES:
+            format = Texture2D::PixelFormat::ETC;
+            supported = Configuration::getInstance()->supportsETC();
+            break;
+        case CC_GL_COMPRESSED_RGB8_ETC2:
+            format = Texture2D::PixelFormat::ETC2_RGB;
+            supported = Configuration::getInstance()->supportsETC2();
+            break;
+        case CC_GL_COMPRESSED_RGBA8_ETC2_EAC:
+            format = Texture2D::PixelFormat::ETC2_RGBA;
+            supported = Configuration::getInstance()->supportsETC2();
+            break;
+        case CC_GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+            format = Texture2D::PixelFormat::ASTC_4x4;
+            supported = Configuration::getInstance()->supportsASTC();
+            break;
+        case CC_GL_COMPRESSED_RGBA_ASTC_6x6_KHR:
+            format = Texture2D::PixelFormat::ASTC_6x6;
+            supported = Configuration::getInstance()->supportsASTC();
+            break;
+        case CC_GL_COMPRESSED_RGBA_ASTC_8x8_KHR:
+            format = Texture2D::PixelFormat::ASTC_8x8;
+            supported = Configuration::getInstance()->supportsASTC();
+            break;
+        default:
+            CCLOG("cocos2d: WARNING: unsupported ktx internal format: 0x%04X", header->glInternalFormat);
+            return false;
+    }
+
+    // only ETC1 has a software decoder, the other formats must be uploaded as is
+    if (!supported && format != Texture2D::PixelFormat::ETC)
+    {
+        CCLOG("cocos2d: WARNING: the GPU doesn't support the ktx internal format 0x%04X", header->glInternalFormat);
+        return false;
+    }
+
+    _width = header->pixelWidth;
+    _height = header->pixelHeight;
+    _numberOfMipmaps = MIN(MAX((int)header->numberOfMipmapLevels, 1), MIPMAP_MAX);
+    if (0 == _width || 0 == _height)
+    {
+        return false;
+    }
+
+    // each level is the 4 bytes imageSize followed by the blocks, padded to 4 bytes
+    const unsigned char* levels[MIPMAP_MAX];
+    uint32_t levelSizes[MIPMAP_MAX];
+    ssize_t offset = sizeof(ATITCTexHeader) + header->bytesOfKeyValueData;
+    ssize_t totalSize = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        if (offset + 4 > dataLen)
+        {
+            CCLOG("cocos2d: WARNING: ktx file is truncated");
+            return false;
+        }
+        memcpy(&levelSizes[i], data + offset, 4);
+        offset += 4;
+        if (offset + (ssize_t)levelSizes[i] > dataLen)
+        {
+            CCLOG("cocos2d: WARNING: ktx file is truncated");
+            return false;
+        }
+        levels[i] = data + offset;
+        totalSize += levelSizes[i];
+        offset += (levelSizes[i] + 3) & ~3u;
+    }
+
+    if (supported)
+    {
+        // upload the blocks as is, the levels are packed one after the other.
+        // tools/compress_textures.py premultiplies the formats with alpha as the png loader does
+        _renderFormat = format;
+        _hasPremultipliedAlpha = Texture2D::getPixelFormatInfoMap().at(format).alpha;
+        _dataLen = totalSize;
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+        ssize_t dataOffset = 0;
+        for (int i = 0; i < _numberOfMipmaps; ++i)
+        {
+            memcpy(_data + dataOffset, levels[i], levelSizes[i]);
+            _mipmaps[i].address = _data + dataOffset;
+            _mipmaps[i].len = levelSizes[i];
+            dataOffset += levelSizes[i];
+        }
+    }
+    else
+    {
+        CCLOG("cocos2d: Hardware ETC1 decoder not present. Using software decoder");
+
+        int bytePerPixel = 3;
+        _renderFormat = Texture2D::PixelFormat::RGB888;
+        int width = _width;
+        int height = _height;
+        for (int i = 0; i < _numberOfMipmaps; ++i)
+        {
+            _dataLen += width * height * bytePerPixel;
+            width = MAX(width >> 1, 1);
+            height = MAX(height >> 1, 1);
+        }
+        _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+
+        ssize_t dataOffset = 0;
+        width = _width;
+        height = _height;
+        for (int i = 0; i < _numberOfMipmaps; ++i)
+        {
+            if (levelSizes[i] < etc1_get_encoded_data_size(width, height)
+                || etc1_decode_image(levels[i], _data + dataOffset, width, height, bytePerPixel, width * bytePerPixel) != 0)
+            {
+                free(_data);
+                _data = nullptr;
+                _dataLen = 0;
+                return false;
+            }
+            _mipmaps[i].address = _data + dataOffset;
+            _mipmaps[i].len = width * height * bytePerPixel;
+            dataOffset += _mipmaps[i].len;
+            width = MAX(width >> 1, 1);
+            height = MAX(height >> 1, 1);
+        }
+    }
+
+    return true;
+}
+
 bool Image::initWithPVRData(const unsigned char * data, ssize_t dataLen)
 {
     return initWithPVRv2Data(data, dataLen) || initWithPVRv3Data(data, dataLen);
@@ -2454,6 +2622,48 @@ bool Image::saveImageToJPG(const std::string& filePath)
 #endif // CC_USE_JPEG
 }
 
+// multiplies count RGBA8888 pixels by their alpha in place, as CC_RGB_PREMULTIPLY_ALPHA does
+static void premultiplyPixels(unsigned char* data, size_t count)
+{
+    size_t i = 0;
+#if defined(USE_SSE2)
+    // the rgb channels are multiplied by alpha + 1 and the alpha channel by 256
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    const __m128i alphaFactor = _mm_set_epi16(256, 0, 0, 0, 256, 0, 0, 0);
+    const __m128i one = _mm_set1_epi16(1);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(data + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+        __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+        __m128i alphaLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i alphaHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        alphaLo = _mm_or_si128(_mm_and_si128(_mm_add_epi16(alphaLo, one), rgbMask), alphaFactor);
+        alphaHi = _mm_or_si128(_mm_and_si128(_mm_add_epi16(alphaHi, one), rgbMask), alphaFactor);
+        lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alphaLo), 8);
+        hi = _mm_srli_epi16(_mm_mullo_epi16(hi, alphaHi), 8);
+        _mm_storeu_si128((__m128i*)(data + i * 4), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(USE_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(data + i * 4);
+        uint16x8_t alpha = vaddw_u8(vdupq_n_u16(1), pixels.val[3]);
+        pixels.val[0] = vshrn_n_u16(vmulq_u16(vmovl_u8(pixels.val[0]), alpha), 8);
+        pixels.val[1] = vshrn_n_u16(vmulq_u16(vmovl_u8(pixels.val[1]), alpha), 8);
+        pixels.val[2] = vshrn_n_u16(vmulq_u16(vmovl_u8(pixels.val[2]), alpha), 8);
+        vst4_u8(data + i * 4, pixels);
+    }
+#endif
+    unsigned int* fourBytes = (unsigned int*)data;
+    for (; i < count; i++)
+    {
+        unsigned char* p = data + i * 4;
+        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+    }
+}
+
 void Image::premultipliedAlpha()
 {
 #if CC_ENABLE_PREMULTIPLIED_ALPHA == 0
@@ -2462,11 +2672,20 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
+    size_t count = (size_t)_width * _height;
+    unsigned char* data = _data;
+#if CC_IMAGE_PARALLEL_MIN_PIXELS > 0
+    if (count >= CC_IMAGE_PARALLEL_MIN_PIXELS)
     {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        // blocks of whole rows
+        JobSystem::getInstance()->parallelFor(_height, CC_IMAGE_PARALLEL_MIN_PIXELS / 2 / _width + 1, [this, data](size_t begin, size_t end) {
+            premultiplyPixels(data + begin * _width * 4, (end - begin) * _width);
+        });
+    }
+    else
+#endif
+    {
+        premultiplyPixels(data, count);
     }
     
     _hasPremultipliedAlpha = true;
@@ -2479,5 +2698,314 @@ void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Implement ImageStripDecoder
+//////////////////////////////////////////////////////////////////////////
+
+struct ImageStripDecoder::Decoder
+{
+    Decoder()
+    : premultiply(false)
+#if CC_USE_PNG
+    , png(nullptr)
+    , pngInfo(nullptr)
+#endif
+#if CC_USE_JPEG
+    , jpegCreated(false)
+#endif
+    {}
+
+    ~Decoder()
+    {
+#if CC_USE_PNG
+        if (png)
+        {
+            png_destroy_read_struct(&png, pngInfo ? &pngInfo : nullptr, nullptr);
+        }
+#endif
+#if CC_USE_JPEG
+        // as initWithJpgData, no jpeg_finish_decompress() which may fail on a broken file
+        if (jpegCreated)
+        {
+            jpeg_destroy_decompress(&jpeg);
+        }
+#endif
+    }
+
+    bool premultiply;
+#if CC_USE_PNG
+    png_structp png;
+    png_infop pngInfo;
+    tImageSource pngSource;
+#endif
+#if CC_USE_JPEG
+    struct jpeg_decompress_struct jpeg;
+    struct MyErrorMgr jpegError;
+    bool jpegCreated;
+#endif
+};
+
+ImageStripDecoder::ImageStripDecoder()
+: _decoder(nullptr)
+, _width(0)
+, _height(0)
+, _renderFormat(Texture2D::PixelFormat::NONE)
+, _hasPremultipliedAlpha(false)
+, _bytesPerRow(0)
+, _decodedRows(0)
+{
+}
+
+ImageStripDecoder::~ImageStripDecoder()
+{
+    delete _decoder;
+}
+
+bool ImageStripDecoder::initWithImageFile(const std::string& fullpath)
+{
+    CCASSERT(_decoder == nullptr, "ImageStripDecoder: already initialized");
+
+#if CC_USE_WIC
+    CC_UNUSED_PARAM(fullpath);
+    return false;
+#else
+    _file = FileUtils::getInstance()->mapFile(fullpath);
+    if (!_file)
+    {
+        return false;
+    }
+    const unsigned char* data = _file->getBytes();
+    const ssize_t dataLen = _file->getSize();
+    _decoder = new (std::nothrow) Decoder();
+    if (_decoder == nullptr)
+    {
+        return false;
+    }
+
+#if CC_USE_PNG
+    if (dataLen >= 8 && png_sig_cmp((png_const_bytep)data, 0, 8) == 0)
+    {
+        png_structp& png = _decoder->png;
+        png_infop& info = _decoder->pngInfo;
+        png = png_create_read_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+        if (png == nullptr || (info = png_create_info_struct(png)) == nullptr)
+        {
+            return false;
+        }
+        if (setjmp(png_jmpbuf(png)))
+        {
+            return false;
+        }
+
+        _decoder->pngSource.data = data;
+        _decoder->pngSource.size = dataLen;
+        _decoder->pngSource.offset = 0;
+        png_set_read_fn(png, &_decoder->pngSource, pngReadCallback);
+        png_read_info(png, info);
+
+        // the passes of interlaced images cover the whole image, they can't be decoded by rows
+        if (png_get_interlace_type(png, info) != PNG_INTERLACE_NONE)
+        {
+            return false;
+        }
+
+        // the same transformations as Image::initWithPngData
+        png_byte bitDepth = png_get_bit_depth(png, info);
+        png_uint_32 colorType = png_get_color_type(png, info);
+        if (colorType == PNG_COLOR_TYPE_PALETTE)
+        {
+            png_set_palette_to_rgb(png);
+        }
+        if (colorType == PNG_COLOR_TYPE_GRAY && bitDepth < 8)
+        {
+            bitDepth = 8;
+            png_set_expand_gray_1_2_4_to_8(png);
+        }
+        if (png_get_valid(png, info, PNG_INFO_tRNS))
+        {
+            png_set_tRNS_to_alpha(png);
+        }
+        if (bitDepth == 16)
+        {
+            png_set_strip_16(png);
+        }
+        if (bitDepth < 8)
+        {
+            png_set_packing(png);
+        }
+        png_read_update_info(png, info);
+
+        switch (png_get_color_type(png, info))
+        {
+        case PNG_COLOR_TYPE_GRAY:
+            _renderFormat = Texture2D::PixelFormat::I8;
+            break;
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            _renderFormat = Texture2D::PixelFormat::AI88;
+            break;
+        case PNG_COLOR_TYPE_RGB:
+            _renderFormat = Texture2D::PixelFormat::RGB888;
+            break;
+        case PNG_COLOR_TYPE_RGB_ALPHA:
+            _renderFormat = Texture2D::PixelFormat::RGBA8888;
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+            _decoder->premultiply = Image::PNG_PREMULTIPLIED_ALPHA_ENABLED;
+            _hasPremultipliedAlpha = true;
+#endif
+            break;
+        default:
+            return false;
+        }
+
+        _width = png_get_image_width(png, info);
+        _height = png_get_image_height(png, info);
+        _bytesPerRow = png_get_rowbytes(png, info);
+        return _width > 0 && _height > 0;
+    }
+#endif // CC_USE_PNG
+
+#if CC_USE_JPEG && !defined(CC_TARGET_QT5)
+    if (dataLen > 4 && data[0] == 0xFF && data[1] == 0xD8)
+    {
+        struct jpeg_decompress_struct& jpeg = _decoder->jpeg;
+        jpeg.err = jpeg_std_error(&_decoder->jpegError.pub);
+        _decoder->jpegError.pub.error_exit = myErrorExit;
+        if (setjmp(_decoder->jpegError.setjmp_buffer))
+        {
+            return false;
+        }
+
+        jpeg_create_decompress(&jpeg);
+        _decoder->jpegCreated = true;
+        jpeg_mem_src(&jpeg, const_cast<unsigned char*>(data), dataLen);
+        jpeg_read_header(&jpeg, TRUE);
+
+        // the same output as Image::initWithJpgData
+        if (jpeg.jpeg_color_space == JCS_GRAYSCALE)
+        {
+            _renderFormat = Texture2D::PixelFormat::I8;
+        }
+        else
+        {
+            jpeg.out_color_space = JCS_RGB;
+            _renderFormat = Texture2D::PixelFormat::RGB888;
+        }
+        jpeg_start_decompress(&jpeg);
+
+        _width = jpeg.output_width;
+        _height = jpeg.output_height;
+        _bytesPerRow = jpeg.output_width * jpeg.output_components;
+        return _width > 0 && _height > 0;
+    }
+#endif // CC_USE_JPEG
+
+    return false;
+#endif // CC_USE_WIC
+}
+
+int ImageStripDecoder::decodeRows(unsigned char* rows, int rowCount)
+{
+    CCASSERT(_decoder != nullptr && _width > 0, "ImageStripDecoder: not initialized");
+
+    rowCount = std::min(rowCount, _height - _decodedRows);
+    if (rowCount <= 0)
+    {
+        return 0;
+    }
+
+#if CC_USE_PNG
+    if (_decoder->png)
+    {
+        if (setjmp(png_jmpbuf(_decoder->png)))
+        {
+            return -1;
+        }
+        for (int i = 0; i < rowCount; ++i)
+        {
+            png_read_row(_decoder->png, rows + i * _bytesPerRow, nullptr);
+        }
+        if (_decoder->premultiply)
+        {
+            premultiplyPixels(rows, (size_t)rowCount * _width);
+        }
+        _decodedRows += rowCount;
+        return rowCount;
+    }
+#endif // CC_USE_PNG
+
+#if CC_USE_JPEG
+    if (_decoder->jpegCreated)
+    {
+        if (setjmp(_decoder->jpegError.setjmp_buffer))
+        {
+            return -1;
+        }
+        JSAMPROW rowPointer[1];
+        for (int i = 0; i < rowCount; ++i)
+        {
+            rowPointer[0] = rows + i * _bytesPerRow;
+            jpeg_read_scanlines(&_decoder->jpeg, rowPointer, 1);
+        }
+        _decodedRows += rowCount;
+        return rowCount;
+    }
+#endif // CC_USE_JPEG
+
+    CC_UNUSED_PARAM(rows);
+    return -1;
+}
+
+bool ImageStripDecoder::decodePreview(std::vector<unsigned char>& data, int& width, int& height)
+{
+#if CC_USE_JPEG
+    if (_decoder == nullptr || !_decoder->jpegCreated)
+    {
+        return false;
+    }
+
+    // a second decompressor, libjpeg only computes the DC coefficients at 1/8
+    struct jpeg_decompress_struct jpeg;
+    struct MyErrorMgr jpegError;
+    jpeg.err = jpeg_std_error(&jpegError.pub);
+    jpegError.pub.error_exit = myErrorExit;
+    if (setjmp(jpegError.setjmp_buffer))
+    {
+        jpeg_destroy_decompress(&jpeg);
+        data.clear();
+        return false;
+    }
+
+    jpeg_create_decompress(&jpeg);
+    jpeg_mem_src(&jpeg, const_cast<unsigned char*>(_file->getBytes()), _file->getSize());
+    jpeg_read_header(&jpeg, TRUE);
+    if (_renderFormat == Texture2D::PixelFormat::RGB888)
+    {
+        jpeg.out_color_space = JCS_RGB;
+    }
+    jpeg.scale_num = 1;
+    jpeg.scale_denom = 8;
+    jpeg.dct_method = JDCT_IFAST;
+    jpeg.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&jpeg);
+
+    width = jpeg.output_width;
+    height = jpeg.output_height;
+    const size_t bytesPerRow = jpeg.output_width * jpeg.output_components;
+    data.resize(bytesPerRow * height);
+    while (jpeg.output_scanline < jpeg.output_height)
+    {
+        JSAMPROW rowPointer[1] = { data.data() + jpeg.output_scanline * bytesPerRow };
+        jpeg_read_scanlines(&jpeg, rowPointer, 1);
+    }
+    jpeg_destroy_decompress(&jpeg);
+    return true;
+#else
+    CC_UNUSED_PARAM(data);
+    CC_UNUSED_PARAM(width);
+    CC_UNUSED_PARAM(height);
+    return false;
+#endif // CC_USE_JPEG
+}
+
 NS_CC_END
 
@@ -28,6 +28,9 @@ THE SOFTWARE.
 #define __CC_IMAGE_H__
 /// @cond DO_NOT_SHOW
 
+#include <memory>
+#include <vector>
+
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
 
@@ -64,6 +67,7 @@ class CC_DLL Image : public Ref
 {
 public:
     friend class TextureCache;
+    friend class ImageStripDecoder;
     /**
      * @js ctor
      */
@@ -176,6 +180,7 @@ protected:
     bool initWithETCData(const unsigned char * data, ssize_t dataLen);
     bool initWithS3TCData(const unsigned char * data, ssize_t dataLen);
     bool initWithATITCData(const unsigned char *data, ssize_t dataLen);
+    bool initWithKTXData(const unsigned char *data, ssize_t dataLen);
     typedef struct sImageTGA tImageTGA;
     bool initWithTGAData(tImageTGA* tgaData);
 
@@ -233,6 +238,58 @@ protected:
     bool isATITC(const unsigned char *data, ssize_t dataLen);
 };
 
+class MappedFile;
+
+/**
+ @brief Decodes a png or jpeg file a strip of rows at a time, so that a large image never has to be in memory whole.
+ The file is mapped, libpng and libjpeg only keep their row buffers (and the coefficients of progressive jpegs).
+ Interlaced pngs and the other formats can't be decoded by rows, initWithImageFile fails for them.
+ The rows are decoded in the format Image would use: RGBA8888 (premultiplied as Image does), RGB888, AI88 or I8.
+ The decoder isn't thread safe but can be used by different threads one after the other.
+ */
+class CC_DLL ImageStripDecoder
+{
+public:
+    ImageStripDecoder();
+    ~ImageStripDecoder();
+
+    /** Maps the file and reads the header of the image, returns false if it can't be decoded by rows. */
+    bool initWithImageFile(const std::string& fullpath);
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+    Texture2D::PixelFormat getRenderFormat() const { return _renderFormat; }
+    bool hasPremultipliedAlpha() const { return _hasPremultipliedAlpha; }
+    /** The size of a decoded row, in bytes. */
+    size_t getBytesPerRow() const { return _bytesPerRow; }
+    /** The number of rows decoded so far, from the top. */
+    int getDecodedRows() const { return _decodedRows; }
+
+    /** Decodes the next rowCount rows to rows, which holds rowCount * getBytesPerRow() bytes.
+     * @return The number of rows decoded, less than rowCount at the bottom of the image, -1 if the file is corrupted.
+     */
+    int decodeRows(unsigned char* rows, int rowCount);
+
+    /** Decodes the whole image 8 times smaller, in the render format. Only jpegs can be decoded at a lower
+     * resolution, which costs a fraction of a full decode, returns false for pngs.
+     */
+    bool decodePreview(std::vector<unsigned char>& data, int& width, int& height);
+
+protected:
+    struct Decoder;
+
+    std::shared_ptr<const MappedFile> _file;
+    Decoder* _decoder;
+    int _width;
+    int _height;
+    Texture2D::PixelFormat _renderFormat;
+    bool _hasPremultipliedAlpha;
+    size_t _bytesPerRow;
+    int _decodedRows;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(ImageStripDecoder);
+};
+
 // end of platform group
 /// @}
 
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
 #include "base/ZipUtils.h"
+#include "base/CCPackFile.h"
 
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -352,6 +353,13 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
 
     string fullPath = fullPathForFilename(filename);
 
+    string entryName;
+    if (auto pack = findPack(fullPath, entryName))
+    {
+        auto entry = pack->findEntry(entryName);
+        return entry ? pack->getContents(entry, buffer) : FileUtils::Status::NotExists;
+    }
+
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
 
@@ -396,6 +404,44 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
     return FileUtils::Status::OK;
 }
 
+std::shared_ptr<const MappedFile> FileUtilsAndroid::mapFile(const std::string& filename) const
+{
+    static const std::string apkprefix("assets/");
+    if (filename.empty())
+        return nullptr;
+
+    string fullPath = fullPathForFilename(filename);
+
+    string entryName;
+    if (!fullPath.empty() && findPack(fullPath, entryName))
+        return FileUtils::mapFile(fullPath);
+
+    if (fullPath.empty() || fullPath[0] == '/' || obbfile || nullptr == assetmanager)
+        return FileUtils::mapFile(fullPath.empty() ? filename : fullPath);
+
+    string relativePath = fullPath;
+    if (0 == fullPath.find(apkprefix)) {
+        relativePath = fullPath.substr(apkprefix.size());
+    }
+
+    AAsset* asset = AAssetManager_open(assetmanager, relativePath.data(), AASSET_MODE_BUFFER);
+    if (nullptr == asset) {
+        LOGD("asset is nullptr");
+        return nullptr;
+    }
+
+    // uncompressed assets are mapped from the apk, compressed ones are inflated once by the asset manager
+    const void* bytes = AAsset_getBuffer(asset);
+    if (nullptr == bytes) {
+        AAsset_close(asset);
+        return FileUtils::mapFile(fullPath);
+    }
+
+    return std::make_shared<const MappedFile>((const unsigned char*)bytes, (ssize_t)AAsset_getLength(asset), [asset]() {
+        AAsset_close(asset);
+    });
+}
+
 string FileUtilsAndroid::getWritablePath() const
 {
     // Fix for Nexus 10 (Android 4.2 multi-user environment)
@@ -36,6 +36,8 @@ THE SOFTWARE.
 #define glBindVertexArray           glBindVertexArrayOES
 #define glMapBuffer                 glMapBufferOES
 #define glUnmapBuffer               glUnmapBufferOES
+#define glDrawArraysInstanced       glDrawArraysInstancedEXT
+#define glVertexAttribDivisor       glVertexAttribDivisorEXT
 
 #define GL_DEPTH24_STENCIL8         GL_DEPTH24_STENCIL8_OES
 #define GL_WRITE_ONLY               GL_WRITE_ONLY_OES
@@ -61,10 +63,14 @@ typedef char GLchar;
 extern PFNGLGENVERTEXARRAYSOESPROC glGenVertexArraysOESEXT;
 extern PFNGLBINDVERTEXARRAYOESPROC glBindVertexArrayOESEXT;
 extern PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOESEXT;
+extern PFNGLDRAWARRAYSINSTANCEDEXTPROC glDrawArraysInstancedEXTEXT;
+extern PFNGLVERTEXATTRIBDIVISOREXTPROC glVertexAttribDivisorEXTEXT;
 
 #define glGenVertexArraysOES glGenVertexArraysOESEXT
 #define glBindVertexArrayOES glBindVertexArrayOESEXT
 #define glDeleteVertexArraysOES glDeleteVertexArraysOESEXT
+#define glDrawArraysInstancedEXT glDrawArraysInstancedEXTEXT
+#define glVertexAttribDivisorEXT glVertexAttribDivisorEXTEXT
 
 
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
@@ -40,6 +40,8 @@ THE SOFTWARE.
 #define glDeleteVertexArrays            glDeleteVertexArraysAPPLE
 #define glGenVertexArrays               glGenVertexArraysAPPLE
 #define glBindVertexArray               glBindVertexArrayAPPLE
+#define glDrawArraysInstanced           glDrawArraysInstancedARB
+#define glVertexAttribDivisor           glVertexAttribDivisorARB
 #define glClearDepthf                   glClearDepth
 #define glDepthRangef                   glDepthRange
 #define glReleaseShaderCompiler(xxx)
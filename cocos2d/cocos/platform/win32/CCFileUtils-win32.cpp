@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "platform/win32/CCUtils-win32.h"
 #include "platform/CCCommon.h"
 #include "tinydir/tinydir.h"
+#include "base/CCPackFile.h"
 #include <Shlobj.h>
 #include <cstdlib>
 #include <regex>
@@ -180,6 +181,13 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    std::string entryName;
+    if (auto pack = findPack(fullPath, entryName))
+    {
+        auto entry = pack->findEntry(entryName);
+        return entry ? pack->getContents(entry, buffer) : FileUtils::Status::NotExists;
+    }
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
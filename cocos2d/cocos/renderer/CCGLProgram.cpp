@@ -81,6 +81,7 @@ const char* GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP = "#Shade
 
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR = "ShaderPositionTextureColor";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP = "ShaderPositionTextureColor_noMVP";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED = "ShaderPositionTextureColor_instanced";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST = "ShaderPositionTextureColorAlphaTest";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV = "ShaderPositionTextureColorAlphaTest_NoMV";
 const char* GLProgram::SHADER_NAME_POSITION_COLOR = "ShaderPositionColor";
@@ -144,6 +145,11 @@ const char* GLProgram::ATTRIBUTE_NAME_BLEND_WEIGHT = "a_blendWeight";
 const char* GLProgram::ATTRIBUTE_NAME_BLEND_INDEX = "a_blendIndex";
 const char* GLProgram::ATTRIBUTE_NAME_TANGENT = "a_tangent";
 const char* GLProgram::ATTRIBUTE_NAME_BINORMAL = "a_binormal";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_ORIGIN = "a_instanceOrigin";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_AXES = "a_instanceAxes";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_TEX_COORD_AXES = "a_instanceTexCoordAxes";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS0 = "a_instanceParams0";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS1 = "a_instanceParams1";
 
 
 
@@ -218,6 +224,7 @@ GLProgram::GLProgram()
 : _program(0)
 , _vertShader(0)
 , _fragShader(0)
+, _lastUniformState(nullptr)
 , _flags()
 {
     _director = Director::getInstance();
@@ -332,6 +339,12 @@ void GLProgram::bindPredefinedVertexAttribs()
         {GLProgram::ATTRIBUTE_NAME_TEX_COORD2, GLProgram::VERTEX_ATTRIB_TEX_COORD2},
         {GLProgram::ATTRIBUTE_NAME_TEX_COORD3, GLProgram::VERTEX_ATTRIB_TEX_COORD3},
         {GLProgram::ATTRIBUTE_NAME_NORMAL, GLProgram::VERTEX_ATTRIB_NORMAL},
+        // aliases of the locations above, a program never uses both names of a location
+        {GLProgram::ATTRIBUTE_NAME_INSTANCE_ORIGIN, GLProgram::VERTEX_ATTRIB_INSTANCE_ORIGIN},
+        {GLProgram::ATTRIBUTE_NAME_INSTANCE_AXES, GLProgram::VERTEX_ATTRIB_INSTANCE_AXES},
+        {GLProgram::ATTRIBUTE_NAME_INSTANCE_TEX_COORD_AXES, GLProgram::VERTEX_ATTRIB_INSTANCE_TEX_COORD_AXES},
+        {GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS0, GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS0},
+        {GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS1, GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS1},
     };
 
     const int size = sizeof(attribute_locations) / sizeof(attribute_locations[0]);
@@ -722,6 +735,10 @@ bool GLProgram::updateUniformLocation(GLint location, const GLvoid* data, unsign
         }
     }
 
+    // a value written outside of GLProgramState::applyUniforms() may overwrite one of its uniforms
+    if (updated)
+        _lastUniformState = nullptr;
+
     return updated;
 }
 
@@ -926,6 +943,8 @@ void GLProgram::setUniformsForBuiltins()
 
 void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 {
+    // built-in uniforms are not part of any GLProgramState, keep its user uniforms valid
+    const GLProgramState* lastUniformState = _lastUniformState;
     const auto& matrixP = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
 
     if (_flags.usesP)
@@ -986,6 +1005,8 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 
     if (_flags.usesRandom)
         setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_RANDOM01], CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1());
+
+    _lastUniformState = lastUniformState;
 }
 
 void GLProgram::reset()
@@ -1024,6 +1045,8 @@ inline void GLProgram::clearHashUniforms()
     }
 
     _hashForUniforms.clear();
+    // the cached values are gone, every GLProgramState has to upload its uniforms again
+    _lastUniformState = nullptr;
 }
 
 NS_CC_END
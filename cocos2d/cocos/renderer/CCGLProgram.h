@@ -48,6 +48,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class GLProgram;
+class GLProgramState;
 class Director;
 //FIXME: these two typedefs would be deprecated or removed in version 4.0.
 typedef void (*GLInfoFunction)(GLuint program, GLenum pname, GLint* params);
@@ -119,6 +120,18 @@ public:
 
         // backward compatibility
         VERTEX_ATTRIB_TEX_COORDS = VERTEX_ATTRIB_TEX_COORD,
+
+        // per instance attributes of instanced quads, they reuse the indices a quad doesn't need
+        // so they still fit in the 8 vertex attributes guaranteed by OpenGL ES 2.0
+        /**Origin of the quad (xy) and its texture coordinate (zw).*/
+        VERTEX_ATTRIB_INSTANCE_ORIGIN = VERTEX_ATTRIB_TEX_COORD1,
+        /**Edges of the quad from the origin to the right (xy) and to the top (zw).*/
+        VERTEX_ATTRIB_INSTANCE_AXES = VERTEX_ATTRIB_TEX_COORD2,
+        /**Texture coordinate edges of the quad, matching the position edges.*/
+        VERTEX_ATTRIB_INSTANCE_TEX_COORD_AXES = VERTEX_ATTRIB_TEX_COORD3,
+        /**Free parameters for custom instanced shaders.*/
+        VERTEX_ATTRIB_INSTANCE_PARAMS0 = VERTEX_ATTRIB_NORMAL,
+        VERTEX_ATTRIB_INSTANCE_PARAMS1 = VERTEX_ATTRIB_BLEND_WEIGHT,
     };
 
     /**Preallocated uniform handle.*/
@@ -186,6 +199,8 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, but without multiply vertex by MVP matrix.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP;
+    /**Built in shader for 2d. Same as SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, but the quad is expanded from the per instance attributes of an InstancedQuadCommand.*/
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED;
     /**Built in shader for 2d. Support Position, Texture vertex attribute, but include alpha test.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, include alpha test and without multiply vertex by MVP matrix.*/
@@ -348,6 +363,13 @@ public:
     static const char* ATTRIBUTE_NAME_TANGENT;
     /**Attribute blend binormal.*/
     static const char* ATTRIBUTE_NAME_BINORMAL;
+    /**@{ Per instance attributes of instanced quads.*/
+    static const char* ATTRIBUTE_NAME_INSTANCE_ORIGIN;
+    static const char* ATTRIBUTE_NAME_INSTANCE_AXES;
+    static const char* ATTRIBUTE_NAME_INSTANCE_TEX_COORD_AXES;
+    static const char* ATTRIBUTE_NAME_INSTANCE_PARAMS0;
+    static const char* ATTRIBUTE_NAME_INSTANCE_PARAMS1;
+    /**@}*/
     /**
     end of Built Attribute names
     @}
@@ -590,6 +612,9 @@ protected:
     std::unordered_map<GLint, std::pair<GLvoid*, unsigned int>> _hashForUniforms;
     //cached director pointer for calling
     Director* _director;
+    /**GLProgramState whose user uniforms were applied last, reset when any other uniform value changes.
+    Weak ref, only used for comparison.*/
+    const GLProgramState* _lastUniformState;
 
     /*needed uniforms*/
     UniformFlags _flags;
@@ -29,6 +29,8 @@ THE SOFTWARE.
 
 #include "renderer/CCGLProgramState.h"
 
+#include <algorithm>
+
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramStateCache.h"
 #include "renderer/CCGLProgramCache.h"
@@ -445,6 +447,10 @@ GLProgramState::~GLProgramState()
     Director::getInstance()->getEventDispatcher()->removeEventListener(_backToForegroundlistener);
 #endif
 
+    // a new state allocated at the same address must not be taken as the last one applied
+    if (_glprogram && _glprogram->_lastUniformState == this)
+        _glprogram->_lastUniformState = nullptr;
+
     // _uniforms must be cleared before releasing _glprogram since
     // the destructor of UniformValue will call a weak pointer
     // which points to the member variable in GLProgram.
@@ -467,9 +473,12 @@ GLProgramState* GLProgramState::clone() const
     glprogramstate->_vertexAttribsFlags = this->_vertexAttribsFlags;
 
     // copy uniforms
-    glprogramstate->_uniformsByName = this->_uniformsByName;
     glprogramstate->_uniforms = this->_uniforms;
+    glprogramstate->_uniformsByName = this->_uniformsByName;
+    glprogramstate->_uniformsByLocation = this->_uniformsByLocation;
+    glprogramstate->_uniformRemovedBits = this->_uniformRemovedBits;
     glprogramstate->_uniformAttributeValueDirty = this->_uniformAttributeValueDirty;
+    glprogramstate->markAllUniformsDirty();
 
     // copy textures
     glprogramstate->_textureUnitIndex = this->_textureUnitIndex;
@@ -498,11 +507,23 @@ bool GLProgramState::init(GLProgram* glprogram)
         _attributes[attrib.first] = value;
     }
 
+    _uniforms.reserve(_glprogram->_userUniforms.size());
     for(auto &uniform : _glprogram->_userUniforms) {
-        UniformValue value(&uniform.second, _glprogram);
-        _uniforms[uniform.second.location] = std::move(value);
-        _uniformsByName[uniform.first] = uniform.second.location;
+        _uniforms.push_back(UniformValue(&uniform.second, _glprogram));
+    }
+
+    // sorted by name so that a UniformHandle is the same for every state of the program
+    std::sort(_uniforms.begin(), _uniforms.end(), [](const UniformValue& a, const UniformValue& b) {
+        return a._uniform->name < b._uniform->name;
+    });
+
+    for (int i = 0, count = (int)_uniforms.size(); i < count; ++i)
+    {
+        _uniformsByName[_uniforms[i]._uniform->name] = i;
+        _uniformsByLocation[_uniforms[i]._uniform->location] = i;
     }
+    _uniformRemovedBits.assign((_uniforms.size() + 31) / 32, 0);
+    markAllUniformsDirty();
 
     return true;
 }
@@ -513,8 +534,14 @@ void GLProgramState::resetGLProgram()
     // the destructor of UniformValue will call a weak pointer
     // which points to the member variable in GLProgram.
     _uniforms.clear();
+    _uniformsByName.clear();
+    _uniformsByLocation.clear();
+    _uniformDirtyBits.clear();
+    _uniformRemovedBits.clear();
     _attributes.clear();
 
+    if (_glprogram && _glprogram->_lastUniformState == this)
+        _glprogram->_lastUniformState = nullptr;
     CC_SAFE_RELEASE(_glprogram);
     _glprogram = nullptr;
     // first texture is GL_TEXTURE1
@@ -536,17 +563,39 @@ void GLProgramState::updateUniformsAndAttributes()
     CCASSERT(_glprogram, "invalid glprogram");
     if(_uniformAttributeValueDirty)
     {
-        for(auto& uniformLocation : _uniformsByName)
+        // the program may have been relinked, locations can change
+        _uniformsByLocation.clear();
+        for (auto it = _uniformsByName.begin(); it != _uniformsByName.end();)
         {
-            _uniforms[uniformLocation.second]._uniform = _glprogram->getUniform(uniformLocation.first);
+            const int index = it->second;
+            Uniform* uniform = _glprogram->getUniform(it->first);
+            if (uniform == nullptr)
+            {
+                // not in the program anymore: the value keeps its slot so that the handles stay valid, but it isn't
+                // applied and can't be looked up by name anymore
+                _uniformRemovedBits[index >> 5] |= 1u << (index & 31);
+                it = _uniformsByName.erase(it);
+                continue;
+            }
+            _uniforms[index]._uniform = uniform;
+            _uniformsByLocation[uniform->location] = index;
+            ++it;
         }
+        markAllUniformsDirty();
         
         _vertexAttribsFlags = 0;
-        for(auto& attributeValue : _attributes)
+        for (auto it = _attributes.begin(); it != _attributes.end();)
         {
-            attributeValue.second._vertexAttrib = _glprogram->getVertexAttrib(attributeValue.first);
-            if(attributeValue.second._enabled)
-                _vertexAttribsFlags |= 1 << attributeValue.second._vertexAttrib->index;
+            VertexAttrib* attrib = _glprogram->getVertexAttrib(it->first);
+            if (attrib == nullptr)
+            {
+                it = _attributes.erase(it);
+                continue;
+            }
+            it->second._vertexAttrib = attrib;
+            if (it->second._enabled)
+                _vertexAttribsFlags |= 1 << attrib->index;
+            ++it;
         }
         
         _uniformAttributeValueDirty = false;
@@ -583,9 +632,32 @@ void GLProgramState::applyUniforms()
 {
     // set uniforms
     updateUniformsAndAttributes();
-    for(auto& uniform : _uniforms) {
-        uniform.second.apply();
+
+    // the program keeps the uniform values, only re-upload everything if another state used it
+    const bool applyAll = (_glprogram->_lastUniformState != this);
+    for (int i = 0, count = (int)_uniforms.size(); i < count; ++i)
+    {
+        auto& uniform = _uniforms[i];
+        if (_uniformRemovedBits[i >> 5] & (1u << (i & 31)))
+            continue;
+        // textures, pointers and callbacks may change without going through a setter
+        if (applyAll
+            || (_uniformDirtyBits[i >> 5] & (1u << (i & 31)))
+            || uniform._type != UniformValue::Type::VALUE
+            || uniform._uniform->type == GL_SAMPLER_2D
+            || uniform._uniform->type == GL_SAMPLER_CUBE)
+        {
+            uniform.apply();
+        }
     }
+
+    std::fill(_uniformDirtyBits.begin(), _uniformDirtyBits.end(), 0);
+    _glprogram->_lastUniformState = this;
+}
+
+void GLProgramState::markAllUniformsDirty()
+{
+    _uniformDirtyBits.assign((_uniforms.size() + 31) / 32, 0xffffffff);
 }
 
 void GLProgramState::setGLProgram(GLProgram *glprogram)
@@ -611,21 +683,39 @@ ssize_t GLProgramState::getVertexAttribCount() const
 UniformValue* GLProgramState::getUniformValue(GLint uniformLocation)
 {
     updateUniformsAndAttributes();
-    const auto itr = _uniforms.find(uniformLocation);
-    if (itr != _uniforms.end())
-        return &itr->second;
+    const auto itr = _uniformsByLocation.find(uniformLocation);
+    if (itr != _uniformsByLocation.end())
+        return getUniformValue(UniformHandle(itr->second));
     return nullptr;
 }
 
 UniformValue* GLProgramState::getUniformValue(const std::string& name)
 {
-    updateUniformsAndAttributes();
     const auto itr = _uniformsByName.find(name);
     if (itr != _uniformsByName.end())
-        return &_uniforms[itr->second];
+        return getUniformValue(UniformHandle(itr->second));
     return nullptr;
 }
 
+UniformValue* GLProgramState::getUniformValue(UniformHandle handle)
+{
+    updateUniformsAndAttributes();
+    if (handle.index < 0 || handle.index >= (int)_uniforms.size()
+        || (_uniformRemovedBits[handle.index >> 5] & (1u << (handle.index & 31))))
+        return nullptr;
+
+    _uniformDirtyBits[handle.index >> 5] |= 1u << (handle.index & 31);
+    return &_uniforms[handle.index];
+}
+
+UniformHandle GLProgramState::getUniformHandle(const std::string& uniformName) const
+{
+    const auto itr = _uniformsByName.find(uniformName);
+    if (itr != _uniformsByName.end())
+        return UniformHandle(itr->second);
+    return UniformHandle();
+}
+
 VertexAttribValue* GLProgramState::getVertexAttribValue(const std::string& name)
 {
     updateUniformsAndAttributes();
@@ -864,28 +954,137 @@ void GLProgramState::setUniformMat4(GLint uniformLocation, const Mat4& value)
         CCLOG("cocos2d: warning: Uniform at location not found: %i", uniformLocation);
 }
 
+// Uniform Setters by handle
+
+void GLProgramState::setUniformCallback(UniformHandle handle, const std::function<void(GLProgram*, Uniform*)> &callback)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setCallback(callback);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformFloat(UniformHandle handle, float value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setFloat(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformInt(UniformHandle handle, int value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setInt(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformFloatv(UniformHandle handle, ssize_t size, const float* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setFloatv(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec2(UniformHandle handle, const Vec2& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec2(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec2v(UniformHandle handle, ssize_t size, const Vec2* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec2v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec3(UniformHandle handle, const Vec3& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec3(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec3v(UniformHandle handle, ssize_t size, const Vec3* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec3v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec4(UniformHandle handle, const Vec4& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformVec4v(UniformHandle handle, ssize_t size, const Vec4* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec4v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
+void GLProgramState::setUniformMat4(UniformHandle handle, const Mat4& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setMat4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
+}
+
 // Textures
 
+void GLProgramState::bindUniformTexture(UniformValue* v, Texture2D* texture, GLuint textureId)
+{
+    GLuint textureUnit;
+    const auto itr = _boundTextureUnits.find(v->_uniform->name);
+    if (itr != _boundTextureUnits.end())
+    {
+        textureUnit = itr->second;
+    }
+    else
+    {
+        textureUnit = _textureUnitIndex;
+        _boundTextureUnits[v->_uniform->name] = _textureUnitIndex++;
+    }
+
+    if (texture)
+        v->setTexture(texture, textureUnit);
+    else
+        v->setTexture(textureId, textureUnit);
+}
+
 void GLProgramState::setUniformTexture(const std::string& uniformName, Texture2D *texture)
 {
     CCASSERT(texture, "Invalid texture");
     auto v = getUniformValue(uniformName);
     if (v)
-    {
-        if (_boundTextureUnits.find(uniformName) != _boundTextureUnits.end())
-        {
-            v->setTexture(texture, _boundTextureUnits[uniformName]);
-        }
-        else
-        {
-            v->setTexture(texture, _textureUnitIndex);
-            _boundTextureUnits[uniformName] = _textureUnitIndex++;
-        }
-    }
+        bindUniformTexture(v, texture, 0);
     else
-    {
         CCLOG("cocos2d: warning: Uniform not found: %s", uniformName.c_str());
-    }
 }
 
 void GLProgramState::setUniformTexture(GLint uniformLocation, Texture2D *texture)
@@ -893,63 +1092,37 @@ void GLProgramState::setUniformTexture(GLint uniformLocation, Texture2D *texture
     CCASSERT(texture, "Invalid texture");
     auto v = getUniformValue(uniformLocation);
     if (v)
-    {
-        if (_boundTextureUnits.find(v->_uniform->name) != _boundTextureUnits.end())
-        {
-            v->setTexture(texture, _boundTextureUnits[v->_uniform->name]);
-        }
-        else
-        {
-            v->setTexture(texture, _textureUnitIndex);
-            _boundTextureUnits[v->_uniform->name] = _textureUnitIndex++;
-        }
-    }
+        bindUniformTexture(v, texture, 0);
     else
-    {
         CCLOG("cocos2d: warning: Uniform at location not found: %i", uniformLocation);
-    }
+}
+
+void GLProgramState::setUniformTexture(UniformHandle handle, Texture2D *texture)
+{
+    CCASSERT(texture, "Invalid texture");
+    auto v = getUniformValue(handle);
+    if (v)
+        bindUniformTexture(v, texture, 0);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %i", handle.index);
 }
 
 void GLProgramState::setUniformTexture(const std::string& uniformName, GLuint textureId)
 {
     auto v = getUniformValue(uniformName);
     if (v)
-    {
-        if (_boundTextureUnits.find(uniformName) != _boundTextureUnits.end())
-        {
-            v->setTexture(textureId, _boundTextureUnits[uniformName]);
-        }
-        else
-        {
-            v->setTexture(textureId, _textureUnitIndex);
-            _boundTextureUnits[uniformName] = _textureUnitIndex++;
-        }
-    }
+        bindUniformTexture(v, nullptr, textureId);
     else
-    {
         CCLOG("cocos2d: warning: Uniform not found: %s", uniformName.c_str());
-    }
 }
 
 void GLProgramState::setUniformTexture(GLint uniformLocation, GLuint textureId)
 {
     auto v = getUniformValue(uniformLocation);
     if (v)
-    {
-        if (_boundTextureUnits.find(v->_uniform->name) != _boundTextureUnits.end())
-        {
-            v->setTexture(textureId, _boundTextureUnits[v->_uniform->name]);
-        }
-        else
-        {
-            v->setTexture(textureId, _textureUnitIndex);
-            _boundTextureUnits[v->_uniform->name] = _textureUnitIndex++;
-        }
-    }
+        bindUniformTexture(v, nullptr, textureId);
     else
-    {
         CCLOG("cocos2d: warning: Uniform at location not found: %i", uniformLocation);
-    }
 }
 
 // Auto bindings
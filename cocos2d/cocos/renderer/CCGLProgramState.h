@@ -29,6 +29,7 @@ THE SOFTWARE.
 #define __CCGLPROGRAMSTATE_H__
 
 #include <unordered_map>
+#include <vector>
 
 #include "base/ccTypes.h"
 #include "base/CCVector.h"
@@ -247,6 +248,23 @@ protected:
 };
 
 
+/**
+ * Handle of a user defined uniform in a GLProgramState.
+ *
+ * Resolve it once with GLProgramState::getUniformHandle() and pass it to the handle based
+ * setters to avoid hashing the uniform name on every call. Uniforms are indexed in name order,
+ * so a handle stays valid for every GLProgramState of the same GLProgram.
+ */
+struct CC_DLL UniformHandle
+{
+    UniformHandle() : index(-1) {}
+    explicit UniformHandle(int i) : index(i) {}
+
+    bool isValid() const { return index >= 0; }
+
+    int index;
+};
+
 /**
  GLProgramState holds the 'state' (uniforms and attributes) of the GLProgram.
  A GLProgram can be used by thousands of Nodes, but if different uniform values 
@@ -292,6 +310,9 @@ public:
     void applyAttributes(bool applyAttribFlags = true);
     /**
      Apply user defined uniforms.
+     Values set by value are only uploaded when they changed since the last call, unless another
+     GLProgramState or a direct GLProgram setter changed a uniform of the GLProgram in between.
+     Textures, pointers and callbacks are applied every time.
      */
     void applyUniforms();
     
@@ -361,6 +382,30 @@ public:
     CC_DEPRECATED_ATTRIBUTE void setUniformTexture(GLint uniformLocation, GLuint textureId);
     /**@}*/
 
+    /**
+     Resolves the handle of a user defined uniform, to be used with the handle based setters.
+     @param uniformName The uniform name in the shader.
+     @return The uniform handle, or an invalid handle if the uniform does not exist.
+     */
+    UniformHandle getUniformHandle(const std::string& uniformName) const;
+
+    /** @{
+     Setting user defined uniforms by handle, see getUniformHandle().
+     */
+    void setUniformInt(UniformHandle handle, int value);
+    void setUniformFloat(UniformHandle handle, float value);
+    void setUniformFloatv(UniformHandle handle, ssize_t size, const float* pointer);
+    void setUniformVec2(UniformHandle handle, const Vec2& value);
+    void setUniformVec2v(UniformHandle handle, ssize_t size, const Vec2* pointer);
+    void setUniformVec3(UniformHandle handle, const Vec3& value);
+    void setUniformVec3v(UniformHandle handle, ssize_t size, const Vec3* pointer);
+    void setUniformVec4(UniformHandle handle, const Vec4& value);
+    void setUniformVec4v(UniformHandle handle, ssize_t size, const Vec4* pointer);
+    void setUniformMat4(UniformHandle handle, const Mat4& value);
+    void setUniformCallback(UniformHandle handle, const std::function<void(GLProgram*, Uniform*)> &callback);
+    void setUniformTexture(UniformHandle handle, Texture2D *texture);
+    /**@}*/
+
     /** 
      * Returns the Node bound to the GLProgramState
      */
@@ -468,13 +513,23 @@ protected:
     void resetGLProgram();
     void updateUniformsAndAttributes();
     VertexAttribValue* getVertexAttribValue(const std::string& attributeName);
+    // the getters mark the returned uniform as dirty, they are only used by the setters
     UniformValue* getUniformValue(const std::string& uniformName);
     UniformValue* getUniformValue(GLint uniformLocation);
+    UniformValue* getUniformValue(UniformHandle handle);
+    void bindUniformTexture(UniformValue* value, Texture2D* texture, GLuint textureId);
+    void markAllUniformsDirty();
 
 
     bool _uniformAttributeValueDirty;
-    std::unordered_map<std::string, GLint> _uniformsByName;
-    std::unordered_map<GLint, UniformValue> _uniforms;
+    // uniform values sorted by name, indexed by UniformHandle
+    std::vector<UniformValue> _uniforms;
+    std::unordered_map<std::string, int> _uniformsByName;
+    std::unordered_map<GLint, int> _uniformsByLocation;
+    // one bit per uniform, set when the value changed since the last applyUniforms()
+    std::vector<uint32_t> _uniformDirtyBits;
+    // one bit per uniform, set when it isn't in the program anymore after a relink, it is not applied
+    std::vector<uint32_t> _uniformRemovedBits;
     std::unordered_map<std::string, VertexAttribValue> _attributes;
     std::unordered_map<std::string, int> _boundTextureUnits;
 
@@ -0,0 +1,158 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCInstancedQuadCommand.h"
+#include "renderer/ccGLStateCache.h"
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCTexture2D.h"
+#include "base/CCConfiguration.h"
+#include "2d/CCNode.h"
+#include "xxhash.h"
+
+NS_CC_BEGIN
+
+InstancedQuadCommand::InstancedQuadCommand()
+:_materialID(0)
+,_textureID(0)
+,_glProgramState(nullptr)
+,_blendType(BlendFunc::DISABLE)
+,_usesInstanceParams(false)
+,_alphaTextureID(0)
+{
+    _type = RenderCommand::Type::INSTANCED_QUAD_COMMAND;
+}
+
+InstancedQuadCommand::~InstancedQuadCommand()
+{
+}
+
+bool InstancedQuadCommand::isSupported(const Mat4& mv, uint32_t flags)
+{
+    if ((flags & Node::FLAGS_RENDER_AS_3D) || !Configuration::getInstance()->supportsInstancedArrays())
+        return false;
+
+    // the quad is expanded in 2D, the transform must not move it out of the z = 0 plane nor be projective
+    const float* m = mv.m;
+    return m[2] == 0 && m[6] == 0 && m[14] == 0
+        && m[3] == 0 && m[7] == 0 && m[15] == 1;
+}
+
+void InstancedQuadCommand::init(float globalOrder, Texture2D* texture, GLProgramState* glProgramState, BlendFunc blendType, const V3F_C4B_T2F_Quad& quad, const Mat4& mv, uint32_t flags,
+                                const Vec4& params0, const Vec4& params1)
+{
+    CCASSERT(texture, "Invalid Texture");
+    CCASSERT(glProgramState, "Invalid GLProgramState");
+    CCASSERT(glProgramState->getVertexAttribsFlags() == 0, "No custom attributes are supported in InstancedQuadCommand");
+
+    RenderCommand::init(globalOrder, mv, flags);
+
+    // only three corners are needed, the quad is a parallelogram
+    Vec3 bl = quad.bl.vertices;
+    Vec3 br = quad.br.vertices;
+    Vec3 tl = quad.tl.vertices;
+    mv.transformPoint(&bl);
+    mv.transformPoint(&br);
+    mv.transformPoint(&tl);
+
+    const Tex2F& blUV = quad.bl.texCoords;
+    const Tex2F& brUV = quad.br.texCoords;
+    const Tex2F& tlUV = quad.tl.texCoords;
+
+    GLfloat* origin = _instance.origin;
+    origin[0] = bl.x;
+    origin[1] = bl.y;
+    origin[2] = blUV.u;
+    origin[3] = blUV.v;
+    GLfloat* axes = _instance.axes;
+    axes[0] = br.x - bl.x;
+    axes[1] = br.y - bl.y;
+    axes[2] = tl.x - bl.x;
+    axes[3] = tl.y - bl.y;
+    GLfloat* texCoordAxes = _instance.texCoordAxes;
+    texCoordAxes[0] = brUV.u - blUV.u;
+    texCoordAxes[1] = brUV.v - blUV.v;
+    texCoordAxes[2] = tlUV.u - blUV.u;
+    texCoordAxes[3] = tlUV.v - blUV.v;
+    _instance.color = quad.bl.colors;
+
+    if (_textureID != texture->getName() || _blendType.src != blendType.src || _blendType.dst != blendType.dst ||
+        _glProgramState != glProgramState)
+    {
+        _textureID = texture->getName();
+        _blendType = blendType;
+        _glProgramState = glProgramState;
+
+        GLProgram* glProgram = glProgramState->getGLProgram();
+        _usesInstanceParams = glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS0) != nullptr
+            || glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_PARAMS1) != nullptr;
+
+        generateMaterialID();
+    }
+    _alphaTextureID = texture->getAlphaTextureName();
+
+    if (_usesInstanceParams)
+    {
+        memcpy(_instanceParams.params0, &params0.x, sizeof(_instanceParams.params0));
+        memcpy(_instanceParams.params1, &params1.x, sizeof(_instanceParams.params1));
+    }
+}
+
+void InstancedQuadCommand::generateMaterialID()
+{
+    // same hash as TrianglesCommand, see TrianglesCommand::generateMaterialID()
+    struct {
+        void* glProgramState;
+        GLuint textureId;
+        GLenum blendSrc;
+        GLenum blendDst;
+    } hashMe;
+
+    // NOTE: Initialize hashMe struct to make the value of padding bytes be filled with zero.
+    memset(&hashMe, 0, sizeof(hashMe));
+
+    hashMe.textureId = _textureID;
+    hashMe.blendSrc = _blendType.src;
+    hashMe.blendDst = _blendType.dst;
+    hashMe.glProgramState = _glProgramState;
+    _materialID = XXH32((const void*)&hashMe, sizeof(hashMe), 0);
+}
+
+void InstancedQuadCommand::useMaterial() const
+{
+    //Set texture
+    GL::bindTexture2D(_textureID);
+
+    if (_alphaTextureID > 0)
+    { // ANDROID ETC1 ALPHA supports.
+        GL::bindTexture2DN(1, _alphaTextureID);
+    }
+    //set blend mode
+    GL::blendFunc(_blendType.src, _blendType.dst);
+
+    // the instances are already in world space
+    _glProgramState->apply(Mat4::IDENTITY);
+}
+
+NS_CC_END
@@ -0,0 +1,140 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_INSTANCED_QUAD_COMMAND__
+#define __CC_INSTANCED_QUAD_COMMAND__
+
+#include "renderer/CCRenderCommand.h"
+#include "renderer/CCGLProgramState.h"
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class Texture2D;
+
+/**
+ Command used to render a 2D quad with instanced drawing.
+ Instead of four transformed vertices, the renderer uploads one compact record per quad: its origin and edges
+ in world space, its texture coordinates and its color, plus two free vectors for custom shaders. The quad is
+ expanded in the vertex shader, so the vertices are not transformed on the CPU.
+ Consecutive commands with the same material id (texture, glProgramState and blend function) are drawn with a
+ single draw call. The glProgram must expand the quad from the instance attributes, like the built in
+ GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_INSTANCED.
+ Use `isSupported()` to know if the command can be used, otherwise draw the quad with a TrianglesCommand.
+*/
+class CC_DLL InstancedQuadCommand : public RenderCommand
+{
+public:
+    /**Per instance data uploaded to the GPU, 52 bytes. Plain floats since a Vec4 is padded to 16 bytes with SSE. */
+    struct Instance
+    {
+        /**Bottom left corner (xy) and its texture coordinate (zw).*/
+        GLfloat origin[4];
+        /**Bottom edge (xy) and left edge (zw) of the quad.*/
+        GLfloat axes[4];
+        /**Texture coordinates of the bottom edge (xy) and left edge (zw).*/
+        GLfloat texCoordAxes[4];
+        /**Color of the quad.*/
+        Color4B color;
+    };
+
+    /**Free parameters for custom shaders, only uploaded for the glPrograms which use them. */
+    struct InstanceParams
+    {
+        GLfloat params0[4];
+        GLfloat params1[4];
+    };
+
+    /**Constructor.*/
+    InstancedQuadCommand();
+    /**Destructor.*/
+    ~InstancedQuadCommand();
+
+    /** Whether a quad with the given transform can be drawn with instanced drawing.
+     It needs GPU support for instanced arrays, and a 2D affine transform.
+     @param mv ModelView matrix of the quad.
+     @param flags Flags of the quad, 3D quads are not supported.
+     */
+    static bool isSupported(const Mat4& mv, uint32_t flags);
+
+    /** Initializes the command.
+     @param globalOrder GlobalZOrder of the command.
+     @param texture The texture of the quad.
+     @param glProgramState The specified glProgram and its uniform, the glProgram must use the instance attributes.
+     @param blendType Blend function for the command.
+     @param quad The quad to draw, in local space. It must be a parallelogram, its top right corner is ignored.
+     @param mv ModelView matrix for the command.
+     @param flags to indicate that the command is using 3D rendering or not.
+     @param params0 First free parameter of the instance.
+     @param params1 Second free parameter of the instance.
+     */
+    void init(float globalOrder, Texture2D* texture, GLProgramState* glProgramState, BlendFunc blendType, const V3F_C4B_T2F_Quad& quad, const Mat4& mv, uint32_t flags,
+              const Vec4& params0 = Vec4::ZERO, const Vec4& params1 = Vec4::ZERO);
+    /**Apply the texture, shaders, programs, blend functions to GPU pipeline.*/
+    void useMaterial() const;
+    /**Get the material id of command.*/
+    uint32_t getMaterialID() const { return _materialID; }
+    /**Get the openGL texture handle.*/
+    GLuint getTextureID() const { return _textureID; }
+    /**Get the glprogramstate.*/
+    GLProgramState* getGLProgramState() const { return _glProgramState; }
+    /**Get the blend function.*/
+    BlendFunc getBlendType() const { return _blendType; }
+    /**Get the data uploaded for the quad.*/
+    const Instance& getInstance() const { return _instance; }
+    /**Get the free parameters of the quad.*/
+    const InstanceParams& getInstanceParams() const { return _instanceParams; }
+    /**Whether the glProgram reads the free parameters, they are only uploaded in this case.*/
+    bool usesInstanceParams() const { return _usesInstanceParams; }
+
+protected:
+    /**Generate the material ID by textureID, glProgramState, and blend function.*/
+    void generateMaterialID();
+
+    /**Generated material id.*/
+    uint32_t _materialID;
+    /**OpenGL handle for texture.*/
+    GLuint _textureID;
+    /**GLprogramstate for the command. encapsulate shaders and uniforms.*/
+    GLProgramState* _glProgramState;
+    /**Blend function when rendering the quad.*/
+    BlendFunc _blendType;
+    /**The quad, already in world space.*/
+    Instance _instance;
+    InstanceParams _instanceParams;
+    bool _usesInstanceParams;
+
+    GLuint _alphaTextureID; // ANDROID ETC1 ALPHA supports.
+};
+
+NS_CC_END
+/**
+ end of support group
+ @}
+ */
+#endif // __CC_INSTANCED_QUAD_COMMAND__
@@ -64,7 +64,9 @@ public:
         /**Primitive command, used to draw primitives such as lines, points and triangles.*/
         PRIMITIVE_COMMAND,
         /**Triangles command, used to draw triangles.*/
-        TRIANGLES_COMMAND
+        TRIANGLES_COMMAND,
+        /**Instanced quad command, used to draw 2D quads expanded on the GPU.*/
+        INSTANCED_QUAD_COMMAND
     };
 
     /**
@@ -98,6 +100,13 @@ public:
     void set3D(bool value) { _is3D = value; }
     /**Get the depth by current model view matrix.*/
     float getDepth() const { return _depth; }
+    /**
+     Whether the command could be drawn in any order relative to the other commands of the same global Z order.
+     Only used by the renderer when batch reordering is enabled.
+     */
+    bool isOrderIndependent() const { return _isOrderIndependent; }
+    /**Set order independent flag, for example when the command is opaque or known not to overlap its neighbours.*/
+    void setOrderIndependent(bool value) { _isOrderIndependent = value; }
     
 protected:
     /**Constructor.*/
@@ -127,6 +136,12 @@ protected:
     
     /** Depth from the model view matrix.*/
     float _depth;
+    
+    /**
+     If a command is order independent, the renderer is allowed to move it across commands with a different material
+     in the same global Z order band without checking its bounding rect, in order to make longer batches.
+     */
+    bool _isOrderIndependent;
 };
 
 NS_CC_END
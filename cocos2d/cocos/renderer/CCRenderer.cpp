@@ -26,6 +26,7 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <cfloat>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCBatchCommand.h"
@@ -45,6 +46,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCFrameProfiler.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
 
@@ -61,8 +63,48 @@ static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
     return  a->getDepth() > b->getDepth();
 }
 
+// How many batches back a command may be moved when reordering for batching.
+// Keeps the reordering linear in the number of commands.
+static const size_t BATCH_REORDER_LOOKBACK = 32;
+
+static bool isReorderableCommand(const RenderCommand* command)
+{
+    return command->getType() == RenderCommand::Type::TRIANGLES_COMMAND
+        && !command->isSkipBatching()
+        && !command->is3D();
+}
+
+// bounding rect of the triangles in view space
+static Rect getTrianglesBoundingRect(const TrianglesCommand* cmd)
+{
+    const Mat4& mv = cmd->getModelView();
+    const V3F_C4B_T2F* verts = cmd->getVertices();
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    for (ssize_t i = 0, count = cmd->getVertexCount(); i < count; ++i)
+    {
+        const Vec3& v = verts[i].vertices;
+        float x = mv.m[0] * v.x + mv.m[4] * v.y + mv.m[8] * v.z + mv.m[12];
+        float y = mv.m[1] * v.x + mv.m[5] * v.y + mv.m[9] * v.z + mv.m[13];
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+    if (minX > maxX)
+        return Rect::ZERO;
+    return Rect(minX, minY, maxX - minX, maxY - minY);
+}
+
+// rects sharing only an edge don't overlap: no pixel is covered by both
+static bool isRectOverlapped(const Rect& a, const Rect& b)
+{
+    return a.getMinX() < b.getMaxX() && b.getMinX() < a.getMaxX()
+        && a.getMinY() < b.getMaxY() && b.getMinY() < a.getMaxY();
+}
+
 // queue
 RenderQueue::RenderQueue()
+: _savedBatches(0)
 {
     
 }
@@ -109,12 +151,130 @@ ssize_t RenderQueue::size() const
     return result;
 }
 
-void RenderQueue::sort()
+void RenderQueue::sort(bool reorderForBatching)
 {
     // Don't sort _queue0, it already comes sorted
     std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
     std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
     std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+
+    _savedBatches = 0;
+    if (reorderForBatching)
+    {
+        _savedBatches += this->reorderForBatching(_commands[QUEUE_GROUP::GLOBALZ_NEG]);
+        _savedBatches += this->reorderForBatching(_commands[QUEUE_GROUP::GLOBALZ_ZERO]);
+        _savedBatches += this->reorderForBatching(_commands[QUEUE_GROUP::GLOBALZ_POS]);
+    }
+}
+
+ssize_t RenderQueue::reorderForBatching(std::vector<RenderCommand*>& commands)
+{
+    ssize_t saved = 0;
+    size_t first = 0;
+    const size_t count = commands.size();
+    while (first < count)
+    {
+        // the subqueue is sorted, so commands with the same global Z order are contiguous
+        size_t last = first + 1;
+        const float z = commands[first]->getGlobalOrder();
+        while (last < count && commands[last]->getGlobalOrder() == z)
+            ++last;
+
+        if (last - first > 2)
+            saved += reorderBandForBatching(commands, first, last);
+        first = last;
+    }
+    return saved;
+}
+
+ssize_t RenderQueue::reorderBandForBatching(std::vector<RenderCommand*>& commands, size_t first, size_t last)
+{
+    // A run is a group of commands which will be drawn one after another.
+    // Each command is appended to the latest run with the same material, if it can be moved in front of
+    // all the runs after it: they must not overlap it, unless it is flagged as order independent.
+    // Commands which can't be batched are barriers, nothing is moved across them.
+    auto& runs = _batchRuns;
+    auto& runIndices = _batchRunIndices;
+    auto& reordered = _reorderedCommands;
+    runs.clear();
+    runIndices.clear();
+
+    size_t barrier = 0;
+    ssize_t originalBatches = 0;
+    uint32_t prevMaterialID = 0;
+    bool prevBatchable = false;
+    bool moved = false;
+
+    for (size_t i = first; i < last; ++i)
+    {
+        RenderCommand* command = commands[i];
+        if (!isReorderableCommand(command))
+        {
+            runIndices.push_back(runs.size());
+            runs.push_back({0, false, Rect::ZERO, 1});
+            barrier = runs.size();
+            ++originalBatches;
+            prevBatchable = false;
+            continue;
+        }
+
+        auto cmd = static_cast<TrianglesCommand*>(command);
+        const uint32_t materialID = cmd->getMaterialID();
+        if (!prevBatchable || prevMaterialID != materialID)
+            ++originalBatches;
+        prevMaterialID = materialID;
+        prevBatchable = true;
+
+        const Rect bounds = getTrianglesBoundingRect(cmd);
+        const bool orderIndependent = cmd->isOrderIndependent();
+        const size_t floor = std::max(barrier, runs.size() > BATCH_REORDER_LOOKBACK ? runs.size() - BATCH_REORDER_LOOKBACK : 0);
+
+        size_t target = runs.size();
+        for (size_t r = runs.size(); r > floor; --r)
+        {
+            const BatchRun& run = runs[r - 1];
+            if (run.batchable && run.materialID == materialID)
+            {
+                target = r - 1;
+                break;
+            }
+            if (!orderIndependent && isRectOverlapped(run.bounds, bounds))
+                break;
+        }
+
+        if (target == runs.size())
+        {
+            runs.push_back({materialID, true, bounds, 1});
+        }
+        else
+        {
+            BatchRun& run = runs[target];
+            run.bounds.merge(bounds);
+            ++run.count;
+            moved = moved || target != runs.size() - 1;
+        }
+        runIndices.push_back(target);
+    }
+
+    if (!moved)
+        return 0;
+
+    // stable counting sort of the band by run index
+    size_t offset = 0;
+    for (auto& run : runs)
+    {
+        size_t runCount = run.count;
+        run.count = offset;
+        offset += runCount;
+    }
+    reordered.resize(last - first);
+    for (size_t i = first; i < last; ++i)
+    {
+        reordered[runs[runIndices[i - first]].count++] = commands[i];
+    }
+    std::copy(reordered.begin(), reordered.end(), commands.begin() + first);
+
+    return originalBatches - (ssize_t)runs.size();
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -204,8 +364,12 @@ Renderer::Renderer()
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_savedBatches(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
+,_isBatchReorderingEnabled(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
 #endif
@@ -217,6 +381,8 @@ Renderer::Renderer()
     RenderQueue defaultRenderQueue;
     _renderGroups.push_back(defaultRenderQueue);
     _queuedTriangleCommands.reserve(BATCH_TRIAGCOMMAND_RESERVED_SIZE);
+    _queuedInstancedQuadCommands.reserve(BATCH_TRIAGCOMMAND_RESERVED_SIZE);
+    _instanceBuffersVBO[0] = _instanceBuffersVBO[1] = _instanceBuffersVBO[2] = 0;
 
     // default clear color
     _clearColor = Color4F::BLACK;
@@ -232,6 +398,7 @@ Renderer::~Renderer()
     _groupCommandManager->release();
     
     glDeleteBuffers(2, _buffersVBO);
+    glDeleteBuffers(3, _instanceBuffersVBO);
 
     free(_triBatchesToDraw);
 
@@ -271,6 +438,8 @@ void Renderer::setupBuffer()
     {
         setupVBO();
     }
+
+    setupInstanceBuffers();
 }
 
 void Renderer::setupVBOAndVAO()
@@ -327,6 +496,28 @@ void Renderer::setupVBO()
 //    mapBuffers();
 }
 
+void Renderer::setupInstanceBuffers()
+{
+    if (!Configuration::getInstance()->supportsInstancedArrays())
+        return;
+
+    // corners of the unit quad, drawn as a triangle strip and scaled by the instance axes
+    static const GLfloat corners[] = {
+        0, 0,
+        1, 0,
+        0, 1,
+        1, 1,
+    };
+
+    glGenBuffers(3, &_instanceBuffersVBO[0]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
 void Renderer::mapBuffers()
 {
     // Avoid changing the element buffer for whatever VAO might be bound.
@@ -359,6 +550,62 @@ void Renderer::addCommand(RenderCommand* command, int renderQueueID)
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
     _renderGroups[renderQueueID].push_back(command);
+
+    for (auto recording : _commandRecordings)
+    {
+        recording->_entries.push_back({command, renderQueueID});
+    }
+}
+
+void Renderer::pushCommandRecording(RenderCommandRecording* recording)
+{
+    CCASSERT(!_isRendering, "Cannot record commands while rendering");
+    _commandRecordings.push_back(recording);
+}
+
+void Renderer::popCommandRecording()
+{
+    CCASSERT(!_commandRecordings.empty(), "No command recording to pop");
+    _commandRecordings.pop_back();
+}
+
+void Renderer::addRecordedCommands(RenderCommandRecording& recording)
+{
+    if (!recording._verticesTransformed)
+    {
+        // the commands didn't change since they were recorded, their vertices only need to be transformed once
+        auto& vertices = recording._transformedVertices;
+        vertices.clear();
+        for (const auto& entry : recording._entries)
+        {
+            if (entry.command->getType() != RenderCommand::Type::TRIANGLES_COMMAND)
+                continue;
+
+            auto cmd = static_cast<TrianglesCommand*>(entry.command);
+            const size_t first = vertices.size();
+            vertices.insert(vertices.end(), cmd->getVertices(), cmd->getVertices() + cmd->getVertexCount());
+
+            const Mat4& modelView = cmd->getModelView();
+            for (size_t i = first; i < vertices.size(); ++i)
+            {
+                modelView.transformPoint(&vertices[i].vertices);
+            }
+        }
+        recording._verticesTransformed = true;
+    }
+
+    // the commands may have been replayed by a nested recording since, point them to this one every time
+    const V3F_C4B_T2F* transformedVertices = recording._transformedVertices.data();
+    for (const auto& entry : recording._entries)
+    {
+        if (entry.command->getType() == RenderCommand::Type::TRIANGLES_COMMAND)
+        {
+            auto cmd = static_cast<TrianglesCommand*>(entry.command);
+            cmd->setTransformedVertices(transformedVertices);
+            transformedVertices += cmd->getVertexCount();
+        }
+        addCommand(entry.command, entry.renderQueueID);
+    }
 }
 
 void Renderer::pushGroup(int renderQueueID)
@@ -387,6 +634,7 @@ void Renderer::processRenderCommand(RenderCommand* command)
     {
         // flush other queues
         flush3D();
+        drawInstancedQuads();
 
         auto cmd = static_cast<TrianglesCommand*>(command);
         
@@ -403,6 +651,21 @@ void Renderer::processRenderCommand(RenderCommand* command)
         _filledIndex += cmd->getIndexCount();
         _filledVertex += cmd->getVertexCount();
     }
+    else if (RenderCommand::Type::INSTANCED_QUAD_COMMAND == commandType)
+    {
+        // flush other queues
+        flush3D();
+        drawBatchedTriangles();
+
+        // flush own queue when buffer is full
+        if (_queuedInstancedQuadCommands.size() >= INSTANCE_VBO_SIZE)
+        {
+            drawInstancedQuads();
+        }
+
+        // queue it
+        _queuedInstancedQuadCommands.push_back(static_cast<InstancedQuadCommand*>(command));
+    }
     else if (RenderCommand::Type::MESH_COMMAND == commandType)
     {
         flush2D();
@@ -631,6 +894,8 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_FRAME_PROFILER_SCOPE("Renderer::render");
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -641,9 +906,11 @@ void Renderer::render()
     {
         //Process render commands
         //1. Sort render commands based on ID
+        _savedBatches = 0;
         for (auto &renderqueue : _renderGroups)
         {
-            renderqueue.sort();
+            renderqueue.sort(_isBatchReorderingEnabled);
+            _savedBatches += renderqueue.getSavedBatches();
         }
         visitRenderQueue(_renderGroups[0]);
     }
@@ -666,6 +933,7 @@ void Renderer::clean()
 
     // Clear batch commands
     _queuedTriangleCommands.clear();
+    _queuedInstancedQuadCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
     _lastBatchedMeshCommand = nullptr;
@@ -708,13 +976,21 @@ void Renderer::setDepthTest(bool enable)
 
 void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
 {
-    memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
-
-    // fill vertex, and convert them to world coordinates
-    const Mat4& modelView = cmd->getModelView();
-    for(ssize_t i=0; i < cmd->getVertexCount(); ++i)
+    if (cmd->getTransformedVertices())
     {
-        modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
+        // replayed by a static subtree, already in world coordinates
+        memcpy(&_verts[_filledVertex], cmd->getTransformedVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+    }
+    else
+    {
+        memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+
+        // fill vertex, and convert them to world coordinates
+        const Mat4& modelView = cmd->getModelView();
+        for(ssize_t i=0; i < cmd->getVertexCount(); ++i)
+        {
+            modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
+        }
     }
 
     // fill index
@@ -868,6 +1144,126 @@ void Renderer::drawBatchedTriangles()
     _filledIndex = 0;
 }
 
+void Renderer::drawInstancedQuads()
+{
+    if(_queuedInstancedQuadCommands.empty())
+        return;
+
+    CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_INSTANCED_QUADS");
+
+    static const GLuint instanceAttribs[] = {
+        GLProgram::VERTEX_ATTRIB_COLOR,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_ORIGIN,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_AXES,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_TEX_COORD_AXES,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS0,
+        GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS1,
+    };
+
+    /************** 1: Setup up instances *************/
+    _instances.clear();
+    _instanceParams.clear();
+    for(const auto& cmd : _queuedInstancedQuadCommands)
+    {
+        _instances.push_back(cmd->getInstance());
+        if (cmd->usesInstanceParams())
+            _instanceParams.push_back(cmd->getInstanceParams());
+    }
+
+    /************** 2: Copy instances to GL objects *************/
+    // The attributes are set on the default VAO, the VAO of the TrianglesCommand must not be changed.
+    GL::bindVAO(0);
+
+    // the params are only enabled for the programs which read them
+    const uint32_t paramsFlags = (1 << GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS0) | (1 << GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS1);
+    uint32_t flags = 1 << GLProgram::VERTEX_ATTRIB_POSITION;
+    for (auto attrib : instanceAttribs)
+    {
+        flags |= 1 << attrib;
+    }
+    flags &= ~paramsFlags;
+
+    // quad corners
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[0]);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*) 0);
+
+    // instances
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_instances[0]) * _instances.size(), _instances.data(), GL_DYNAMIC_DRAW);
+
+    if (!_instanceParams.empty())
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[2]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_instanceParams[0]) * _instanceParams.size(), _instanceParams.data(), GL_DYNAMIC_DRAW);
+    }
+
+    for (auto attrib : instanceAttribs)
+    {
+        glVertexAttribDivisor(attrib, 1);
+    }
+
+    /************** 3: Draw *************/
+#define kInstanceSize sizeof(_instances[0])
+#define kInstanceParamsSize sizeof(_instanceParams[0])
+    const size_t count = _queuedInstancedQuadCommands.size();
+    size_t first = 0;
+    size_t firstParams = 0;
+    while (first < count)
+    {
+        // consecutive instances with the same material are drawn together
+        auto cmd = _queuedInstancedQuadCommands[first];
+        size_t last = first + 1;
+        if (!cmd->isSkipBatching())
+        {
+            while (last < count
+                   && !_queuedInstancedQuadCommands[last]->isSkipBatching()
+                   && _queuedInstancedQuadCommands[last]->getMaterialID() == cmd->getMaterialID())
+            {
+                ++last;
+            }
+        }
+
+        cmd->useMaterial();
+
+        const bool usesParams = cmd->usesInstanceParams();
+        GL::enableVertexAttribs(usesParams ? flags | paramsFlags : flags);
+
+        const size_t offset = first * kInstanceSize;
+        glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[1]);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, kInstanceSize, (GLvoid*) (offset + offsetof(InstancedQuadCommand::Instance, color)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_INSTANCE_ORIGIN, 4, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*) (offset + offsetof(InstancedQuadCommand::Instance, origin)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_INSTANCE_AXES, 4, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*) (offset + offsetof(InstancedQuadCommand::Instance, axes)));
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_INSTANCE_TEX_COORD_AXES, 4, GL_FLOAT, GL_FALSE, kInstanceSize, (GLvoid*) (offset + offsetof(InstancedQuadCommand::Instance, texCoordAxes)));
+        if (usesParams)
+        {
+            const size_t paramsOffset = firstParams * kInstanceParamsSize;
+            glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffersVBO[2]);
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS0, 4, GL_FLOAT, GL_FALSE, kInstanceParamsSize, (GLvoid*) (paramsOffset + offsetof(InstancedQuadCommand::InstanceParams, params0)));
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_INSTANCE_PARAMS1, 4, GL_FLOAT, GL_FALSE, kInstanceParamsSize, (GLvoid*) (paramsOffset + offsetof(InstancedQuadCommand::InstanceParams, params1)));
+            firstParams += last - first;
+        }
+
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) (last - first));
+        _drawnBatches++;
+        // counted like the 6 indices of a batched quad, so the stats can be compared
+        _drawnVertices += (last - first) * 6;
+
+        first = last;
+    }
+#undef kInstanceSize
+#undef kInstanceParamsSize
+
+    /************** 4: Cleanup *************/
+    // other commands expect one value per vertex
+    for (auto attrib : instanceAttribs)
+    {
+        glVertexAttribDivisor(attrib, 0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    _queuedInstancedQuadCommands.clear();
+}
+
 void Renderer::flush()
 {
     flush2D();
@@ -877,6 +1273,7 @@ void Renderer::flush()
 void Renderer::flush2D()
 {
     flushTriangles();
+    drawInstancedQuads();
 }
 
 void Renderer::flush3D()
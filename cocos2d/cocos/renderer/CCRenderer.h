@@ -33,6 +33,7 @@
 #include "platform/CCPlatformMacros.h"
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCGLProgram.h"
+#include "renderer/CCInstancedQuadCommand.h"
 #include "platform/CCGL.h"
 
 #if !defined(NDEBUG) && CC_TARGET_PLATFORM == CC_PLATFORM_IOS
@@ -95,8 +96,11 @@ public:
     void push_back(RenderCommand* command);
     /**Return the number of render commands.*/
     ssize_t size() const;
-    /**Sort the render commands.*/
-    void sort();
+    /**Sort the render commands.
+     @param reorderForBatching If true, commands of the same global Z order are also reordered by material
+     to make longer batches, where it doesn't change the rendered result.
+     */
+    void sort(bool reorderForBatching = false);
     /**Treat sorted commands as an array, access them one by one.*/
     RenderCommand* operator[](ssize_t index) const;
     /**Clear all rendered commands.*/
@@ -107,6 +111,8 @@ public:
     std::vector<RenderCommand*>& getSubQueue(QUEUE_GROUP group) { return _commands[group]; }
     /**Get the number of render commands contained in a subqueue.*/
     ssize_t getSubQueueSize(QUEUE_GROUP group) const { return _commands[group].size(); }
+    /**Get the number of batches saved by reordering in the last sort.*/
+    ssize_t getSavedBatches() const { return _savedBatches; }
 
     /**Save the current DepthState, CullState, DepthWriteState render state.*/
     void saveRenderState();
@@ -114,9 +120,30 @@ public:
     void restoreRenderState();
     
 protected:
+    /**Commands drawn one after another when reordering for batching.*/
+    struct BatchRun
+    {
+        uint32_t materialID;
+        bool batchable;
+        Rect bounds;
+        size_t count;
+    };
+
+    /**Reorder each global Z order band of a sorted 2D subqueue by material. Returns the number of batches saved.*/
+    ssize_t reorderForBatching(std::vector<RenderCommand*>& commands);
+    /**Reorder the commands in [first, last), which have the same global Z order.*/
+    ssize_t reorderBandForBatching(std::vector<RenderCommand*>& commands, size_t first, size_t last);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
     
+    /**Batches saved by reordering in the last sort.*/
+    ssize_t _savedBatches;
+    /**Scratch buffers used by reorderBandForBatching, kept to avoid allocating every frame.*/
+    std::vector<BatchRun> _batchRuns;
+    std::vector<size_t> _batchRunIndices;
+    std::vector<RenderCommand*> _reorderedCommands;
+    
     /**Cull state.*/
     bool _isCullEnabled;
     /**Depth test enable state.*/
@@ -125,6 +152,35 @@ protected:
     GLboolean _isDepthWrite;
 };
 
+/** Render commands recorded while they were added to the renderer, together with their render queue.
+ Used by static subtrees to replay the commands of the previous frame without visiting their children.
+ The commands are owned by the nodes, so a recording is only valid while none of those nodes changed.
+ The vertices of the triangles commands are transformed to world coordinates the first time the recording is
+ replayed, and copied as they are by the following replays.
+*/
+class CC_DLL RenderCommandRecording
+{
+public:
+    RenderCommandRecording() : _verticesTransformed(false) {}
+
+    /**Remove all the recorded commands.*/
+    void clear() { _entries.clear(); _transformedVertices.clear(); _verticesTransformed = false; }
+    /**Return the number of recorded commands.*/
+    ssize_t size() const { return _entries.size(); }
+
+protected:
+    friend class Renderer;
+
+    struct Entry
+    {
+        RenderCommand* command;
+        int renderQueueID;
+    };
+    std::vector<Entry> _entries;
+    std::vector<V3F_C4B_T2F> _transformedVertices;
+    bool _verticesTransformed;
+};
+
 //the struct is not used outside.
 struct RenderStackElement
 {
@@ -145,6 +201,8 @@ public:
     static const int VBO_SIZE = 65536;
     /**The max number of indices in a index buffer.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /**The max number of instances drawn by a single instanced draw call.*/
+    static const int INSTANCE_VBO_SIZE = VBO_SIZE / 4;
     /**The rendercommands which can be batched will be saved into a list, this is the reserved size of this list.*/
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
@@ -163,6 +221,17 @@ public:
     /** Adds a `RenderComamnd` into the renderer specifying a particular render queue ID */
     void addCommand(RenderCommand* command, int renderQueueID);
 
+    /** Starts recording the commands added to the renderer into `recording`, until the matching `popCommandRecording`.
+     Recordings can be nested, a command is added to every active recording.
+     */
+    void pushCommandRecording(RenderCommandRecording* recording);
+
+    /** Stops the last started recording */
+    void popCommandRecording();
+
+    /** Adds again all the commands of a recording, each one into the render queue it was recorded with */
+    void addRecordedCommands(RenderCommandRecording& recording);
+
     /** Pushes a group into the render queue */
     void pushGroup(int renderQueueID);
 
@@ -195,6 +264,18 @@ public:
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
     /* clear draw stats */
     void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    /* returns the number of batches saved by reordering commands in the last frame */
+    ssize_t getSavedBatches() const { return _savedBatches; }
+
+    /**
+     * Enable/Disable reordering of the commands with the same global Z order by material.
+     * A TrianglesCommand is moved in front of commands with other materials only when it is flagged as
+     * order independent or its bounding rect doesn't overlap them, so the rendered result doesn't change.
+     * Disabled by default.
+     */
+    void setBatchReorderingEnabled(bool enabled) { _isBatchReorderingEnabled = enabled; }
+    /** Whether commands are reordered by material to make longer batches. */
+    bool isBatchReorderingEnabled() const { return _isBatchReorderingEnabled; }
 
     /**
      * Enable/Disable depth test
@@ -215,8 +296,10 @@ protected:
     void setupBuffer();
     void setupVBOAndVAO();
     void setupVBO();
+    void setupInstanceBuffers();
     void mapBuffers();
     void drawBatchedTriangles();
+    void drawInstancedQuads();
 
     //Draw the previews queued triangles and flush previous context
     void flush();
@@ -240,8 +323,11 @@ protected:
     
     std::vector<RenderQueue> _renderGroups;
 
+    std::vector<RenderCommandRecording*> _commandRecordings;
+
     MeshCommand* _lastBatchedMeshCommand;
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
+    std::vector<InstancedQuadCommand*> _queuedInstancedQuadCommands;
 
     //for TrianglesCommand
     V3F_C4B_T2F _verts[VBO_SIZE];
@@ -249,6 +335,11 @@ protected:
     GLuint _buffersVAO;
     GLuint _buffersVBO[2]; //0: vertex  1: indices
 
+    //for InstancedQuadCommand
+    std::vector<InstancedQuadCommand::Instance> _instances;
+    std::vector<InstancedQuadCommand::InstanceParams> _instanceParams;
+    GLuint _instanceBuffersVBO[3]; //0: quad corners  1: instances  2: instance params
+
     // Internal structure that has the information for the batches
     struct TriBatchToDraw {
         TrianglesCommand* cmd;  // needed for the Material
@@ -268,11 +359,14 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    ssize_t _savedBatches;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
     bool _isDepthTestFor2D;
     
+    bool _isBatchReorderingEnabled;
+    
     GroupCommandManager* _groupCommandManager;
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
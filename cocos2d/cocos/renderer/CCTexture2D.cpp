@@ -48,11 +48,29 @@ THE SOFTWARE.
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCGLProgramCache.h"
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCJobSystem.h"
+
+//#define USE_SSE2          : SSE2 code used for the pixel conversions
+//#define USE_NEON          : NEON code used for the pixel conversions
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define USE_NEON
+#include <arm_neon.h>
+#endif
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include "renderer/CCTextureCache.h"
 #endif
 
+// ETC2 is core in OpenGL ES 3 and ASTC is an extension, the GLES2 headers don't always define them
+#define CC_GL_COMPRESSED_RGB8_ETC2                                 0x9274
+#define CC_GL_COMPRESSED_RGBA8_ETC2_EAC                            0x9278
+#define CC_GL_COMPRESSED_RGBA_ASTC_4x4_KHR                         0x93B0
+#define CC_GL_COMPRESSED_RGBA_ASTC_6x6_KHR                         0x93B4
+#define CC_GL_COMPRESSED_RGBA_ASTC_8x8_KHR                         0x93B7
+
 NS_CC_BEGIN
 
 
@@ -108,6 +126,12 @@ namespace {
         PixelFormatInfoMapValue(Texture2D::PixelFormat::ATC_INTERPOLATED_ALPHA, Texture2D::PixelFormatInfo(GL_ATC_RGBA_INTERPOLATED_ALPHA_AMD,
             0xFFFFFFFF, 0xFFFFFFFF, 8, true, false)),
 #endif
+
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGB, Texture2D::PixelFormatInfo(CC_GL_COMPRESSED_RGB8_ETC2, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, false)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ETC2_RGBA, Texture2D::PixelFormatInfo(CC_GL_COMPRESSED_RGBA8_ETC2_EAC, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_4x4, Texture2D::PixelFormatInfo(CC_GL_COMPRESSED_RGBA_ASTC_4x4_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 8, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_6x6, Texture2D::PixelFormatInfo(CC_GL_COMPRESSED_RGBA_ASTC_6x6_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 4, true, true)),
+        PixelFormatInfoMapValue(Texture2D::PixelFormat::ASTC_8x8, Texture2D::PixelFormatInfo(CC_GL_COMPRESSED_RGBA_ASTC_8x8_KHR, 0xFFFFFFFF, 0xFFFFFFFF, 2, true, true)),
     };
 }
 
@@ -124,6 +148,184 @@ static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat
 //////////////////////////////////////////////////////////////////////////
 //convertor function
 
+namespace {
+    typedef void (*PixelsConverter)(const unsigned char* data, unsigned char* outData, size_t count);
+
+    // converts the pixels in blocks on the job system when the image is large enough
+    void convertPixels(const unsigned char* data, ssize_t dataLen, unsigned char* outData, size_t inBytes, size_t outBytes, PixelsConverter convert)
+    {
+        size_t count = dataLen / inBytes;
+#if CC_IMAGE_PARALLEL_MIN_PIXELS > 0
+        if (count >= CC_IMAGE_PARALLEL_MIN_PIXELS)
+        {
+            JobSystem::getInstance()->parallelFor(count, CC_IMAGE_PARALLEL_MIN_PIXELS / 2, [=](size_t begin, size_t end) {
+                convert(data + begin * inBytes, outData + begin * outBytes, end - begin);
+            });
+            return;
+        }
+#endif
+        convert(data, outData, count);
+    }
+
+#if defined(USE_SSE2)
+    // keeps the low 16 bits of the 32 bits lanes of two vectors
+    inline __m128i packLow16(__m128i a, __m128i b)
+    {
+        return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+    }
+
+    inline __m128i maskedShiftRight(__m128i pixels, int shift, int mask)
+    {
+        return _mm_and_si128(_mm_srli_epi32(pixels, shift), _mm_set1_epi32(mask));
+    }
+#endif
+
+    void convertRGBA8888ToRGB565Pixels(const unsigned char* data, unsigned char* outData, size_t count)
+    {
+        size_t i = 0;
+        unsigned short* out16 = (unsigned short*)outData;
+#if defined(USE_SSE2)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i p0 = _mm_loadu_si128((const __m128i*)(data + i * 4));
+            __m128i p1 = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16));
+            __m128i v0 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, _mm_set1_epi32(0xF8)), 8),
+                         _mm_or_si128(maskedShiftRight(p0, 5, 0x07E0), maskedShiftRight(p0, 19, 0x001F)));
+            __m128i v1 = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, _mm_set1_epi32(0xF8)), 8),
+                         _mm_or_si128(maskedShiftRight(p1, 5, 0x07E0), maskedShiftRight(p1, 19, 0x001F)));
+            _mm_storeu_si128((__m128i*)(out16 + i), packLow16(v0, v1));
+        }
+#elif defined(USE_NEON)
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(data + i * 4);
+            uint16x8_t v = vshll_n_u8(p.val[0], 8);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[1], 8), 5);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[2], 8), 11);
+            vst1q_u16(out16 + i, v);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            const unsigned char* p = data + i * 4;
+            out16[i] = (p[0] & 0x00F8) << 8    //R
+                | (p[1] & 0x00FC) << 3         //G
+                | (p[2] & 0x00F8) >> 3;        //B
+        }
+    }
+
+    void convertRGBA8888ToRGBA4444Pixels(const unsigned char* data, unsigned char* outData, size_t count)
+    {
+        size_t i = 0;
+        unsigned short* out16 = (unsigned short*)outData;
+#if defined(USE_SSE2)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i p0 = _mm_loadu_si128((const __m128i*)(data + i * 4));
+            __m128i p1 = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16));
+            __m128i v0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, _mm_set1_epi32(0xF0)), 8), maskedShiftRight(p0, 4, 0x0F00)),
+                                      _mm_or_si128(maskedShiftRight(p0, 16, 0x00F0), maskedShiftRight(p0, 28, 0x000F)));
+            __m128i v1 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, _mm_set1_epi32(0xF0)), 8), maskedShiftRight(p1, 4, 0x0F00)),
+                                      _mm_or_si128(maskedShiftRight(p1, 16, 0x00F0), maskedShiftRight(p1, 28, 0x000F)));
+            _mm_storeu_si128((__m128i*)(out16 + i), packLow16(v0, v1));
+        }
+#elif defined(USE_NEON)
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(data + i * 4);
+            uint16x8_t v = vshll_n_u8(p.val[0], 8);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[1], 8), 4);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[2], 8), 8);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[3], 8), 12);
+            vst1q_u16(out16 + i, v);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            const unsigned char* p = data + i * 4;
+            out16[i] = (p[0] & 0x00F0) << 8    //R
+                | (p[1] & 0x00F0) << 4         //G
+                | (p[2] & 0xF0)                //B
+                | (p[3] & 0xF0) >> 4;          //A
+        }
+    }
+
+    void convertRGBA8888ToRGB5A1Pixels(const unsigned char* data, unsigned char* outData, size_t count)
+    {
+        size_t i = 0;
+        unsigned short* out16 = (unsigned short*)outData;
+#if defined(USE_SSE2)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i p0 = _mm_loadu_si128((const __m128i*)(data + i * 4));
+            __m128i p1 = _mm_loadu_si128((const __m128i*)(data + i * 4 + 16));
+            __m128i v0 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p0, _mm_set1_epi32(0xF8)), 8), maskedShiftRight(p0, 5, 0x07C0)),
+                                      _mm_or_si128(maskedShiftRight(p0, 18, 0x003E), _mm_srli_epi32(p0, 31)));
+            __m128i v1 = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(p1, _mm_set1_epi32(0xF8)), 8), maskedShiftRight(p1, 5, 0x07C0)),
+                                      _mm_or_si128(maskedShiftRight(p1, 18, 0x003E), _mm_srli_epi32(p1, 31)));
+            _mm_storeu_si128((__m128i*)(out16 + i), packLow16(v0, v1));
+        }
+#elif defined(USE_NEON)
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(data + i * 4);
+            uint16x8_t v = vshll_n_u8(p.val[0], 8);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[1], 8), 5);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[2], 8), 10);
+            v = vsriq_n_u16(v, vshll_n_u8(p.val[3], 8), 15);
+            vst1q_u16(out16 + i, v);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            const unsigned char* p = data + i * 4;
+            out16[i] = (p[0] & 0x00F8) << 8    //R
+                | (p[1] & 0x00F8) << 3         //G
+                | (p[2] & 0x00F8) >> 2         //B
+                | (p[3] & 0x0080) >> 7;        //A
+        }
+    }
+
+    void convertRGBA8888ToRGB888Pixels(const unsigned char* data, unsigned char* outData, size_t count)
+    {
+        size_t i = 0;
+#if defined(USE_NEON)
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x4_t p = vld4_u8(data + i * 4);
+            uint8x8x3_t v = { { p.val[0], p.val[1], p.val[2] } };
+            vst3_u8(outData + i * 3, v);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            outData[i * 3] = data[i * 4];            //R
+            outData[i * 3 + 1] = data[i * 4 + 1];    //G
+            outData[i * 3 + 2] = data[i * 4 + 2];    //B
+        }
+    }
+
+    void convertRGB888ToRGBA8888Pixels(const unsigned char* data, unsigned char* outData, size_t count)
+    {
+        size_t i = 0;
+#if defined(USE_NEON)
+        for (; i + 8 <= count; i += 8)
+        {
+            uint8x8x3_t p = vld3_u8(data + i * 3);
+            uint8x8x4_t v = { { p.val[0], p.val[1], p.val[2], vdup_n_u8(0xFF) } };
+            vst4_u8(outData + i * 4, v);
+        }
+#endif
+        for (; i < count; ++i)
+        {
+            outData[i * 4] = data[i * 3];            //R
+            outData[i * 4 + 1] = data[i * 3 + 1];    //G
+            outData[i * 4 + 2] = data[i * 3 + 2];    //B
+            outData[i * 4 + 3] = 0xFF;               //A
+        }
+    }
+}
+
 // IIIIIIII -> RRRRRRRRGGGGGGGGGBBBBBBBB
 void Texture2D::convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
@@ -278,24 +480,13 @@ void Texture2D::convertAI88ToI8(const unsigned char* data, ssize_t dataLen, unsi
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-        *outData++ = 0xFF;            //A
-    }
+    convertPixels(data, dataLen, outData, 3, 4, convertRGB888ToRGBA8888Pixels);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void Texture2D::convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *outData++ = data[i];         //R
-        *outData++ = data[i + 1];     //G
-        *outData++ = data[i + 2];     //B
-    }
+    convertPixels(data, dataLen, outData, 4, 3, convertRGBA8888ToRGB888Pixels);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGGBBBBB
@@ -313,13 +504,7 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00FC) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 3;    //B
-    }
+    convertPixels(data, dataLen, outData, 4, 2, convertRGBA8888ToRGB565Pixels);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> AAAAAAAA
@@ -395,14 +580,7 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F0) << 8    //R
-        | (data[i + 1] & 0x00F0) << 4         //G
-        | (data[i + 2] & 0xF0)                //B
-        |  (data[i + 3] & 0xF0) >> 4;         //A
-    }
+    convertPixels(data, dataLen, outData, 4, 2, convertRGBA8888ToRGBA4444Pixels);
 }
 
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
@@ -421,14 +599,7 @@ void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
-    {
-        *out16++ = (data[i] & 0x00F8) << 8    //R
-            | (data[i + 1] & 0x00F8) << 3     //G
-            | (data[i + 2] & 0x00F8) >> 2     //B
-            |  (data[i + 3] & 0x0080) >> 7;   //A
-    }
+    convertPixels(data, dataLen, outData, 4, 2, convertRGBA8888ToRGB5A1Pixels);
 }
 // converter function end
 //////////////////////////////////////////////////////////////////////////
@@ -592,7 +763,9 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
     if (info.compressed && !Configuration::getInstance()->supportsPVRTC()
                         && !Configuration::getInstance()->supportsETC()
                         && !Configuration::getInstance()->supportsS3TC()
-                        && !Configuration::getInstance()->supportsATITC())
+                        && !Configuration::getInstance()->supportsATITC()
+                        && !Configuration::getInstance()->supportsETC2()
+                        && !Configuration::getInstance()->supportsASTC())
     {
         CCLOG("cocos2d: WARNING: PVRTC/ETC images are not supported");
         return false;
@@ -1395,6 +1568,21 @@ const char* Texture2D::getStringForFormat() const
 
         case Texture2D::PixelFormat::ATC_INTERPOLATED_ALPHA:
             return "ATC_INTERPOLATED_ALPHA";
+
+        case Texture2D::PixelFormat::ETC2_RGB:
+            return "ETC2_RGB";
+
+        case Texture2D::PixelFormat::ETC2_RGBA:
+            return "ETC2_RGBA";
+
+        case Texture2D::PixelFormat::ASTC_4x4:
+            return "ASTC_4x4";
+
+        case Texture2D::PixelFormat::ASTC_6x6:
+            return "ASTC_6x6";
+
+        case Texture2D::PixelFormat::ASTC_8x8:
+            return "ASTC_8x8";
             
         default:
             CCASSERT(false , "unrecognized pixel format");
@@ -115,6 +115,16 @@ public:
         ATC_EXPLICIT_ALPHA,
         //! ATITC-compressed texture: ATC_INTERPOLATED_ALPHA
         ATC_INTERPOLATED_ALPHA,
+        //! ETC2-compressed texture: ETC2_RGB
+        ETC2_RGB,
+        //! ETC2-compressed texture: ETC2_RGBA (EAC alpha channel)
+        ETC2_RGBA,
+        //! ASTC-compressed texture: 4x4 blocks, 8 bits per pixel
+        ASTC_4x4,
+        //! ASTC-compressed texture: 6x6 blocks, 3.56 bits per pixel
+        ASTC_6x6,
+        //! ASTC-compressed texture: 8x8 blocks, 2 bits per pixel
+        ASTC_8x8,
         //! Default texture format: AUTO
         DEFAULT = AUTO,
         
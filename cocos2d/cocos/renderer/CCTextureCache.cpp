@@ -29,6 +29,8 @@ THE SOFTWARE.
 #include "renderer/CCTextureCache.h"
 
 #include <errno.h>
+#include <algorithm>
+#include <chrono>
 #include <stack>
 #include <cctype>
 #include <list>
@@ -38,6 +40,8 @@ THE SOFTWARE.
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCJobSystem.h"
+#include "base/CCConfiguration.h"
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
@@ -49,6 +53,7 @@ using namespace std;
 NS_CC_BEGIN
 
 std::string TextureCache::s_etc1AlphaFileSuffix = "@alpha";
+bool TextureCache::s_compressedVariantsEnabled = false;
 
 // implementation TextureCache
 
@@ -62,26 +67,40 @@ std::string TextureCache::getETC1AlphaFileSuffix()
     return s_etc1AlphaFileSuffix;
 }
 
+void TextureCache::setCompressedVariantsEnabled(bool enabled)
+{
+    s_compressedVariantsEnabled = enabled;
+}
+
+bool TextureCache::isCompressedVariantsEnabled()
+{
+    return s_compressedVariantsEnabled;
+}
+
 TextureCache * TextureCache::getInstance()
 {
     return Director::getInstance()->getTextureCache();
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _asyncUploadTimeBudget(0)
+, _asyncUploadByteBudget(0)
+, _asyncUploadChunkSize(0)
 , _needQuit(false)
 , _asyncRefCount(0)
 {
+    _asyncUploadStats = AsyncUploadStats();
 }
 
 TextureCache::~TextureCache()
 {
     CCLOGINFO("deallocing TextureCache: %p", this);
 
+    while (!_asyncBatches.empty())
+        removeAsyncBatch(_asyncBatches.back().get());
+
     for (auto& texture : _textures)
         texture.second->release();
-
-    CC_SAFE_DELETE(_loadingThread);
 }
 
 void TextureCache::destroyInstance()
@@ -107,12 +126,28 @@ struct TextureCache::AsyncStruct
 public:
     AsyncStruct
     ( const std::string& fn,const std::function<void(Texture2D*)>& f,
-      const std::string& key )
+      const std::string& key, JobSystem::Priority p )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        loadSuccess(false), loaded(false), priority(p),
+        chunkSize(0), data(nullptr), dataLen(0), dataFormat(Texture2D::PixelFormat::NONE), ownsData(false),
+        texture(nullptr), uploadedRows(0),
+        previewWidth(0), previewHeight(0), decoding(false), decoded(false),
+        result(nullptr)
     {}
 
+    ~AsyncStruct()
+    {
+        if (ownsData)
+            free(data);
+        for (auto& strip : strips)
+        {
+            if (strip.data != strip.rows.data())
+                free(strip.data);
+        }
+        CC_SAFE_RELEASE(texture);
+    }
+
     std::string filename;
     std::function<void(Texture2D*)> callback;
     std::string callbackKey;
@@ -120,21 +155,89 @@ public:
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
     bool loadSuccess;
+    // set by the job which loads the image
+    std::atomic<bool> loaded;
+    JobSystem::Handle job;
+    JobSystem::Priority priority;
+    // later requests of the same image, they are loaded when this one is uploaded
+    std::vector<AsyncStruct*> followers;
+
+    // images larger than chunkSize are converted to their pixel format by the job, and uploaded by bands of rows
+    size_t chunkSize;
+    unsigned char* data;
+    ssize_t dataLen;
+    Texture2D::PixelFormat dataFormat;
+    bool ownsData;
+    Texture2D* texture;
+    int uploadedRows;
+
+    // images streamed by addImageStreamAsync: a job decodes strips of rows while there is a free strip,
+    // the GL thread uploads the decoded ones into texture in order and hands the strips back
+    struct Strip
+    {
+        Strip() : data(nullptr), dataLen(0), y(0), rowCount(0) {}
+
+        std::vector<unsigned char> rows;
+        // the rows converted to dataFormat, or rows.data()
+        unsigned char* data;
+        ssize_t dataLen;
+        int y;
+        int rowCount;
+    };
+    std::unique_ptr<ImageStripDecoder> decoder;
+    std::function<void(Texture2D*)> previewCallback;
+    std::vector<unsigned char> preview;
+    int previewWidth;
+    int previewHeight;
+    // guards the strip lists, decoding, decoded and loadSuccess once the first strip is decoded
+    std::mutex stripMutex;
+    Strip strips[2];
+    std::vector<Strip*> freeStrips;
+    std::deque<Strip*> decodedStrips;
+    // whether a job is decoding strips, and whether all the rows are decoded
+    bool decoding;
+    bool decoded;
+
+    Texture2D* result;
 };
 
+struct TextureCache::AsyncBatch
+{
+    std::string callbackKey;
+    // retained until the callback, even if they are removed from the cache
+    std::vector<Texture2D*> textures;
+    size_t pendingCount;
+    std::function<void(const std::vector<Texture2D*>&)> callback;
+    bool removed;
+};
+
+// size of the strips of the streamed images when no async upload chunk size is set
+static const size_t DEFAULT_STRIP_SIZE = 256 * 1024;
+
+// same row alignment as Texture2D::initWithMipmaps
+static GLint getUnpackAlignment(size_t bytesPerRow)
+{
+    if (bytesPerRow % 8 == 0)
+        return 8;
+    if (bytesPerRow % 4 == 0)
+        return 4;
+    if (bytesPerRow % 2 == 0)
+        return 2;
+    return 1;
+}
+
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _asyncStructQueue and schedule a job to load it (GL thread)
+ - load res and fill image data to AsyncStruct.image, then mark the AsyncStruct as loaded (JobSystem worker)
+ - on schedule callback, pop the loaded AsyncStructs from the front of _asyncStructQueue, convert image to texture, then delete AsyncStruct (GL thread)
 
- the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ the images are loaded in parallel, the callbacks are called in the order of the requests:
+ - an AsyncStruct is only popped from _asyncStructQueue once it and all the ones before are loaded
 
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in JobSystem worker, delete in GL thread(by Image instance)
 
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -142,12 +245,12 @@ public:
  How to deal add image many times?
  - At first, this situation is abnormal, we only ensure the logic is correct.
  - If the image has been loaded, the after load image call will return immediately.
- - If the image request is in queue already, there will be more than one request in queue,
- - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
+ - If the image request is in queue already, the new request doesn't load the image again,
+ it waits in queue for the texture created by the first request.
 
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+ - Convert image to texture faster than load image from disk, but a burst of large
+ images can take several frames, use setAsyncUploadTimeBudget to spread them.
 
  Call unbindImageAsync(path) to prevent the call to the callback when the
  texture is loaded.
@@ -159,17 +262,16 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not add an AsyncStruct to _asyncStructQueue and schedule a job to load it (GL thread)
+ - load res and fill image data to AsyncStruct.image, then mark the AsyncStruct as loaded (JobSystem worker)
+ - on schedule callback, pop the loaded AsyncStructs from the front of _asyncStructQueue, convert image to texture, then delete AsyncStruct (GL thread)
  
- the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
+ the images are loaded in parallel, the callbacks are called in the order of the requests:
+ - an AsyncStruct is only popped from _asyncStructQueue once it and all the ones before are loaded
  
  the object's life time:
  - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
+ - image data: new in JobSystem worker, delete in GL thread(by Image instance)
  
  Note:
  - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
@@ -177,12 +279,12 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  How to deal add image many times?
  - At first, this situation is abnormal, we only ensure the logic is correct.
  - If the image has been loaded, the after load image call will return immediately.
- - If the image request is in queue already, there will be more than one request in queue,
- - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
+ - If the image request is in queue already, the new request doesn't load the image again,
+ it waits in queue for the texture created by the first request.
  
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+ - Convert image to texture faster than load image from disk, but a burst of large
+ images can take several frames, use setAsyncUploadTimeBudget to spread them.
 
  The callbackKey allows to unbind the callback in cases where the loading of
  path is requested by several sources simultaneously. Each source can then
@@ -190,10 +292,29 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbindImageAsync(path) would be ambiguous.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync(path, callback, callbackKey, JobSystem::Priority::NORMAL);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, JobSystem::Priority priority)
+{
+    queueImageAsync(path, callback, nullptr, callbackKey, priority, false);
+}
+
+void TextureCache::addImageStreamAsync(const std::string& path, const std::function<void(Texture2D*)>& callback,
+                                       const std::function<void(Texture2D*)>& previewCallback, const std::string& callbackKey,
+                                       JobSystem::Priority priority)
+{
+    queueImageAsync(path, callback, previewCallback, callbackKey, priority, true);
+}
+
+void TextureCache::queueImageAsync(const std::string& path, const std::function<void(Texture2D*)>& callback,
+                                   const std::function<void(Texture2D*)>& previewCallback, const std::string& callbackKey,
+                                   JobSystem::Priority priority, bool stream)
 {
     Texture2D *texture = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = fullPathForImage(path);
 
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
@@ -211,13 +332,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
-    // lazy init
-    if (_loadingThread == nullptr)
-    {
-        // create a new thread to load images
-        _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
-    }
+    _needQuit = false;
 
     if (0 == _asyncRefCount)
     {
@@ -228,17 +343,94 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     // generate async struct
     AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey, priority);
+    data->chunkSize = _asyncUploadChunkSize;
+    data->previewCallback = previewCallback;
     
-    // add async struct into queue
+    // add async struct into queue, and load the image on the job system
     _asyncStructQueue.push_back(data);
-    std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
-    _sleepCondition.notify_one();
+    auto loading = _asyncLoadingStructs.find(fullpath);
+    if (loading != _asyncLoadingStructs.end())
+    {
+        // the image is loading for a previous request, which creates the texture, upload it first
+        AsyncStruct* source = loading->second;
+        source->followers.push_back(data);
+        if ((int)priority < (int)source->priority)
+            source->priority = priority;
+    }
+    else
+    {
+        _asyncLoadingStructs.emplace(fullpath, data);
+        data->job = JobSystem::getInstance()->schedule(std::bind(stream ? &TextureCache::loadImageStream : &TextureCache::loadImage, this, data), priority);
+    }
+}
+
+void TextureCache::addImagesAsync(const std::vector<std::string>& paths, const std::function<void(const std::vector<Texture2D*>&)>& callback, const std::string& callbackKey, JobSystem::Priority priority)
+{
+    auto batch = std::make_shared<AsyncBatch>();
+    batch->callbackKey = callbackKey;
+    batch->textures.resize(paths.size(), nullptr);
+    batch->pendingCount = paths.size() + 1;
+    batch->callback = callback;
+    batch->removed = false;
+    _asyncBatches.push_back(batch);
+
+    auto onLoaded = [this, batch]() {
+        if (batch->removed || --batch->pendingCount > 0)
+            return;
+
+        // the batch is done, unbinding its key from the callback must not release the textures
+        std::vector<Texture2D*> textures;
+        textures.swap(batch->textures);
+        auto callback = std::move(batch->callback);
+        removeAsyncBatch(batch.get());
+
+        if (callback)
+            callback(textures);
+        for (auto texture : textures)
+            CC_SAFE_RELEASE(texture);
+    };
+
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        addImageAsync(paths[i], [batch, i, onLoaded](Texture2D* texture) {
+            if (batch->removed)
+                return;
+            CC_SAFE_RETAIN(texture);
+            batch->textures[i] = texture;
+            onLoaded();
+        }, callbackKey, priority);
+    }
+
+    // the images in cache already are handed over immediately, call the callback once all are requested
+    onLoaded();
+}
+
+void TextureCache::removeAsyncBatch(AsyncBatch* batch)
+{
+    if (batch->removed)
+        return;
+
+    batch->removed = true;
+    for (auto& texture : batch->textures)
+        CC_SAFE_RELEASE_NULL(texture);
+
+    auto it = std::find_if(_asyncBatches.begin(), _asyncBatches.end(), [batch](const std::shared_ptr<AsyncBatch>& item) {
+        return item.get() == batch;
+    });
+    if (it != _asyncBatches.end())
+        _asyncBatches.erase(it);
 }
 
 void TextureCache::unbindImageAsync(const std::string& callbackKey)
 {
+    // the requests of a cancelled batch never complete it, release the textures it has got so far
+    for (size_t i = _asyncBatches.size(); i > 0; --i)
+    {
+        if (_asyncBatches[i - 1]->callbackKey == callbackKey)
+            removeAsyncBatch(_asyncBatches[i - 1].get());
+    }
+
     if (_asyncStructQueue.empty())
     {
         return;
@@ -249,12 +441,16 @@ void TextureCache::unbindImageAsync(const std::string& callbackKey)
         if (asyncStruct->callbackKey == callbackKey)
         {
             asyncStruct->callback = nullptr;
+            asyncStruct->previewCallback = nullptr;
         }
     }
 }
 
 void TextureCache::unbindAllImageAsync()
 {
+    while (!_asyncBatches.empty())
+        removeAsyncBatch(_asyncBatches.back().get());
+
     if (_asyncStructQueue.empty())
     {
         return;
@@ -263,125 +459,425 @@ void TextureCache::unbindAllImageAsync()
     for (auto& asyncStruct : _asyncStructQueue)
     {
         asyncStruct->callback = nullptr;
+        asyncStruct->previewCallback = nullptr;
     }
 }
 
-void TextureCache::loadImage()
+void TextureCache::loadImage(AsyncStruct* asyncStruct)
 {
-    AsyncStruct *asyncStruct = nullptr;
+    if (!_needQuit)
+    {
+        // load image
+        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+
+        // ETC1 ALPHA supports.
+        if (asyncStruct->loadSuccess && (asyncStruct->image.getFileType() == Image::Format::ETC || asyncStruct->image.getRenderFormat() == Texture2D::PixelFormat::ETC)
+            && !s_etc1AlphaFileSuffix.empty())
+        { // check whether alpha texture exists & load it
+            auto alphaFile = asyncStruct->filename + s_etc1AlphaFileSuffix;
+            if (FileUtils::getInstance()->isFileExist(alphaFile))
+                asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
+        }
+
+        // large images are uploaded by bands, convert them here as Texture2D::initWithImage would
+        Image* image = &asyncStruct->image;
+        if (asyncStruct->loadSuccess && asyncStruct->chunkSize > 0 && (size_t)image->getDataLen() > asyncStruct->chunkSize
+            && !image->isCompressed() && image->getNumberOfMipmaps() <= 1)
+        {
+            const Texture2D::PixelFormat format = asyncStruct->pixelFormat;
+            const Texture2D::PixelFormat pixelFormat = (format == Texture2D::PixelFormat::NONE || format == Texture2D::PixelFormat::AUTO) ? image->getRenderFormat() : format;
+            asyncStruct->dataFormat = Texture2D::convertDataToFormat(image->getData(), image->getDataLen(), image->getRenderFormat(), pixelFormat, &asyncStruct->data, &asyncStruct->dataLen);
+            asyncStruct->ownsData = asyncStruct->data != image->getData();
+        }
+    }
+
+    asyncStruct->loaded.store(true, std::memory_order_release);
+}
+
+void TextureCache::loadImageStream(AsyncStruct* asyncStruct)
+{
+    if (!_needQuit)
+    {
+        std::unique_ptr<ImageStripDecoder> decoder(new (std::nothrow) ImageStripDecoder());
+        if (decoder && decoder->initWithImageFile(asyncStruct->filename))
+        {
+            if (asyncStruct->previewCallback)
+            {
+                decoder->decodePreview(asyncStruct->preview, asyncStruct->previewWidth, asyncStruct->previewHeight);
+            }
+            asyncStruct->decoder = std::move(decoder);
+            asyncStruct->loadSuccess = true;
+            asyncStruct->freeStrips = { &asyncStruct->strips[1], &asyncStruct->strips[0] };
+            asyncStruct->decoding = true;
+            decodeImageStrips(asyncStruct);
+            return;
+        }
+    }
+
+    // the images which can't be decoded by rows are loaded whole
+    loadImage(asyncStruct);
+}
+
+void TextureCache::decodeImageStrips(AsyncStruct* asyncStruct)
+{
+    ImageStripDecoder* decoder = asyncStruct->decoder.get();
+    const size_t bytesPerRow = decoder->getBytesPerRow();
+    const size_t stripSize = asyncStruct->chunkSize > 0 ? asyncStruct->chunkSize : DEFAULT_STRIP_SIZE;
+    const int stripRows = std::max(1, (int)(stripSize / bytesPerRow));
+    const Texture2D::PixelFormat format = asyncStruct->pixelFormat;
+    const Texture2D::PixelFormat pixelFormat = (format == Texture2D::PixelFormat::NONE || format == Texture2D::PixelFormat::AUTO) ? decoder->getRenderFormat() : format;
+
     while (!_needQuit)
     {
-        std::unique_lock<std::mutex> ul(_requestMutex);
-        // pop an AsyncStruct from request queue
-        if (_requestQueue.empty())
+        AsyncStruct::Strip* strip = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+            if (asyncStruct->freeStrips.empty())
+            {
+                // the GL thread schedules the next job when it hands a strip back
+                asyncStruct->decoding = false;
+                return;
+            }
+            strip = asyncStruct->freeStrips.back();
+            asyncStruct->freeStrips.pop_back();
+        }
+
+        strip->y = decoder->getDecodedRows();
+        strip->rowCount = std::min(stripRows, decoder->getHeight() - strip->y);
+        strip->rows.resize(strip->rowCount * bytesPerRow);
+        const bool success = decoder->decodeRows(strip->rows.data(), strip->rowCount) == strip->rowCount;
+        Texture2D::PixelFormat dataFormat = Texture2D::PixelFormat::NONE;
+        if (success)
         {
-            asyncStruct = nullptr;
+            dataFormat = Texture2D::convertDataToFormat(strip->rows.data(), strip->rows.size(), decoder->getRenderFormat(), pixelFormat, &strip->data, &strip->dataLen);
+        }
+
+        std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+        if (success)
+        {
+            asyncStruct->dataFormat = dataFormat;
+            asyncStruct->decodedStrips.push_back(strip);
+            asyncStruct->decoded = decoder->getDecodedRows() == decoder->getHeight();
         }
         else
         {
-            asyncStruct = _requestQueue.front();
-            _requestQueue.pop_front();
+            asyncStruct->freeStrips.push_back(strip);
+            asyncStruct->loadSuccess = false;
+        }
+        asyncStruct->loaded.store(true, std::memory_order_release);
+        if (!success || asyncStruct->decoded)
+        {
+            asyncStruct->decoding = false;
+            return;
         }
+    }
+
+    std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+    asyncStruct->decoding = false;
+}
 
-        if (nullptr == asyncStruct) {
-            if (_needQuit) {
+std::deque<TextureCache::AsyncStruct*>::iterator TextureCache::getNextAsyncStruct()
+{
+    // the first request of the highest priority whose image is loaded, the requests of a priority are uploaded in order
+    for (int priority = (int)JobSystem::Priority::HIGH; priority <= (int)JobSystem::Priority::LOW; ++priority)
+    {
+        for (auto it = _asyncStructQueue.begin(); it != _asyncStructQueue.end(); ++it)
+        {
+            if ((int)(*it)->priority == priority)
+            {
+                if ((*it)->loaded.load(std::memory_order_acquire))
+                    return it;
                 break;
             }
-            _sleepCondition.wait(ul);
-            continue;
         }
-        ul.unlock();
+    }
+    return _asyncStructQueue.end();
+}
 
-        // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+size_t TextureCache::getAsyncUploadSize(AsyncStruct* asyncStruct) const
+{
+    if (asyncStruct->decoder)
+    {
+        std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+        return asyncStruct->decodedStrips.empty() ? 0 : asyncStruct->decodedStrips.front()->dataLen;
+    }
 
-        // ETC1 ALPHA supports.
-        if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
-        { // check whether alpha texture exists & load it
-            auto alphaFile = asyncStruct->filename + s_etc1AlphaFileSuffix;
-            if (FileUtils::getInstance()->isFileExist(alphaFile))
-                asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
-        }
-        // push the asyncStruct to response queue
-        _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
-        _responseMutex.unlock();
+    if (!asyncStruct->loadSuccess || _textures.find(asyncStruct->filename) != _textures.end())
+        return 0;
+    if (asyncStruct->data)
+    {
+        const int height = asyncStruct->image.getHeight();
+        const size_t bytesPerRow = asyncStruct->dataLen / height;
+        const int rows = std::max(1, (int)(asyncStruct->chunkSize / bytesPerRow));
+        return std::min(rows, height - asyncStruct->uploadedRows) * bytesPerRow;
     }
+    return asyncStruct->image.getDataLen() + asyncStruct->imageAlpha.getDataLen();
 }
 
-void TextureCache::addImageAsyncCallBack(float /*dt*/)
+bool TextureCache::uploadAsyncStruct(AsyncStruct* asyncStruct, size_t& uploadedBytes)
 {
-    Texture2D *texture = nullptr;
-    AsyncStruct *asyncStruct = nullptr;
-    while (true)
+    uploadedBytes = 0;
+
+    // check the image has been convert to texture or not
+    auto it = _textures.find(asyncStruct->filename);
+    if (it != _textures.end())
     {
-        // pop an AsyncStruct from response queue
-        _responseMutex.lock();
-        if (_responseQueue.empty())
+        if (asyncStruct->decoder)
         {
-            asyncStruct = nullptr;
+            // stop decoding the strips
+            JobSystem::getInstance()->wait(asyncStruct->job);
         }
-        else
+        asyncStruct->result = it->second;
+        return true;
+    }
+
+    if (asyncStruct->decoder)
+    {
+        return uploadImageStrip(asyncStruct, uploadedBytes);
+    }
+
+    if (!asyncStruct->loadSuccess)
+    {
+        asyncStruct->result = nullptr;
+        CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
+        return true;
+    }
+
+    Image* image = &(asyncStruct->image);
+    Texture2D* texture = nullptr;
+    if (asyncStruct->data)
+    {
+        const int width = image->getWidth();
+        const int height = image->getHeight();
+        const size_t bytesPerRow = asyncStruct->dataLen / height;
+
+        if (asyncStruct->texture == nullptr)
         {
-            asyncStruct = _responseQueue.front();
-            _responseQueue.pop_front();
+            const int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+            if (width > maxTextureSize || height > maxTextureSize)
+            {
+                CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", width, height, maxTextureSize, maxTextureSize);
+                asyncStruct->result = nullptr;
+                return true;
+            }
 
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
+            // allocate the texture, the rows are uploaded by the next steps
+            MipmapInfo mipmap;
+            mipmap.address = nullptr;
+            mipmap.len = static_cast<int>(asyncStruct->dataLen);
+            asyncStruct->texture = new (std::nothrow) Texture2D();
+            asyncStruct->texture->initWithMipmaps(&mipmap, 1, asyncStruct->dataFormat, width, height);
+            asyncStruct->uploadedRows = 0;
         }
-        _responseMutex.unlock();
 
-        if (nullptr == asyncStruct) {
-            break;
+        const int rows = std::min(std::max(1, (int)(asyncStruct->chunkSize / bytesPerRow)), height - asyncStruct->uploadedRows);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, getUnpackAlignment(bytesPerRow));
+        asyncStruct->texture->updateWithData(asyncStruct->data + asyncStruct->uploadedRows * bytesPerRow, 0, asyncStruct->uploadedRows, width, rows);
+        asyncStruct->uploadedRows += rows;
+        uploadedBytes = rows * bytesPerRow;
+
+        if (asyncStruct->uploadedRows < height)
+            return false;
+
+        texture = asyncStruct->texture;
+        asyncStruct->texture = nullptr;
+        texture->_filePath = image->getFilePath();
+        texture->_hasPremultipliedAlpha = image->hasPremultipliedAlpha();
+    }
+    else
+    {
+        // generate texture in render thread
+        texture = new (std::nothrow) Texture2D();
+        texture->initWithImage(image, asyncStruct->pixelFormat);
+        uploadedBytes = image->getDataLen();
+    }
+
+    //parse 9-patch info
+    this->parseNinePatchImage(image, texture, asyncStruct->filename);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // cache the texture file name
+    VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+#endif
+    // cache the texture. retain it, since it is added in the map
+    _textures.emplace(asyncStruct->filename, texture);
+    texture->retain();
+
+    texture->autorelease();
+    // ETC1 ALPHA supports.
+    if (asyncStruct->imageAlpha.getFileType() == Image::Format::ETC) {
+        auto alphaTexture = new(std::nothrow) Texture2D();
+        if(alphaTexture != nullptr && alphaTexture->initWithImage(&asyncStruct->imageAlpha, asyncStruct->pixelFormat)) {
+            texture->setAlphaTexture(alphaTexture);
         }
+        CC_SAFE_RELEASE(alphaTexture);
+        uploadedBytes += asyncStruct->imageAlpha.getDataLen();
+    }
+
+    asyncStruct->result = texture;
+    return true;
+}
+
+bool TextureCache::uploadImageStrip(AsyncStruct* asyncStruct, size_t& uploadedBytes)
+{
+    ImageStripDecoder* decoder = asyncStruct->decoder.get();
+    const int width = decoder->getWidth();
+    const int height = decoder->getHeight();
 
-        // check the image has been convert to texture or not
-        auto it = _textures.find(asyncStruct->filename);
-        if (it != _textures.end())
+    AsyncStruct::Strip* strip = nullptr;
+    bool loadSuccess = false;
+    {
+        std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+        loadSuccess = asyncStruct->loadSuccess;
+        if (!asyncStruct->decodedStrips.empty())
         {
-            texture = it->second;
+            strip = asyncStruct->decodedStrips.front();
+            asyncStruct->decodedStrips.pop_front();
         }
-        else
+        else if (loadSuccess)
+        {
+            // wait for the job decoding the next strip
+            asyncStruct->loaded.store(false, std::memory_order_release);
+            return false;
+        }
+    }
+
+    if (!loadSuccess)
+    {
+        // the job stopped on the corrupted strip
+        CCLOG("cocos2d: failed to decode the rows of %s", asyncStruct->filename.c_str());
+        CC_SAFE_RELEASE_NULL(asyncStruct->texture);
+        asyncStruct->result = nullptr;
+        return true;
+    }
+
+    if (asyncStruct->texture == nullptr)
+    {
+        const int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+        if (width > maxTextureSize || height > maxTextureSize)
+        {
+            CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", width, height, maxTextureSize, maxTextureSize);
+            JobSystem::getInstance()->wait(asyncStruct->job);
+            asyncStruct->result = nullptr;
+            return true;
+        }
+
+        // allocate the texture, the strips are uploaded as they are decoded
+        MipmapInfo mipmap;
+        mipmap.address = nullptr;
+        mipmap.len = static_cast<int>(strip->dataLen / strip->rowCount * height);
+        asyncStruct->texture = new (std::nothrow) Texture2D();
+        asyncStruct->texture->initWithMipmaps(&mipmap, 1, asyncStruct->dataFormat, width, height);
+        asyncStruct->uploadedRows = 0;
+
+        if (!asyncStruct->preview.empty() && asyncStruct->previewCallback)
         {
-            // convert image to texture
-            if (asyncStruct->loadSuccess)
+            auto preview = new (std::nothrow) Texture2D();
+            if (preview && preview->initWithData(asyncStruct->preview.data(), asyncStruct->preview.size(), decoder->getRenderFormat(),
+                                                 asyncStruct->previewWidth, asyncStruct->previewHeight, Size((float)asyncStruct->previewWidth, (float)asyncStruct->previewHeight)))
+            {
+                preview->autorelease();
+                asyncStruct->previewCallback(preview);
+            }
+            else
             {
-                Image* image = &(asyncStruct->image);
-                // generate texture in render thread
-                texture = new (std::nothrow) Texture2D();
+                CC_SAFE_RELEASE(preview);
+            }
+        }
+        std::vector<unsigned char>().swap(asyncStruct->preview);
+    }
+
+    const size_t bytesPerRow = strip->dataLen / strip->rowCount;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, getUnpackAlignment(bytesPerRow));
+    asyncStruct->texture->updateWithData(strip->data, 0, strip->y, width, strip->rowCount);
+    asyncStruct->uploadedRows += strip->rowCount;
+    uploadedBytes = strip->dataLen;
+    if (strip->data != strip->rows.data())
+    {
+        free(strip->data);
+    }
+    strip->data = nullptr;
+
+    {
+        // hand the strip back, and decode the next ones if the job stopped for lack of strips
+        std::lock_guard<std::mutex> lock(asyncStruct->stripMutex);
+        asyncStruct->freeStrips.push_back(strip);
+        if (!asyncStruct->decoding && !asyncStruct->decoded)
+        {
+            asyncStruct->decoding = true;
+            asyncStruct->job = JobSystem::getInstance()->schedule(std::bind(&TextureCache::decodeImageStrips, this, asyncStruct), asyncStruct->priority);
+        }
+        asyncStruct->loaded.store(!asyncStruct->decodedStrips.empty() || asyncStruct->uploadedRows == height, std::memory_order_release);
+    }
+
+    if (asyncStruct->uploadedRows < height)
+        return false;
+
+    Texture2D* texture = asyncStruct->texture;
+    asyncStruct->texture = nullptr;
+    texture->_filePath = asyncStruct->filename;
+    texture->_hasPremultipliedAlpha = decoder->hasPremultipliedAlpha();
 
-                texture->initWithImage(image, asyncStruct->pixelFormat);
-                //parse 9-patch info
-                this->parseNinePatchImage(image, texture, asyncStruct->filename);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
-                // cache the texture file name
-                VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
+    // cache the texture file name
+    VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
 #endif
-                // cache the texture. retain it, since it is added in the map
-                _textures.emplace(asyncStruct->filename, texture);
-                texture->retain();
-
-                texture->autorelease();
-                // ETC1 ALPHA supports.
-                if (asyncStruct->imageAlpha.getFileType() == Image::Format::ETC) {
-                    auto alphaTexture = new(std::nothrow) Texture2D();
-                    if(alphaTexture != nullptr && alphaTexture->initWithImage(&asyncStruct->imageAlpha, asyncStruct->pixelFormat)) {
-                        texture->setAlphaTexture(alphaTexture);
-                    }
-                    CC_SAFE_RELEASE(alphaTexture);
-                }
-            }
-            else {
-                texture = nullptr;
-                CCLOG("cocos2d: failed to call TextureCache::addImageAsync(%s)", asyncStruct->filename.c_str());
-            }
+    // cache the texture. retain it, since it is added in the map
+    _textures.emplace(asyncStruct->filename, texture);
+    texture->retain();
+    texture->autorelease();
+
+    asyncStruct->result = texture;
+    return true;
+}
+
+void TextureCache::addImageAsyncCallBack(float /*dt*/)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto timeBudget = std::chrono::duration<float>(_asyncUploadTimeBudget);
+    size_t uploadedBytes = 0;
+
+    while (true)
+    {
+        // the images are loaded in parallel, hand them over by priority, then in the order of the requests
+        auto it = getNextAsyncStruct();
+        if (it == _asyncStructQueue.end())
+        {
+            break;
+        }
+        AsyncStruct *asyncStruct = *it;
+
+        // leave the other uploads to the next frames once the budget is spent
+        if (uploadedBytes > 0)
+        {
+            if (_asyncUploadTimeBudget > 0 && std::chrono::steady_clock::now() - start >= timeBudget)
+                break;
+            if (_asyncUploadByteBudget > 0 && uploadedBytes + getAsyncUploadSize(asyncStruct) > _asyncUploadByteBudget)
+                break;
+        }
+
+        size_t bytes = 0;
+        const bool done = uploadAsyncStruct(asyncStruct, bytes);
+        uploadedBytes += bytes;
+        if (!done)
+        {
+            continue;
+        }
+
+        _asyncStructQueue.erase(it);
+        auto loading = _asyncLoadingStructs.find(asyncStruct->filename);
+        if (loading != _asyncLoadingStructs.end() && loading->second == asyncStruct)
+        {
+            _asyncLoadingStructs.erase(loading);
+        }
+        for (auto follower : asyncStruct->followers)
+        {
+            follower->loaded = true;
         }
 
         // call callback function
         if (asyncStruct->callback)
         {
-            (asyncStruct->callback)(texture);
+            (asyncStruct->callback)(asyncStruct->result);
         }
 
         // release the asyncStruct
@@ -389,6 +885,13 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         --_asyncRefCount;
     }
 
+    const float uploadTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _asyncUploadStats.queuedCount = _asyncStructQueue.size();
+    _asyncUploadStats.uploadedBytes = uploadedBytes;
+    _asyncUploadStats.uploadTime = uploadTime;
+    _asyncUploadStats.peakUploadTime = std::max(_asyncUploadStats.peakUploadTime, uploadTime);
+    _asyncUploadStats.totalUploadedBytes += uploadedBytes;
+
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
@@ -403,7 +906,7 @@ Texture2D * TextureCache::addImage(const std::string &path)
     // MUTEX:
     // Needed since addImageAsync calls this method from a different thread
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
+    std::string fullpath = fullPathForImage(path);
     if (fullpath.size() == 0)
     {
         return nullptr;
@@ -435,8 +938,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
                 _textures.emplace(fullpath, texture);
 
                 //-- ANDROID ETC1 ALPHA SUPPORTS.
-                std::string alphaFullPath = path + s_etc1AlphaFileSuffix;
-                if (image->getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty() && FileUtils::getInstance()->isFileExist(alphaFullPath))
+                std::string alphaFullPath = fullpath + s_etc1AlphaFileSuffix;
+                if ((image->getFileType() == Image::Format::ETC || image->getRenderFormat() == Texture2D::PixelFormat::ETC)
+                    && !s_etc1AlphaFileSuffix.empty() && FileUtils::getInstance()->isFileExist(alphaFullPath))
                 {
                     Image alphaImage;
                     if (alphaImage.initWithImageFile(alphaFullPath))
@@ -466,6 +970,34 @@ Texture2D * TextureCache::addImage(const std::string &path)
     return texture;
 }
 
+std::string TextureCache::fullPathForImage(const std::string& path) const
+{
+    auto fileUtils = FileUtils::getInstance();
+    if (s_compressedVariantsEnabled)
+    {
+        const std::string extension = fileUtils->getFileExtension(path);
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".webp")
+        {
+            auto configuration = Configuration::getInstance();
+            const std::string stem = path.substr(0, path.length() - extension.length());
+            // the smallest format first, ETC1 has no alpha and needs a second texture
+            const std::pair<bool, const char*> variants[] = {
+                { configuration->supportsASTC(), ".astc.ktx" },
+                { configuration->supportsETC2(), ".etc2.ktx" },
+                { configuration->supportsETC(), ".etc1.ktx" },
+            };
+            for (const auto& variant : variants)
+            {
+                if (variant.first && fileUtils->isFileExist(stem + variant.second))
+                {
+                    return fileUtils->fullPathForFilename(stem + variant.second);
+                }
+            }
+        }
+    }
+    return fileUtils->fullPathForFilename(path);
+}
+
 void TextureCache::parseNinePatchImage(cocos2d::Image *image, cocos2d::Texture2D *texture, const std::string& path)
 {
     if (NinePatchImageParser::isNinePatchImage(path))
@@ -526,7 +1058,7 @@ bool TextureCache::reloadTexture(const std::string& fileName)
     Texture2D * texture = nullptr;
     Image * image = nullptr;
 
-    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(fileName);
+    std::string fullpath = fullPathForImage(fileName);
     if (fullpath.size() == 0)
     {
         return false;
@@ -611,7 +1143,7 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     auto it = _textures.find(key);
 
     if (it == _textures.end()) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = fullPathForImage(textureKeyName);
         it = _textures.find(key);
     }
 
@@ -627,7 +1159,7 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     auto it = _textures.find(key);
 
     if (it == _textures.end()) {
-        key = FileUtils::getInstance()->fullPathForFilename(textureKeyName);
+        key = fullPathForImage(textureKeyName);
         it = _textures.find(key);
     }
 
@@ -659,12 +1191,12 @@ std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
 
 void TextureCache::waitForQuit()
 {
-    // notify sub thread to quick
-    std::unique_lock<std::mutex> ul(_requestMutex);
+    // the jobs which did not start skip loading, wait for the running ones
     _needQuit = true;
-    _sleepCondition.notify_one();
-    ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    for (auto asyncStruct : _asyncStructQueue)
+    {
+        JobSystem::getInstance()->wait(asyncStruct->job);
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #ifndef __CCTEXTURE_CACHE_H__
 #define __CCTEXTURE_CACHE_H__
 
+#include <atomic>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
@@ -36,8 +37,10 @@ THE SOFTWARE.
 #include <string>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 
 #include "base/CCRef.h"
+#include "base/CCJobSystem.h"
 #include "renderer/CCTexture2D.h"
 #include "platform/CCImage.h"
 
@@ -87,6 +90,15 @@ public:
     static void setETC1AlphaFileSuffix(const std::string& suffix);
     static std::string getETC1AlphaFileSuffix();
 
+    /** Enables or disables the GPU compressed variants of the images, disabled by default.
+     * When enabled, an image "name.png" (or .jpg, .jpeg, .webp) is replaced by the first of
+     * "name.astc.ktx", "name.etc2.ktx" and "name.etc1.ktx" that the GPU supports and that exists.
+     * The variants are made by tools/compress_textures.py, an ETC1 variant takes its alpha channel
+     * from the "@alpha" file next to it. The texture is cached under the full path of the variant.
+     */
+    static void setCompressedVariantsEnabled(bool enabled);
+    static bool isCompressedVariantsEnabled();
+
 public:
     /**
      * @js ctor
@@ -127,6 +139,90 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Loads an image asynchronously with a priority.
+    * The images of the requests with a higher priority are loaded and uploaded first. The textures of requests with
+    * the same priority are handed over in the order of the requests.
+    * @param path The file path.
+    * @param callback A callback function invoked from the main thread with the texture.
+    * @param callbackKey The key to unbind the callback with unbindImageAsync.
+    * @param priority The priority of the request.
+    * @since v3.17
+    */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, JobSystem::Priority priority);
+
+    /** Loads several images asynchronously, the images are decoded in parallel.
+    * The callback is called once, from the main thread, when all the textures are created.
+    * Images which are loaded or requested already are not loaded again.
+    * @param paths The file paths.
+    * @param callback A callback function invoked with the textures, in the order of paths. A texture is nullptr if its image failed to load.
+    * @param callbackKey The key to unbind the callback with unbindImageAsync, unbinding it cancels the callback.
+    * @since v3.17
+    */
+    void addImagesAsync(const std::vector<std::string>& paths, const std::function<void(const std::vector<Texture2D*>&)>& callback, const std::string& callbackKey = "",
+                        JobSystem::Priority priority = JobSystem::Priority::NORMAL);
+
+    /** Loads a large png or jpeg image asynchronously by strips of rows, so that it never is in memory whole.
+    * A job decodes the strips one after the other, each one is uploaded into the texture as soon as it is decoded,
+    * within the upload budgets. At most two strips, of the async upload chunk size (256KB if it is 0), are in memory.
+    * Interlaced pngs and the other formats are loaded whole, as addImageAsync does.
+    * @param path The file path.
+    * @param callback A callback function invoked from the main thread with the texture, once all its rows are uploaded.
+    * @param previewCallback A callback function invoked from the main thread before the strips are uploaded, with a texture
+    * of the image 8 times smaller, which is decoded first. Only jpegs have one. The texture isn't cached. May be nullptr.
+    * @param callbackKey The key to unbind the callbacks with unbindImageAsync.
+    * @param priority The priority of the request.
+    * @since v3.17
+    */
+    void addImageStreamAsync(const std::string& path, const std::function<void(Texture2D*)>& callback,
+                             const std::function<void(Texture2D*)>& previewCallback, const std::string& callbackKey = "",
+                             JobSystem::Priority priority = JobSystem::Priority::NORMAL);
+
+    /** Sets the time spent each frame creating the textures of the images loaded asynchronously.
+    * The textures left are created in the next frames, in order. At least one texture is created per frame.
+    * @param seconds The time budget, in seconds. 0, the default, creates all the textures of the loaded images.
+    * @since v3.17
+    */
+    void setAsyncUploadTimeBudget(float seconds) { _asyncUploadTimeBudget = seconds; }
+    /** Returns the time spent each frame creating the textures of the images loaded asynchronously, in seconds. */
+    float getAsyncUploadTimeBudget() const { return _asyncUploadTimeBudget; }
+
+    /** Sets the number of bytes of image data uploaded each frame for the images loaded asynchronously.
+    * At least one texture, or one band of rows of a large image, is uploaded per frame.
+    * @param bytes The byte budget. 0, the default, doesn't limit the uploads.
+    * @since v3.17
+    */
+    void setAsyncUploadByteBudget(size_t bytes) { _asyncUploadByteBudget = bytes; }
+    /** Returns the number of bytes of image data uploaded each frame for the images loaded asynchronously. */
+    size_t getAsyncUploadByteBudget() const { return _asyncUploadByteBudget; }
+
+    /** Sets the size above which the images loaded asynchronously are uploaded by bands of rows, one band per step,
+    * so that a large image spreads over several frames with the upload budgets.
+    * Only applies to uncompressed images without mipmaps, requested after the call.
+    * @param bytes The size of a band, in bytes. 0, the default, uploads each image at once.
+    * @since v3.17
+    */
+    void setAsyncUploadChunkSize(size_t bytes) { _asyncUploadChunkSize = bytes; }
+    /** Returns the size above which the images loaded asynchronously are uploaded by bands of rows. */
+    size_t getAsyncUploadChunkSize() const { return _asyncUploadChunkSize; }
+
+    /** Counters of the uploads of the images loaded asynchronously, updated each frame while images are loading. */
+    struct AsyncUploadStats
+    {
+        /** Requests waiting for their image to be loaded or uploaded. */
+        size_t queuedCount;
+        /** Bytes uploaded in the last frame. */
+        size_t uploadedBytes;
+        /** Time spent uploading in the last frame, in milliseconds. */
+        float uploadTime;
+        /** Longest time spent uploading in a frame, in milliseconds. */
+        float peakUploadTime;
+        /** Bytes uploaded since the cache was created. */
+        uint64_t totalUploadedBytes;
+    };
+
+    /** Returns the counters of the uploads of the images loaded asynchronously. */
+    const AsyncUploadStats& getAsyncUploadStats() const { return _asyncUploadStats; }
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -220,32 +316,47 @@ public:
     void renameTextureWithKey(const std::string& srcName, const std::string& dstName);
 
 
+protected:
+    struct AsyncStruct;
+    struct AsyncBatch;
+
 private:
     void addImageAsyncCallBack(float dt);
-    void loadImage();
+    void queueImageAsync(const std::string& path, const std::function<void(Texture2D*)>& callback,
+                         const std::function<void(Texture2D*)>& previewCallback, const std::string& callbackKey,
+                         JobSystem::Priority priority, bool stream);
+    void loadImage(AsyncStruct* asyncStruct);
+    void loadImageStream(AsyncStruct* asyncStruct);
+    void decodeImageStrips(AsyncStruct* asyncStruct);
+    bool uploadImageStrip(AsyncStruct* asyncStruct, size_t& uploadedBytes);
+    std::deque<AsyncStruct*>::iterator getNextAsyncStruct();
+    size_t getAsyncUploadSize(AsyncStruct* asyncStruct) const;
+    bool uploadAsyncStruct(AsyncStruct* asyncStruct, size_t& uploadedBytes);
+    // releases the textures collected by a batch of addImagesAsync which is done or cancelled
+    void removeAsyncBatch(AsyncBatch* batch);
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    // full path of the file to load for an image, its compressed variant when there is one
+    std::string fullPathForImage(const std::string& path) const;
 public:
 protected:
-    struct AsyncStruct;
-    
-    std::thread* _loadingThread;
-
     std::deque<AsyncStruct*> _asyncStructQueue;
-    std::deque<AsyncStruct*> _requestQueue;
-    std::deque<AsyncStruct*> _responseQueue;
-
-    std::mutex _requestMutex;
-    std::mutex _responseMutex;
-    
-    std::condition_variable _sleepCondition;
+    // requests which load their image, by full path, later requests of the same image wait for them
+    std::unordered_map<std::string, AsyncStruct*> _asyncLoadingStructs;
+    // batches of addImagesAsync waiting for their textures
+    std::vector<std::shared_ptr<AsyncBatch>> _asyncBatches;
+    float _asyncUploadTimeBudget;
+    size_t _asyncUploadByteBudget;
+    size_t _asyncUploadChunkSize;
+    AsyncUploadStats _asyncUploadStats;
 
-    bool _needQuit;
+    std::atomic<bool> _needQuit;
 
     int _asyncRefCount;
 
     std::unordered_map<std::string, Texture2D*> _textures;
 
     static std::string s_etc1AlphaFileSuffix;
+    static bool s_compressedVariantsEnabled;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
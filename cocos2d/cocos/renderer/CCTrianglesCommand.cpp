@@ -38,6 +38,7 @@ TrianglesCommand::TrianglesCommand()
 ,_textureID(0)
 ,_glProgramState(nullptr)
 ,_blendType(BlendFunc::DISABLE)
+,_transformedVertices(nullptr)
 ,_alphaTextureID(0)
 {
     _type = RenderCommand::Type::TRIANGLES_COMMAND;
@@ -58,6 +59,7 @@ void TrianglesCommand::init(float globalOrder, GLuint textureID, GLProgramState*
         CCLOGERROR("Resize indexCount from %d to %d, size must be multiple times of 3", count, _triangles.indexCount);
     }
     _mv = mv;
+    _transformedVertices = nullptr;
     
     if( _textureID != textureID || _blendType.src != blendType.src || _blendType.dst != blendType.dst ||
        _glProgramState != glProgramState)
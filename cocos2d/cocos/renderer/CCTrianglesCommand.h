@@ -95,6 +95,11 @@ public:
     BlendFunc getBlendType() const { return _blendType; }
     /**Get the model view matrix.*/
     const Mat4& getModelView() const { return _mv; }
+    /**Get the vertices already transformed by the model view matrix, nullptr unless the command is replayed by a static subtree.*/
+    const V3F_C4B_T2F* getTransformedVertices() const { return _transformedVertices; }
+    /**Set the vertices already transformed by the model view matrix, they are used instead of transforming the vertices
+     until the command is initialized again.*/
+    void setTransformedVertices(const V3F_C4B_T2F* transformedVertices) { _transformedVertices = transformedVertices; }
     
 protected:
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
@@ -112,6 +117,8 @@ protected:
     Triangles _triangles;
     /**Model view matrix when rendering the triangles.*/
     Mat4 _mv;
+    /**Vertices transformed by the model view matrix, or nullptr.*/
+    const V3F_C4B_T2F* _transformedVertices;
 
     GLuint _alphaTextureID; // ANDROID ETC1 ALPHA supports.
 };
@@ -58,6 +58,7 @@ extern CC_DLL const GLchar * ccPositionTextureColor_vert;
 
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_frag;
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_vert;
+extern CC_DLL const GLchar * ccPositionTextureColor_instanced_vert;
 
 extern CC_DLL const GLchar * ccPositionTextureColorAlphaTest_frag;
 
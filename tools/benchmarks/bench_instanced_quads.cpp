@@ -0,0 +1,170 @@
+/*
+ CPU cost and upload size of the sprite quads of a frame, batched as triangles or drawn instanced.
+
+ - triangles: what Renderer::fillVerticesAndIndices does for the quad of a TrianglesCommand, the 4 vertices are
+   copied and transformed to world space, and 6 indices are written.
+ - instanced: what InstancedQuadCommand::init and Renderer::drawInstancedQuads do, 3 corners are transformed into
+   an InstancedQuadCommand::Instance, which is copied in the instance buffer.
+ - instanced with params: the same, plus the InstanceParams of the programs which read a_instanceParams0/1,
+   like the RoundedBorderInstanced shader of the puzzle pieces.
+
+ The GL upload itself isn't timed, the byte counts are those given to glBufferData.
+
+ usage: bench_instanced_quads [sprite count (10000)] [frame count (200)]
+ */
+
+#include "benchmark.h"
+
+#include <cstring>
+#include <vector>
+
+#include "base/ccTypes.h"
+#include "math/Mat4.h"
+#include "renderer/CCInstancedQuadCommand.h"
+
+USING_NS_CC;
+
+namespace {
+
+struct Sprite
+{
+    V3F_C4B_T2F_Quad quad;
+    Mat4 transform;
+    Vec4 params0;
+    Vec4 params1;
+};
+
+std::vector<Sprite> makeSprites(int count)
+{
+    benchmark::Random random;
+    std::vector<Sprite> sprites(count);
+    for (auto& sprite : sprites)
+    {
+        const float width = random.range(32, 256);
+        const float height = random.range(32, 256);
+        const float u = random.range(0, 0.5f);
+        const float v = random.range(0, 0.5f);
+        V3F_C4B_T2F_Quad& quad = sprite.quad;
+        quad.bl.vertices.set(0, 0, 0);
+        quad.br.vertices.set(width, 0, 0);
+        quad.tl.vertices.set(0, height, 0);
+        quad.tr.vertices.set(width, height, 0);
+        quad.bl.texCoords = Tex2F(u, v + 0.25f);
+        quad.br.texCoords = Tex2F(u + 0.25f, v + 0.25f);
+        quad.tl.texCoords = Tex2F(u, v);
+        quad.tr.texCoords = Tex2F(u + 0.25f, v);
+        quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = Color4B(255, 255, 255, 255);
+
+        Mat4 translation;
+        Mat4 rotation;
+        Mat4::createTranslation(random.range(0, 1920), random.range(0, 1080), 0, &translation);
+        Mat4::createRotationZ(random.range(-3.14f, 3.14f), &rotation);
+        sprite.transform = translation * rotation;
+        sprite.params0.set(8, 8, 8, 8);
+        sprite.params1.set(1, 0, 1, 0);
+    }
+    return sprites;
+}
+
+// Renderer::fillVerticesAndIndices
+size_t fillTriangles(const std::vector<Sprite>& sprites, std::vector<V3F_C4B_T2F>& vertices, std::vector<GLushort>& indices)
+{
+    static const GLushort quadIndices[] = { 0, 1, 2, 3, 2, 1 };
+    size_t filledVertex = 0;
+    size_t filledIndex = 0;
+    for (const auto& sprite : sprites)
+    {
+        memcpy(&vertices[filledVertex], &sprite.quad, sizeof(sprite.quad));
+        for (int i = 0; i < 4; ++i)
+            sprite.transform.transformPoint(&vertices[filledVertex + i].vertices);
+        for (int i = 0; i < 6; ++i)
+            indices[filledIndex + i] = (GLushort)((filledVertex + quadIndices[i]) & 0xffff);
+        filledVertex += 4;
+        filledIndex += 6;
+    }
+    return filledVertex * sizeof(V3F_C4B_T2F) + filledIndex * sizeof(GLushort);
+}
+
+// InstancedQuadCommand::init, then the copy of Renderer::drawInstancedQuads
+size_t fillInstances(const std::vector<Sprite>& sprites, bool withParams, std::vector<InstancedQuadCommand::Instance>& instances,
+                     std::vector<InstancedQuadCommand::InstanceParams>& instanceParams)
+{
+    instances.clear();
+    instanceParams.clear();
+    for (const auto& sprite : sprites)
+    {
+        const V3F_C4B_T2F_Quad& quad = sprite.quad;
+        Vec3 bl = quad.bl.vertices;
+        Vec3 br = quad.br.vertices;
+        Vec3 tl = quad.tl.vertices;
+        sprite.transform.transformPoint(&bl);
+        sprite.transform.transformPoint(&br);
+        sprite.transform.transformPoint(&tl);
+
+        const Tex2F& blUV = quad.bl.texCoords;
+        const Tex2F& brUV = quad.br.texCoords;
+        const Tex2F& tlUV = quad.tl.texCoords;
+
+        InstancedQuadCommand::Instance instance;
+        instance.origin[0] = bl.x;
+        instance.origin[1] = bl.y;
+        instance.origin[2] = blUV.u;
+        instance.origin[3] = blUV.v;
+        instance.axes[0] = br.x - bl.x;
+        instance.axes[1] = br.y - bl.y;
+        instance.axes[2] = tl.x - bl.x;
+        instance.axes[3] = tl.y - bl.y;
+        instance.texCoordAxes[0] = brUV.u - blUV.u;
+        instance.texCoordAxes[1] = brUV.v - blUV.v;
+        instance.texCoordAxes[2] = tlUV.u - blUV.u;
+        instance.texCoordAxes[3] = tlUV.v - blUV.v;
+        instance.color = quad.bl.colors;
+        instances.push_back(instance);
+
+        if (withParams)
+        {
+            InstancedQuadCommand::InstanceParams params;
+            memcpy(params.params0, &sprite.params0.x, sizeof(params.params0));
+            memcpy(params.params1, &sprite.params1.x, sizeof(params.params1));
+            instanceParams.push_back(params);
+        }
+    }
+    return instances.size() * sizeof(instances[0]) + instanceParams.size() * sizeof(instanceParams[0]);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int spriteCount = benchmark::intArgument(argc, argv, 1, 10000);
+    const int frameCount = benchmark::intArgument(argc, argv, 2, 200);
+    const std::vector<Sprite> sprites = makeSprites(spriteCount);
+
+    std::vector<V3F_C4B_T2F> vertices(spriteCount * 4);
+    std::vector<GLushort> indices(spriteCount * 6);
+    std::vector<InstancedQuadCommand::Instance> instances;
+    std::vector<InstancedQuadCommand::InstanceParams> instanceParams;
+    instances.reserve(spriteCount);
+    instanceParams.reserve(spriteCount);
+
+    size_t trianglesBytes = 0;
+    const double trianglesTime = benchmark::measureFrames(frameCount, [&](int) {
+        trianglesBytes = fillTriangles(sprites, vertices, indices);
+    });
+    size_t instancedBytes = 0;
+    const double instancedTime = benchmark::measureFrames(frameCount, [&](int) {
+        instancedBytes = fillInstances(sprites, false, instances, instanceParams);
+    });
+    size_t paramsBytes = 0;
+    const double paramsTime = benchmark::measureFrames(frameCount, [&](int) {
+        paramsBytes = fillInstances(sprites, true, instances, instanceParams);
+    });
+
+    printf("%d sprites, %d frames\n", spriteCount, frameCount);
+    printf("%-24s %8s %12s %10s\n", "", "ms/frame", "bytes/frame", "bytes/quad");
+    printf("%-24s %8.3f %12zu %10zu\n", "triangles", trianglesTime, trianglesBytes, trianglesBytes / spriteCount);
+    printf("%-24s %8.3f %12zu %10zu\n", "instanced", instancedTime, instancedBytes, instancedBytes / spriteCount);
+    printf("%-24s %8.3f %12zu %10zu\n", "instanced with params", paramsTime, paramsBytes, paramsBytes / spriteCount);
+    // keeps the results alive
+    return (vertices[0].vertices.x + instances[0].origin[0] > 1e30f) ? 1 : 0;
+}
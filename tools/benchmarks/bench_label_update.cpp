@@ -0,0 +1,328 @@
+/*
+ Cost of updating the text of a 2,000 letter label every frame when only a few letters change, like a counter or
+ a timer in a long label.
+
+ Label needs a Director, a font atlas and batch nodes, this is a stand in for the per frame work of
+ Label::updateContent once the letters are in the atlas, with the font, the layout and the quad writes replicated:
+ - full: the kernings of the whole text are asked to the font, the letters are laid out, every quad is written
+   again and then colored by updateColor, as before the incremental update.
+ - incremental: the kernings are spliced around the changed run and the written quads are compared by
+   LabelUtils::spliceHorizontalKernings and LabelUtils::recordLetterQuad, the functions Label calls, the layout
+   is the same, and only the quads whose rect or position changed are written.
+
+ The kerning of a pair takes a lock, like FontFreeType::getHorizontalKerningForChars.
+ - counter: five digits in the middle of the text count up, the digits have the same advance.
+ - growing number: the number at the start of a line grows and shifts the rest of its line.
+
+ usage: bench_label_update [letter count (2000)] [frame count (500)]
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "2d/CCLabelUtils.h"
+#include "base/ccTypes.h"
+#include "math/CCGeometry.h"
+
+USING_NS_CC;
+
+namespace {
+
+const int LETTERS_PER_LINE = 50;
+const float LINE_HEIGHT = 24;
+
+struct LetterDefinition
+{
+    float u;
+    float v;
+    float width;
+    float height;
+    float offsetX;
+    float offsetY;
+    float xAdvance;
+};
+
+struct LetterInfo
+{
+    float positionX;
+    float positionY;
+};
+
+class Font
+{
+public:
+    Font()
+    {
+        benchmark::Random random(7);
+        for (auto& definition : _definitions)
+        {
+            definition.u = random.range(0, 1000);
+            definition.v = random.range(0, 1000);
+            definition.width = random.range(6, 20);
+            definition.height = random.range(12, 22);
+            definition.offsetX = random.range(0, 2);
+            definition.offsetY = random.range(0, 4);
+            definition.xAdvance = definition.width + 1;
+        }
+        // digits have the same advance in most fonts
+        for (char32_t digit = U'0'; digit <= U'9'; ++digit)
+            _definitions[digit].xAdvance = 12;
+    }
+
+    const LetterDefinition& getLetterDefinition(char32_t letter) const { return _definitions[letter & 127]; }
+
+    // FontFreeType::getHorizontalKerningForTextUTF32
+    int* getHorizontalKerningForTextUTF32(const std::u32string& text, int& outNumLetters) const
+    {
+        outNumLetters = (int)text.length();
+        if (!outNumLetters)
+            return nullptr;
+
+        auto sizes = new (std::nothrow) int[outNumLetters];
+        if (!sizes)
+            return nullptr;
+        sizes[0] = 0;
+        for (int c = 1; c < outNumLetters; ++c)
+            sizes[c] = getHorizontalKerningForChars(text[c - 1], text[c]);
+        return sizes;
+    }
+
+private:
+    int getHorizontalKerningForChars(char32_t first, char32_t second) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const uint32_t hash = (uint32_t)first * 2654435761u ^ (uint32_t)second * 40503u;
+        return (hash >> 29) == 0 ? -1 : 0;
+    }
+
+    LetterDefinition _definitions[128];
+    mutable std::mutex _mutex;
+};
+
+class Label
+{
+public:
+    Label(const Font& font, bool incremental)
+    : _font(font)
+    , _incremental(incremental)
+    , _horizontalKernings(nullptr)
+    , _quadsWritten(0)
+    {
+    }
+
+    ~Label() { delete [] _horizontalKernings; }
+
+    void setString(const std::u32string& text)
+    {
+        computeHorizontalKernings(text);
+        layout(text);
+        if (_incremental)
+            updateQuadsIncremental(text);
+        else
+            updateQuadsFull(text);
+    }
+
+    size_t getQuadsWritten() const { return _quadsWritten; }
+
+private:
+    // Label::computeHorizontalKernings
+    void computeHorizontalKernings(const std::u32string& stringToRender)
+    {
+        auto getKernings = [this](const std::u32string& text) {
+            int letterCount = 0;
+            return _font.getHorizontalKerningForTextUTF32(text, letterCount);
+        };
+
+        if (!_incremental || !LabelUtils::spliceHorizontalKernings(_horizontalKernings, _kerningsText, stringToRender, getKernings))
+        {
+            delete [] _horizontalKernings;
+            _horizontalKernings = getKernings(stringToRender);
+        }
+        _kerningsText = stringToRender;
+    }
+
+    // the line wrap pass, run over the whole text in both versions
+    void layout(const std::u32string& text)
+    {
+        _lettersInfo.resize(text.length());
+        float x = 0;
+        float y = 0;
+        for (size_t i = 0; i < text.length(); ++i)
+        {
+            if (i % LETTERS_PER_LINE == 0)
+            {
+                x = 0;
+                y -= LINE_HEIGHT;
+            }
+            const auto& letterDef = _font.getLetterDefinition(text[i]);
+            _lettersInfo[i].positionX = x + letterDef.offsetX + _horizontalKernings[i];
+            _lettersInfo[i].positionY = y - letterDef.offsetY;
+            x += letterDef.xAdvance + _horizontalKernings[i];
+        }
+    }
+
+    // Sprite::setTextureRect, setPosition and updateTransform of the reused letter, then the quad of the atlas
+    void writeQuad(V3F_C4B_T2F_Quad& quad, const Rect& rect, float x, float y, const Color4B& color)
+    {
+        const float atlasSize = 1024;
+        const float left = rect.origin.x / atlasSize;
+        const float right = (rect.origin.x + rect.size.width) / atlasSize;
+        const float top = rect.origin.y / atlasSize;
+        const float bottom = (rect.origin.y + rect.size.height) / atlasSize;
+        quad.bl.texCoords = Tex2F(left, bottom);
+        quad.br.texCoords = Tex2F(right, bottom);
+        quad.tl.texCoords = Tex2F(left, top);
+        quad.tr.texCoords = Tex2F(right, top);
+        quad.bl.vertices.set(x, y, 0);
+        quad.br.vertices.set(x + rect.size.width, y, 0);
+        quad.tl.vertices.set(x, y + rect.size.height, 0);
+        quad.tr.vertices.set(x + rect.size.width, y + rect.size.height, 0);
+        quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = color;
+        ++_quadsWritten;
+    }
+
+    Rect letterRect(char32_t letter) const
+    {
+        const auto& letterDef = _font.getLetterDefinition(letter);
+        return Rect(letterDef.u, letterDef.v, letterDef.width, letterDef.height);
+    }
+
+    void updateQuadsFull(const std::u32string& text)
+    {
+        const Color4B white(255, 255, 255, 255);
+        _quads.clear();
+        for (size_t i = 0; i < text.length(); ++i)
+        {
+            V3F_C4B_T2F_Quad quad;
+            writeQuad(quad, letterRect(text[i]), _lettersInfo[i].positionX, _lettersInfo[i].positionY, white);
+            _quads.push_back(quad);
+        }
+
+        // Label::updateColor
+        const Color4B color(255, 255, 255, 255);
+        for (auto& quad : _quads)
+            quad.bl.colors = quad.br.colors = quad.tl.colors = quad.tr.colors = color;
+    }
+
+    void updateQuadsIncremental(const std::u32string& text)
+    {
+        const Color4B color(255, 255, 255, 255);
+        for (size_t i = 0; i < text.length(); ++i)
+        {
+            const Rect rect = letterRect(text[i]);
+            const float positionX = _lettersInfo[i].positionX;
+            const float positionY = _lettersInfo[i].positionY;
+            if (!LabelUtils::recordLetterQuad(_letterQuads, (int)i, rect, positionX, positionY))
+                continue;
+
+            if (i < _quads.size())
+            {
+                writeQuad(_quads[i], rect, positionX, positionY, color);
+            }
+            else
+            {
+                V3F_C4B_T2F_Quad quad;
+                writeQuad(quad, rect, positionX, positionY, color);
+                _quads.push_back(quad);
+            }
+        }
+        _quads.resize(text.length());
+        _letterQuads.resize(text.length());
+    }
+
+    const Font& _font;
+    bool _incremental;
+    int* _horizontalKernings;
+    std::u32string _kerningsText;
+    std::vector<LetterInfo> _lettersInfo;
+    std::vector<V3F_C4B_T2F_Quad> _quads;
+    std::vector<LabelUtils::LetterQuad> _letterQuads;
+    size_t _quadsWritten;
+};
+
+std::u32string makeText(int letterCount)
+{
+    static const char32_t letters[] = U"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ ";
+    benchmark::Random random(3);
+    std::u32string text;
+    for (int i = 0; i < letterCount; ++i)
+        text.push_back(letters[random.below(sizeof(letters) / sizeof(letters[0]) - 1)]);
+    return text;
+}
+
+// writes value in decimal at position, padded with zeros to width letters
+void writeNumber(std::u32string& text, size_t position, int value, int width)
+{
+    for (int i = width - 1; i >= 0; --i)
+    {
+        text[position + i] = U'0' + value % 10;
+        value /= 10;
+    }
+}
+
+struct Result
+{
+    double time;
+    double quadsPerFrame;
+};
+
+template <typename F>
+Result run(const Font& font, bool incremental, int frameCount, F textForFrame)
+{
+    Label label(font, incremental);
+    size_t warmUpQuads = 0;
+    const double time = benchmark::measureFrames(frameCount, [&](int frame) {
+        // the quads written by the warm up frames, which include the first fill, aren't counted
+        if (frame == 3)
+            warmUpQuads = label.getQuadsWritten();
+        label.setString(textForFrame(frame));
+    });
+    Result result = { time, (double)(label.getQuadsWritten() - warmUpQuads) / frameCount };
+    return result;
+}
+
+void print(const char* name, const Result& full, const Result& incremental)
+{
+    printf("%-18s %8.3f %8.0f %12.3f %8.0f\n", name, full.time, full.quadsPerFrame, incremental.time, incremental.quadsPerFrame);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int letterCount = std::max(benchmark::intArgument(argc, argv, 1, 2000), LETTERS_PER_LINE * 2);
+    const int frameCount = benchmark::intArgument(argc, argv, 2, 500);
+
+    Font font;
+    const std::u32string baseText = makeText(letterCount);
+
+    // five digits counting up in the middle of the text
+    std::u32string counterText = baseText;
+    const size_t counterPosition = (letterCount / 2 / LETTERS_PER_LINE) * LETTERS_PER_LINE + LETTERS_PER_LINE / 2;
+    auto counter = [&](int frame) -> const std::u32string& {
+        writeNumber(counterText, counterPosition, frame, 5);
+        return counterText;
+    };
+
+    // a number at the start of a line whose digit count grows, the rest of the line moves
+    std::u32string growingText;
+    const size_t growingPosition = (letterCount / 2 / LETTERS_PER_LINE) * LETTERS_PER_LINE;
+    auto growing = [&](int frame) -> const std::u32string& {
+        const int digits = 1 + frame % 6;
+        growingText = baseText.substr(0, growingPosition);
+        growingText.append(digits, U'0');
+        growingText.append(baseText, growingPosition + digits, std::u32string::npos);
+        writeNumber(growingText, growingPosition, frame, digits);
+        return growingText;
+    };
+
+    printf("%d letters, %d frames\n", letterCount, frameCount);
+    printf("%-18s %8s %8s %12s %8s\n", "", "full", "quads", "incremental", "quads");
+    print("counter", run(font, false, frameCount, counter), run(font, true, frameCount, counter));
+    print("growing number", run(font, false, frameCount, growing), run(font, true, frameCount, growing));
+    return 0;
+}
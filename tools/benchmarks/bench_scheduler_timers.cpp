@@ -0,0 +1,84 @@
+/*
+ Cost of Scheduler::update with 10,000 interval timers, the engine Scheduler is measured as is.
+
+ - long intervals: every target schedules a selector with an interval between 0.5 and 10 seconds, like hints,
+   idle animations and autosave, few of them fire in a frame.
+ - every frame: the same selectors with a 0 interval, they all fire every frame.
+ - mixed: a tenth of the timers fire every frame, the others have long intervals.
+
+ The frames advance by 1/60 second.
+
+ usage: bench_scheduler_timers [timer count (10000)] [frame count (600)]
+ */
+
+#include "benchmark.h"
+
+#include <vector>
+
+#include "base/CCRef.h"
+#include "base/CCScheduler.h"
+
+USING_NS_CC;
+
+namespace {
+
+size_t s_fired = 0;
+
+class TimerTarget : public Ref
+{
+public:
+    void tick(float /*dt*/) { ++s_fired; }
+};
+
+struct Result
+{
+    double time;
+    double firedPerFrame;
+};
+
+// everyFrameRatio of the timers have a 0 interval
+Result run(int timerCount, int frameCount, float everyFrameRatio)
+{
+    benchmark::Random random;
+    Scheduler* scheduler = new Scheduler();
+    std::vector<TimerTarget*> targets(timerCount);
+    for (auto& target : targets)
+    {
+        target = new TimerTarget();
+        const float interval = random.range(0, 1) < everyFrameRatio ? 0 : random.range(0.5f, 10);
+        scheduler->schedule(CC_SCHEDULE_SELECTOR(TimerTarget::tick), target, interval, false);
+    }
+
+    s_fired = 0;
+    Result result;
+    result.time = benchmark::measureFrames(frameCount, [&](int) {
+        scheduler->update(1.0f / 60);
+    });
+    result.firedPerFrame = (double)s_fired / (frameCount + 3);
+
+    scheduler->unscheduleAll();
+    delete scheduler;
+    for (auto target : targets)
+        target->release();
+    return result;
+}
+
+void print(const char* name, const Result& result)
+{
+    printf("%-24s %8.3f %14.1f\n", name, result.time, result.firedPerFrame);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int timerCount = benchmark::intArgument(argc, argv, 1, 10000);
+    const int frameCount = benchmark::intArgument(argc, argv, 2, 600);
+
+    printf("%d timers, %d frames\n", timerCount, frameCount);
+    printf("%-24s %8s %14s\n", "", "ms/frame", "fired/frame");
+    print("long intervals", run(timerCount, frameCount, 0));
+    print("every frame", run(timerCount, frameCount, 1));
+    print("mixed", run(timerCount, frameCount, 0.1f));
+    return 0;
+}
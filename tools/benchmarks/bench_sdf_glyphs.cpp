@@ -0,0 +1,372 @@
+/*
+ Distance field glyphs generated per second, for the Latin and CJK glyphs of the first labels of a localized UI.
+
+ makeDistanceMap is a file local function of CCFontFreeType.cpp, whose other code needs a Director and FileUtils.
+ Both versions are copied here and must be kept in sync:
+ - edtaa3: makeDistanceMap before the linear time EDT, computegradient and edtaa3 of external/edtaa3func, run
+   twice on double buffers allocated for every glyph.
+ - linear EDT: the current makeDistanceMap, with the separable Felzenszwalb EDT on reused float buffers.
+
+ The glyphs are rendered by FreeType at the given pixel size, the fonts missing a glyph skip it.
+ Latin is U+0021 to U+007E, CJK the first 512 unified ideographs from U+4E00. The resources have no CJK font, the
+ default one is the first system font of CJK_FONTS found, the benchmark fails if there is none or if a font has
+ none of the glyphs.
+
+ usage: bench_sdf_glyphs [Latin font (Resources/fonts/arial.ttf)] [CJK font (a system one)] [pixel size (48)]
+ an empty font argument selects the default one
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "edtaa3func.h"
+
+namespace {
+
+const int DistanceMapSpread = 3;
+
+namespace edtaa3Version {
+
+unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
+{
+    long pixelAmount = (width + 2 * DistanceMapSpread) * (height + 2 * DistanceMapSpread);
+
+    short * xdist = (short *)  malloc( pixelAmount * sizeof(short) );
+    short * ydist = (short *)  malloc( pixelAmount * sizeof(short) );
+    double * gx   = (double *) calloc( pixelAmount, sizeof(double) );
+    double * gy      = (double *) calloc( pixelAmount, sizeof(double) );
+    double * data    = (double *) calloc( pixelAmount, sizeof(double) );
+    double * outside = (double *) calloc( pixelAmount, sizeof(double) );
+    double * inside  = (double *) calloc( pixelAmount, sizeof(double) );
+    long i,j;
+
+    long outWidth = width + 2 * DistanceMapSpread;
+    for (i = 0; i < width; ++i)
+    {
+        for (j = 0; j < height; ++j)
+        {
+            data[j * outWidth + DistanceMapSpread + i] = img[j * width + i] / 255.0;
+        }
+    }
+
+    width += 2 * DistanceMapSpread;
+    height += 2 * DistanceMapSpread;
+
+    computegradient( data, (int)width, (int)height, gx, gy);
+    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, outside);
+    for( i=0; i< pixelAmount; i++)
+        if( outside[i] < 0.0 )
+            outside[i] = 0.0;
+
+    for( i=0; i< pixelAmount; i++)
+        data[i] = 1 - data[i];
+    computegradient( data, (int)width, (int)height, gx, gy);
+    edtaa3(data, gx, gy, (int)width, (int)height, xdist, ydist, inside);
+    for( i=0; i< pixelAmount; i++)
+        if( inside[i] < 0.0 )
+            inside[i] = 0.0;
+
+    double dist;
+    unsigned char *out = (unsigned char *) malloc( pixelAmount * sizeof(unsigned char) );
+    for( i=0; i < pixelAmount; i++)
+    {
+        dist = outside[i] - inside[i];
+        dist = 128.0 - dist*16;
+        if( dist < 0 ) dist = 0;
+        if( dist > 255 ) dist = 255;
+        out[i] = (unsigned char) dist;
+    }
+
+    free( xdist );
+    free( ydist );
+    free( gx );
+    free( gy );
+    free( data );
+    free( outside );
+    free( inside );
+
+    return out;
+}
+
+} // namespace edtaa3Version
+
+namespace edtVersion {
+
+const float DistanceInfinity = 1e20f;
+
+void distanceTransform1D(float *grid, int *nearest, long offset, long stride, long length,
+                         float *f, float *z, int *v)
+{
+    for (long q = 0; q < length; ++q)
+        f[q] = grid[offset + q * stride];
+
+    long k = 0;
+    v[0] = 0;
+    z[0] = -DistanceInfinity;
+    z[1] = DistanceInfinity;
+    for (long q = 1; q < length; ++q)
+    {
+        float s;
+        do
+        {
+            long r = v[k];
+            s = (f[q] - f[r] + (float)(q * q - r * r)) / (float)(2 * (q - r));
+        } while (s <= z[k] && --k >= 0);
+
+        ++k;
+        v[k] = (int)q;
+        z[k] = s;
+        z[k + 1] = DistanceInfinity;
+    }
+
+    k = 0;
+    for (long q = 0; q < length; ++q)
+    {
+        while (z[k + 1] < q)
+            ++k;
+        long r = v[k];
+        grid[offset + q * stride] = f[r] + (float)((q - r) * (q - r));
+        nearest[offset + q * stride] = (int)r;
+    }
+}
+
+struct DistanceMapScratch
+{
+    std::vector<float> coverage;
+    std::vector<float> outside;
+    std::vector<float> inside;
+    std::vector<float> grid;
+    std::vector<int> nearestRow;
+    std::vector<int> nearestColumn;
+    std::vector<float> f;
+    std::vector<float> z;
+    std::vector<int> v;
+};
+
+void contourDistance(DistanceMapScratch &scratch, float *result, long width, long height)
+{
+    const float *coverage = scratch.coverage.data();
+    float *grid = scratch.grid.data();
+    int *nearestRow = scratch.nearestRow.data();
+    int *nearestColumn = scratch.nearestColumn.data();
+    long pixelAmount = width * height;
+
+    for (long i = 0; i < pixelAmount; ++i)
+        grid[i] = coverage[i] > 0.0f ? 0.0f : DistanceInfinity;
+
+    for (long x = 0; x < width; ++x)
+        distanceTransform1D(grid, nearestRow, x, width, height, scratch.f.data(), scratch.z.data(), scratch.v.data());
+    for (long y = 0; y < height; ++y)
+        distanceTransform1D(grid, nearestColumn, y * width, 1, width, scratch.f.data(), scratch.z.data(), scratch.v.data());
+
+    for (long y = 0; y < height; ++y)
+    {
+        for (long x = 0; x < width; ++x)
+        {
+            long i = y * width + x;
+            if (grid[i] >= DistanceInfinity)
+            {
+                result[i] = DistanceInfinity;
+                continue;
+            }
+            long siteX = nearestColumn[i];
+            long siteY = nearestRow[y * width + siteX];
+            float dist = std::sqrt(grid[i]) + 0.5f - coverage[siteY * width + siteX];
+            result[i] = dist > 0.0f ? dist : 0.0f;
+        }
+    }
+}
+
+unsigned char * makeDistanceMap( unsigned char *img, long width, long height)
+{
+    long outWidth = width + 2 * DistanceMapSpread;
+    long outHeight = height + 2 * DistanceMapSpread;
+    long pixelAmount = outWidth * outHeight;
+
+    static thread_local DistanceMapScratch scratch;
+    long maxLength = std::max(outWidth, outHeight);
+    scratch.coverage.assign(pixelAmount, 0.0f);
+    scratch.outside.resize(pixelAmount);
+    scratch.inside.resize(pixelAmount);
+    scratch.grid.resize(pixelAmount);
+    scratch.nearestRow.resize(pixelAmount);
+    scratch.nearestColumn.resize(pixelAmount);
+    if ((long)scratch.f.size() < maxLength)
+    {
+        scratch.f.resize(maxLength);
+        scratch.z.resize(maxLength + 1);
+        scratch.v.resize(maxLength);
+    }
+
+    for (long j = 0; j < height; ++j)
+    {
+        float *row = scratch.coverage.data() + (j + DistanceMapSpread) * outWidth + DistanceMapSpread;
+        for (long i = 0; i < width; ++i)
+        {
+            row[i] = img[j * width + i] / 255.0f;
+        }
+    }
+
+    contourDistance(scratch, scratch.outside.data(), outWidth, outHeight);
+
+    for (long i = 0; i < pixelAmount; ++i)
+        scratch.coverage[i] = 1.0f - scratch.coverage[i];
+    contourDistance(scratch, scratch.inside.data(), outWidth, outHeight);
+
+    unsigned char *out = (unsigned char *) malloc( pixelAmount * sizeof(unsigned char) );
+    for (long i = 0; i < pixelAmount; ++i)
+    {
+        float dist = scratch.outside[i] - scratch.inside[i];
+        dist = 128.0f - dist * 16;
+        if (dist < 0.0f) dist = 0.0f;
+        if (dist > 255.0f) dist = 255.0f;
+        out[i] = (unsigned char) dist;
+    }
+
+    return out;
+}
+
+} // namespace edtVersion
+
+struct Glyph
+{
+    std::vector<unsigned char> bitmap;
+    long width;
+    long height;
+};
+
+std::vector<Glyph> renderGlyphs(FT_Library library, const char* fontPath, int pixelSize, unsigned long first, unsigned long last)
+{
+    std::vector<Glyph> glyphs;
+    FT_Face face;
+    if (FT_New_Face(library, fontPath, 0, &face))
+    {
+        fprintf(stderr, "can't open %s\n", fontPath);
+        exit(1);
+    }
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+    for (unsigned long code = first; code <= last; ++code)
+    {
+        if (FT_Get_Char_Index(face, code) == 0 || FT_Load_Char(face, code, FT_LOAD_RENDER | FT_LOAD_NO_AUTOHINT))
+            continue;
+
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        if (bitmap.width == 0 || bitmap.rows == 0)
+            continue;
+
+        Glyph glyph;
+        glyph.width = bitmap.width;
+        glyph.height = bitmap.rows;
+        glyph.bitmap.resize(glyph.width * glyph.height);
+        for (long row = 0; row < glyph.height; ++row)
+            memcpy(&glyph.bitmap[row * glyph.width], bitmap.buffer + row * bitmap.pitch, glyph.width);
+        glyphs.push_back(std::move(glyph));
+    }
+
+    FT_Done_Face(face);
+    return glyphs;
+}
+
+// system fonts with CJK ideographs, Noto Sans CJK and Droid Sans Fallback on Linux and Android, then macOS
+const char* const CJK_FONTS[] = {
+    "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/google-noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/opentype/noto-cjk/NotoSansCJK-Regular.ttc",
+    "/usr/share/fonts/truetype/droid/DroidSansFallbackFull.ttf",
+    "/usr/share/fonts/google-droid/DroidSansFallbackFull.ttf",
+    "/system/fonts/NotoSansCJK-Regular.ttc",
+    "/system/fonts/DroidSansFallback.ttf",
+    "/System/Library/Fonts/PingFang.ttc",
+    "/System/Library/Fonts/STHeiti Medium.ttc",
+    "/Library/Fonts/Arial Unicode.ttf",
+};
+
+const char* findCJKFont()
+{
+    for (auto path : CJK_FONTS)
+    {
+        if (FILE* file = fopen(path, "rb"))
+        {
+            fclose(file);
+            return path;
+        }
+    }
+
+    fprintf(stderr, "no CJK font found, pass one as the second argument. Looked for:\n");
+    for (auto path : CJK_FONTS)
+        fprintf(stderr, "  %s\n", path);
+    exit(1);
+}
+
+std::vector<Glyph> renderGlyphSet(FT_Library library, const char* name, const char* fontPath, int pixelSize,
+                                  unsigned long first, unsigned long last)
+{
+    std::vector<Glyph> glyphs = renderGlyphs(library, fontPath, pixelSize, first, last);
+    if (glyphs.empty())
+    {
+        fprintf(stderr, "%s has none of the %s glyphs U+%04lX to U+%04lX\n", fontPath, name, first, last);
+        exit(1);
+    }
+    return glyphs;
+}
+
+// glyphs per second, the distance maps are freed like FontFreeType::renderCharAt does
+template <typename F>
+double glyphsPerSecond(std::vector<Glyph>& glyphs, F makeDistanceMap)
+{
+    // at least ~0.2 s of work
+    int repeatCount = 0;
+    const auto start = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed(0);
+    do
+    {
+        for (auto& glyph : glyphs)
+            free(makeDistanceMap(glyph.bitmap.data(), glyph.width, glyph.height));
+        ++repeatCount;
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed.count() < 0.2);
+    return glyphs.size() * repeatCount / elapsed.count();
+}
+
+void run(const char* name, std::vector<Glyph>& glyphs)
+{
+    printf("%-8s %7zu %12.0f %12.0f\n", name, glyphs.size(),
+           glyphsPerSecond(glyphs, edtaa3Version::makeDistanceMap),
+           glyphsPerSecond(glyphs, edtVersion::makeDistanceMap));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char* latinFont = argc > 1 && argv[1][0] ? argv[1] : BENCH_DEFAULT_FONT;
+    const char* cjkFont = argc > 2 && argv[2][0] ? argv[2] : findCJKFont();
+    const int pixelSize = benchmark::intArgument(argc, argv, 3, 48);
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library))
+        return 1;
+
+    std::vector<Glyph> latin = renderGlyphSet(library, "Latin", latinFont, pixelSize, 0x21, 0x7e);
+    std::vector<Glyph> cjk = renderGlyphSet(library, "CJK", cjkFont, pixelSize, 0x4e00, 0x4e00 + 511);
+
+    printf("%dpx, glyphs per second\n", pixelSize);
+    printf("Latin: %s\nCJK: %s\n", latinFont, cjkFont);
+    printf("%-8s %7s %12s %12s\n", "", "glyphs", "edtaa3", "linear EDT");
+    run("Latin", latin);
+    run("CJK", cjk);
+
+    FT_Done_FreeType(library);
+    return 0;
+}
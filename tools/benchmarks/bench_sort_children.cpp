@@ -0,0 +1,137 @@
+/*
+ Cost of sorting the children of a node after some of them were reordered, like the pieces of a dragged group
+ moved to z 100 and back to 0 on drop.
+
+ Node can't be created without a Director, the children are stand ins holding the fields the sort reads. They are
+ sorted by utils::sortMovedElements, the sort of Node::sortReorderedChildren:
+ - full sort: every child counted as moved, a std::sort like Node::sortNodes, the sort before the incremental one.
+ - incremental: the reordered children are sorted alone and merged back.
+
+ Each frame reorders a window of the children, alternately to z 100 and to z 0, then sorts them.
+
+ usage: bench_sort_children [child count (2000)] [reorders per frame (500)] [frame count (1000)]
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/ccSortUtils.h"
+
+namespace {
+
+uint32_t s_globalOrderOfArrival = 0;
+
+// the fields of Node read by the sort, laid out as in Node on little endian platforms
+struct Child
+{
+    union {
+        struct {
+            uint32_t orderOfArrival;
+            int32_t localZOrder;
+        };
+        int64_t localZOrderArrival;
+    };
+    bool reorderPending;
+};
+
+struct Parent
+{
+    std::vector<Child*> children;
+    std::ptrdiff_t reorderedChildCount = 0;
+
+    // Node::insertChild
+    void insertChild(Child* child, int z)
+    {
+        children.push_back(child);
+        child->orderOfArrival = ++s_globalOrderOfArrival;
+        child->localZOrder = z;
+        child->reorderPending = true;
+        ++reorderedChildCount;
+    }
+
+    // Node::reorderChild
+    void reorderChild(Child* child, int z)
+    {
+        child->orderOfArrival = ++s_globalOrderOfArrival;
+        child->localZOrder = z;
+        if (!child->reorderPending)
+        {
+            child->reorderPending = true;
+            ++reorderedChildCount;
+        }
+    }
+};
+
+// Node::localOrderLess on 64 bit platforms
+bool localOrderLess(const Child* n1, const Child* n2)
+{
+    return n1->localZOrderArrival < n2->localZOrderArrival;
+}
+
+// Node::sortReorderedChildren
+void sortChildren(Parent& parent, std::ptrdiff_t reorderedChildCount)
+{
+    static std::vector<Child*> moved;
+    cocos2d::utils::sortMovedElements(parent.children.begin(), parent.children.end(), reorderedChildCount, moved,
+                                      [](Child* child) {
+                                          bool reordered = child->reorderPending;
+                                          child->reorderPending = false;
+                                          return reordered;
+                                      },
+                                      localOrderLess);
+    parent.reorderedChildCount = 0;
+}
+
+void fullSort(Parent& parent)
+{
+    sortChildren(parent, parent.children.size());
+}
+
+void incrementalSort(Parent& parent)
+{
+    sortChildren(parent, parent.reorderedChildCount);
+}
+
+template <typename Sort>
+double run(int childCount, int reorderCount, int frameCount, Sort sort)
+{
+    s_globalOrderOfArrival = 0;
+    std::vector<Child> nodes(childCount);
+    Parent parent;
+    for (auto& node : nodes)
+        parent.insertChild(&node, 0);
+    sort(parent);
+
+    const double time = benchmark::measureFrames(frameCount, [&](int frame) {
+        const int start = (frame * 37) % childCount;
+        const int z = (frame & 1) ? 0 : 100;
+        for (int i = 0; i < reorderCount; ++i)
+            parent.reorderChild(&nodes[(start + i) % childCount], z);
+        sort(parent);
+    });
+    if (!std::is_sorted(parent.children.begin(), parent.children.end(), localOrderLess))
+    {
+        fprintf(stderr, "children out of order\n");
+        exit(1);
+    }
+    return time;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int childCount = benchmark::intArgument(argc, argv, 1, 2000);
+    const int reorderCount = std::min(benchmark::intArgument(argc, argv, 2, 500), childCount);
+    const int frameCount = benchmark::intArgument(argc, argv, 3, 1000);
+
+    printf("%d children, %d reorders per frame, %d frames\n", childCount, reorderCount, frameCount);
+    printf("%-24s %8s\n", "", "ms/frame");
+    printf("%-24s %8.4f\n", "full sort", run(childCount, reorderCount, frameCount, fullSort));
+    printf("%-24s %8.4f\n", "incremental", run(childCount, reorderCount, frameCount, incrementalSort));
+    return 0;
+}
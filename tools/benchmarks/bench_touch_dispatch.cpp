@@ -0,0 +1,208 @@
+/*
+ Heap allocations and CPU cost of dispatching a touch move event to the touch listeners, like dragging a piece
+ among the listeners of the puzzle pieces.
+
+ The EventDispatcher, listener, event and touch code is the engine's, stand ins defined below replace the few
+ Director, Scene and Camera members it refers to. There is no running scene, the scene graph priority listeners
+ of the pieces need nodes: the listeners have fixed priorities instead, so the dispatch goes through
+ dispatchTouchEvent, its dispatch buffers and the ListenerCallback of dispatchTouchEventToListeners, but not the
+ copies of the scene listeners and cameras. The EventTouch is reused like the touch buffers of GLView.
+ Compare with the parent commit through COCOS2D_ROOT.
+
+ Allocations are counted by replacing the global operator new.
+
+ usage: bench_touch_dispatch [listener count (200)] [touch count (1)] [event count (100000)]
+ */
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "2d/CCCamera.h"
+#include "2d/CCScene.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerController.h"
+#include "base/CCEventListenerTouch.h"
+#include "base/CCEventTouch.h"
+#include "base/CCTouch.h"
+
+USING_NS_CC;
+
+namespace {
+
+size_t s_allocationCount = 0;
+
+} // namespace
+
+// every replaceable form is defined, so that no allocation pairs the counting new with the default delete.
+// They aren't inlined either: GCC would see a new expression released by free and warn with -Wmismatched-new-delete
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void* operator new(std::size_t size)
+{
+    ++s_allocationCount;
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+BENCH_NOINLINE void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++s_allocationCount;
+    return malloc(size ? size : 1);
+}
+
+BENCH_NOINLINE void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    free(p);
+}
+
+#if __cpp_sized_deallocation
+BENCH_NOINLINE void operator delete(void* p, std::size_t) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void* p, std::size_t) noexcept
+{
+    free(p);
+}
+#endif
+
+NS_CC_BEGIN
+
+// only getRunningScene() is called, the zeroed director has no running scene
+Director* Director::getInstance()
+{
+    alignas(Director) static unsigned char director[sizeof(Director)] = {};
+    return reinterpret_cast<Director*>(director);
+}
+
+Vec2 Director::convertToGL(const Vec2& point)
+{
+    return point;
+}
+
+const std::vector<Camera*>& Scene::getCameras()
+{
+    return _cameras;
+}
+
+Camera* Camera::_visitingCamera = nullptr;
+
+// CCEventListenerController.cpp needs the controller code
+const std::string EventListenerController::LISTENER_ID = "__cc_controller";
+
+NS_CC_END
+
+namespace {
+
+struct Result
+{
+    double time;
+    double allocations;
+};
+
+template <typename F>
+Result run(int eventCount, F dispatch)
+{
+    // first event, the reused buffers grow
+    dispatch();
+
+    const size_t allocationCount = s_allocationCount;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < eventCount; ++i)
+        dispatch();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    Result result;
+    result.time = elapsed.count() / eventCount;
+    result.allocations = (double)(s_allocationCount - allocationCount) / eventCount;
+    return result;
+}
+
+void print(const char* name, const Result& result)
+{
+    printf("%-24s %10.0f %14.2f\n", name, result.time, result.allocations);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int listenerCount = std::max(benchmark::intArgument(argc, argv, 1, 200), 1);
+    const int touchCount = std::min(benchmark::intArgument(argc, argv, 2, 1), (int)EventTouch::MAX_TOUCHES);
+    const int eventCount = benchmark::intArgument(argc, argv, 3, 100000);
+
+    std::vector<Touch*> touches;
+    for (int i = 0; i < touchCount; ++i)
+    {
+        auto touch = new Touch();
+        touch->setTouchInfo(i, 0, 0);
+        touches.push_back(touch);
+    }
+
+    // the listeners are visited by increasing priority, the last one claims the touches so that the moves visit
+    // all of them
+    auto dispatcher = new EventDispatcher();
+    // enabled by the Director
+    dispatcher->setEnabled(true);
+    size_t moveCount = 0;
+    for (int i = 0; i < listenerCount; ++i)
+    {
+        const bool last = (i + 1 == listenerCount);
+        auto listener = EventListenerTouchOneByOne::create();
+        listener->setSwallowTouches(true);
+        listener->onTouchBegan = [last](Touch*, Event*) { return last; };
+        listener->onTouchMoved = [&moveCount](Touch*, Event*) { ++moveCount; };
+        dispatcher->addEventListenerWithFixedPriority(listener, i + 1);
+    }
+
+    EventTouch touchEvent;
+    touchEvent.setTouches(touches);
+    touchEvent.setEventCode(EventTouch::EventCode::BEGAN);
+    dispatcher->dispatchEvent(&touchEvent);
+    touchEvent.setEventCode(EventTouch::EventCode::MOVED);
+
+    printf("%d listeners, %d touches, %d events\n", listenerCount, touchCount, eventCount);
+    printf("%-24s %10s %14s\n", "", "ns/event", "allocs/event");
+    print("dispatchEvent", run(eventCount, [&]() { dispatcher->dispatchEvent(&touchEvent); }));
+
+    dispatcher->release();
+    for (auto touch : touches)
+        touch->release();
+    return moveCount == 0 ? 1 : 0;
+}
@@ -0,0 +1,310 @@
+/*
+ Cost of the user uniform setters and of GLProgramState::apply for 1,000 states of one program, like the puzzle
+ pieces drawn with the RoundedBorder shader when instancing isn't available.
+
+ The GLProgramState code is the engine's. The GLProgram it uses is a stand in defined below: it reports the
+ uniforms of RoundedBorder.frag and keeps the cache of GLProgram::updateUniformLocation, whose hits skip the upload,
+ but counts the uploads instead of calling glUniform.
+
+ - set by name: setUniformVec4(name) of the two uniforms changed when a piece connects, on every state.
+ - set by handle: the same with the handles of getUniformHandle(), when COCOS2D_ROOT has them.
+ - apply, 1,000 states: every state applied in turn after the two changes, as the pieces are drawn.
+ - apply, shared state: one state applied 1,000 times with two changes, as a state shared by all the pieces.
+
+ usage: bench_uniform_handles [state count (1000)] [frame count (200)]
+ */
+
+#include "benchmark.h"
+
+#include <vector>
+
+#include "base/CCRef.h"
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramCache.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCGLProgramStateCache.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
+
+USING_NS_CC;
+
+namespace {
+
+// GLProgram setter calls and the uploads they did, the others were cache hits
+size_t s_setterCalls = 0;
+size_t s_uploads = 0;
+
+struct UniformDefinition
+{
+    const char* name;
+    GLenum type;
+};
+
+// RoundedBorder.frag
+const UniformDefinition ROUNDED_BORDER_UNIFORMS[] = {
+    { "u_size", GL_FLOAT_VEC2 },
+    { "u_borderWidth", GL_FLOAT },
+    { "u_borderColor", GL_FLOAT_VEC4 },
+    { "u_uvRect", GL_FLOAT_VEC4 },
+    { "u_cornerRadii", GL_FLOAT_VEC4 },
+    { "u_borderSides", GL_FLOAT_VEC4 },
+};
+
+class BenchGLProgram : public GLProgram
+{
+public:
+    BenchGLProgram()
+    {
+        GLint location = 0;
+        for (const auto& definition : ROUNDED_BORDER_UNIFORMS)
+        {
+            Uniform uniform;
+            uniform.location = location++;
+            uniform.size = 1;
+            uniform.type = definition.type;
+            uniform.name = definition.name;
+            _userUniforms[uniform.name] = uniform;
+        }
+    }
+};
+
+} // namespace
+
+NS_CC_BEGIN
+
+const char* GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR = "ShaderETC1ASPositionTextureColor";
+const char* GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP = "ShaderETC1ASPositionTextureColor_noMVP";
+const char* GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP = "ShaderETC1ASPositionTextureGray_noMVP";
+const char* GLProgram::SHADER_NAME_POSITION_GRAYSCALE = "ShaderUIGrayScale";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR = "ShaderPositionTextureColor";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP = "ShaderPositionTextureColor_noMVP";
+
+GLProgram::GLProgram()
+: _program(0)
+, _vertShader(0)
+, _fragShader(0)
+, _director(nullptr)
+#if BENCH_HAS_UNIFORM_HANDLES
+, _lastUniformState(nullptr)
+#endif
+{
+    memset(_builtInUniforms, 0, sizeof(_builtInUniforms));
+}
+
+GLProgram::~GLProgram()
+{
+    for (auto& element : _hashForUniforms)
+        free(element.second.first);
+}
+
+std::string GLProgram::getDescription() const { return "BenchGLProgram"; }
+GLProgram* GLProgram::createWithFilenames(const std::string&, const std::string&, const std::string&) { return nullptr; }
+void GLProgram::use() {}
+void GLProgram::setUniformsForBuiltins(const Mat4&) {}
+
+Uniform* GLProgram::getUniform(const std::string& name)
+{
+    const auto itr = _userUniforms.find(name);
+    return itr != _userUniforms.end() ? &itr->second : nullptr;
+}
+
+VertexAttrib* GLProgram::getVertexAttrib(const std::string& name)
+{
+    const auto itr = _vertexAttribs.find(name);
+    return itr != _vertexAttribs.end() ? &itr->second : nullptr;
+}
+
+// same cache as the engine
+bool GLProgram::updateUniformLocation(GLint location, const GLvoid* data, unsigned int bytes)
+{
+    ++s_setterCalls;
+    if (location < 0)
+        return false;
+
+    bool updated = true;
+    auto element = _hashForUniforms.find(location);
+    if (element == _hashForUniforms.end())
+    {
+        GLvoid* value = malloc(bytes);
+        memcpy(value, data, bytes);
+        _hashForUniforms.emplace(location, std::make_pair(value, bytes));
+    }
+    else if (element->second.second < bytes)
+    {
+        GLvoid* value = realloc(element->second.first, bytes);
+        memcpy(value, data, bytes);
+        _hashForUniforms[location] = std::make_pair(value, bytes);
+    }
+    else if (memcmp(element->second.first, data, bytes) == 0)
+    {
+        updated = false;
+    }
+    else
+    {
+        memcpy(element->second.first, data, bytes);
+    }
+
+#if BENCH_HAS_UNIFORM_HANDLES
+    if (updated)
+        _lastUniformState = nullptr;
+#endif
+    if (updated)
+        ++s_uploads;
+    return updated;
+}
+
+void GLProgram::setUniformLocationWith1i(GLint location, GLint i1) { updateUniformLocation(location, &i1, sizeof(i1)); }
+void GLProgram::setUniformLocationWith1f(GLint location, GLfloat f1) { updateUniformLocation(location, &f1, sizeof(f1)); }
+void GLProgram::setUniformLocationWith2f(GLint location, GLfloat f1, GLfloat f2)
+{
+    GLfloat floats[] = { f1, f2 };
+    updateUniformLocation(location, floats, sizeof(floats));
+}
+void GLProgram::setUniformLocationWith3f(GLint location, GLfloat f1, GLfloat f2, GLfloat f3)
+{
+    GLfloat floats[] = { f1, f2, f3 };
+    updateUniformLocation(location, floats, sizeof(floats));
+}
+void GLProgram::setUniformLocationWith4f(GLint location, GLfloat f1, GLfloat f2, GLfloat f3, GLfloat f4)
+{
+    GLfloat floats[] = { f1, f2, f3, f4 };
+    updateUniformLocation(location, floats, sizeof(floats));
+}
+void GLProgram::setUniformLocationWith1fv(GLint location, const GLfloat* floats, unsigned int count) { updateUniformLocation(location, floats, sizeof(float) * count); }
+void GLProgram::setUniformLocationWith2fv(GLint location, const GLfloat* floats, unsigned int count) { updateUniformLocation(location, floats, sizeof(float) * 2 * count); }
+void GLProgram::setUniformLocationWith3fv(GLint location, const GLfloat* floats, unsigned int count) { updateUniformLocation(location, floats, sizeof(float) * 3 * count); }
+void GLProgram::setUniformLocationWith4fv(GLint location, const GLfloat* floats, unsigned int count) { updateUniformLocation(location, floats, sizeof(float) * 4 * count); }
+void GLProgram::setUniformLocationWithMatrix4fv(GLint location, const GLfloat* matrices, unsigned int count) { updateUniformLocation(location, matrices, sizeof(float) * 16 * count); }
+
+GLProgramCache* GLProgramCache::getInstance() { return nullptr; }
+GLProgram* GLProgramCache::getGLProgram(const std::string&) { return nullptr; }
+void GLProgramCache::addGLProgram(GLProgram*, const std::string&) {}
+GLProgramStateCache* GLProgramStateCache::getInstance() { return nullptr; }
+GLProgramState* GLProgramStateCache::getGLProgramState(GLProgram*) { return nullptr; }
+
+GLuint Texture2D::getName() const { return 0; }
+GLuint Texture2D::getAlphaTextureName() const { return 0; }
+
+namespace GL {
+void enableVertexAttribs(uint32_t) {}
+void bindTexture2DN(GLuint, GLuint) {}
+void bindTextureN(GLuint, GLuint, GLuint) {}
+} // namespace GL
+
+NS_CC_END
+
+namespace {
+
+struct Result
+{
+    double time;
+    size_t setterCalls;
+    size_t uploads;
+};
+
+template <typename F>
+Result measure(int frameCount, F frameFunction)
+{
+    Result result;
+    size_t setterCalls = 0;
+    size_t uploads = 0;
+    result.time = benchmark::measureFrames(frameCount, [&](int frame) {
+        s_setterCalls = 0;
+        s_uploads = 0;
+        frameFunction(frame);
+        setterCalls = s_setterCalls;
+        uploads = s_uploads;
+    });
+    result.setterCalls = setterCalls;
+    result.uploads = uploads;
+    return result;
+}
+
+void print(const char* name, const Result& result)
+{
+    printf("%-24s %8.3f %14zu %10zu\n", name, result.time, result.setterCalls, result.uploads);
+}
+
+// the values a piece gets when it connects on some sides
+Vec4 cornerRadii(int frame, int piece)
+{
+    return Vec4((float)((frame + piece) & 7), 8, 8, (float)(frame & 3));
+}
+
+Vec4 borderSides(int frame, int piece)
+{
+    return Vec4((float)((frame ^ piece) & 1), 1, 0, 1);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int stateCount = benchmark::intArgument(argc, argv, 1, 1000);
+    const int frameCount = benchmark::intArgument(argc, argv, 2, 200);
+
+    auto program = new BenchGLProgram();
+    std::vector<GLProgramState*> states;
+    for (int i = 0; i < stateCount; ++i)
+    {
+        auto state = GLProgramState::create(program);
+        state->retain();
+        // ShaderPieceSkin::initShader
+        state->setUniformVec2("u_size", Vec2(128, 128));
+        state->setUniformFloat("u_borderWidth", 2);
+        state->setUniformVec4("u_borderColor", Vec4(1, 1, 1, 1));
+        state->setUniformVec4("u_uvRect", Vec4(0, 0, 0.1f, 0.1f));
+        state->setUniformVec4("u_cornerRadii", Vec4(8, 8, 8, 8));
+        state->setUniformVec4("u_borderSides", Vec4(1, 1, 1, 1));
+        states.push_back(state);
+    }
+    const Mat4 modelView = Mat4::IDENTITY;
+
+    printf("%d states, %d frames\n", stateCount, frameCount);
+    printf("%-24s %8s %14s %10s\n", "", "ms/frame", "setter calls", "uploads");
+
+    print("set by name", measure(frameCount, [&](int frame) {
+        for (int i = 0; i < stateCount; ++i)
+        {
+            states[i]->setUniformVec4("u_cornerRadii", cornerRadii(frame, i));
+            states[i]->setUniformVec4("u_borderSides", borderSides(frame, i));
+        }
+    }));
+
+#if BENCH_HAS_UNIFORM_HANDLES
+    const UniformHandle cornerRadiiHandle = states[0]->getUniformHandle("u_cornerRadii");
+    const UniformHandle borderSidesHandle = states[0]->getUniformHandle("u_borderSides");
+    print("set by handle", measure(frameCount, [&](int frame) {
+        for (int i = 0; i < stateCount; ++i)
+        {
+            states[i]->setUniformVec4(cornerRadiiHandle, cornerRadii(frame, i));
+            states[i]->setUniformVec4(borderSidesHandle, borderSides(frame, i));
+        }
+    }));
+#else
+    printf("%-24s %8s\n", "set by handle", "n/a");
+#endif
+
+    print("apply, 1,000 states", measure(frameCount, [&](int frame) {
+        for (int i = 0; i < stateCount; ++i)
+        {
+            states[i]->setUniformVec4("u_cornerRadii", cornerRadii(frame, i));
+            states[i]->setUniformVec4("u_borderSides", borderSides(frame, i));
+            states[i]->apply(modelView);
+        }
+    }));
+
+    GLProgramState* shared = states[0];
+    print("apply, shared state", measure(frameCount, [&](int frame) {
+        for (int i = 0; i < stateCount; ++i)
+        {
+            shared->setUniformVec4("u_cornerRadii", cornerRadii(frame, i));
+            shared->setUniformVec4("u_borderSides", borderSides(frame, i));
+            shared->apply(modelView);
+        }
+    }));
+
+    for (auto state : states)
+        state->release();
+    return 0;
+}
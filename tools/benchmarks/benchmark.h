@@ -0,0 +1,67 @@
+/*
+ Helpers shared by the benchmarks: a steady clock timer and a deterministic random generator,
+ so that two builds measured on the same machine run exactly the same work.
+ */
+#ifndef __BENCHMARKS_BENCHMARK_H__
+#define __BENCHMARKS_BENCHMARK_H__
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace benchmark {
+
+// runs frameFunction for frameCount frames after a few warm up ones, returns the mean time of a frame in ms
+template <typename F>
+double measureFrames(int frameCount, F frameFunction)
+{
+    for (int i = 0; i < 3; ++i)
+        frameFunction(i);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; ++i)
+        frameFunction(i + 3);
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frameCount;
+}
+
+// xorshift32, the benchmarks must not depend on the rand() of the platform
+class Random
+{
+public:
+    explicit Random(uint32_t seed = 0x9e3779b9u) : _state(seed ? seed : 1) {}
+
+    uint32_t next()
+    {
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state;
+    }
+
+    // in [0, count)
+    uint32_t below(uint32_t count) { return next() % count; }
+
+    // in [min, max)
+    float range(float min, float max) { return min + (max - min) * (next() >> 8) * (1.0f / 16777216.0f); }
+
+private:
+    uint32_t _state;
+};
+
+// reads the positive integer argument at index, or returns defaultValue
+inline int intArgument(int argc, char** argv, int index, int defaultValue)
+{
+    if (index < argc)
+    {
+        const int value = atoi(argv[index]);
+        if (value > 0)
+            return value;
+    }
+    return defaultValue;
+}
+
+} // namespace benchmark
+
+#endif // __BENCHMARKS_BENCHMARK_H__
@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Transcode the large images of a resource directory into GPU compressed textures.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Transcode the large PNG/JPEG images of a resource directory into GPU compressed
+.ktx textures, loaded instead of the images by TextureCache when
+TextureCache::setCompressedVariantsEnabled(true) is set.
+
+Every image gets up to three variants next to it, TextureCache picks the first
+one the GPU supports:
+
+    name.astc.ktx           ASTC (GL_KHR_texture_compression_astc_ldr)
+    name.etc2.ktx           ETC2 RGB or RGBA (OpenGL ES 3)
+    name.etc1.ktx           ETC1 (OpenGL ES 2), with name.etc1.ktx@alpha holding
+                            the alpha channel of the images which have one
+
+The variants have a full mip chain, except the NPOT ETC1 ones since OpenGL ES 2
+can't sample NPOT textures with mipmaps. The colors of the ASTC and ETC2 RGBA
+variants are premultiplied by their alpha as the PNG loader does, the ETC1 ones
+are not, the ETC1 alpha shader premultiplies them.
+
+The encoding is done by PVRTexToolCLI (PowerVR SDK tools), the images are read
+with Pillow.
+
+    tools/compress_textures.py Resources/res
+    tools/compress_textures.py Resources/res --formats astc,etc1 --min-size 1048576
+'''
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+from argparse import ArgumentParser
+
+try:
+    from PIL import Image
+except ImportError:
+    sys.exit('compress_textures.py needs Pillow: pip3 install Pillow')
+
+SOURCE_EXTENSIONS = ('.png', '.jpg', '.jpeg')
+
+# (suffix, PVRTexToolCLI format of the opaque images, of the images with alpha, quality)
+FORMATS = {
+    'astc': ('.astc.ktx', 'ASTC_6x6', 'ASTC_6x6', 'astcthorough'),
+    'etc2': ('.etc2.ktx', 'ETC2_RGB', 'ETC2_RGBA', 'etcslow'),
+    'etc1': ('.etc1.ktx', 'ETC1', 'ETC1', 'etcslow'),
+}
+
+ETC1_ALPHA_SUFFIX = '@alpha'
+
+
+def is_pot(value):
+    return value > 0 and (value & (value - 1)) == 0
+
+
+def has_alpha(image):
+    if image.mode not in ('RGBA', 'LA', 'PA') and 'transparency' not in image.info:
+        return False
+    return image.convert('RGBA').getextrema()[3][0] < 255
+
+
+def is_up_to_date(source, output):
+    return os.path.exists(output) and os.path.getmtime(output) >= os.path.getmtime(source)
+
+
+def run_tool(tool, source, output, pixel_format, quality, mipmaps, premultiply):
+    command = [tool, '-i', source, '-o', output, '-f', pixel_format + ',UBN,lRGB', '-q', quality]
+    if mipmaps:
+        command.append('-m')
+    if premultiply:
+        command.append('-p')
+    subprocess.check_call(command, stdout=subprocess.DEVNULL)
+
+
+def compress_image(tool, path, formats, force):
+    image = Image.open(path)
+    width, height = image.size
+    alpha = has_alpha(image)
+    stem = os.path.splitext(path)[0]
+    written = []
+
+    for name in formats:
+        suffix, opaque_format, alpha_format, quality = FORMATS[name]
+        output = stem + suffix
+        if not force and is_up_to_date(path, output):
+            continue
+
+        if name == 'etc1':
+            mipmaps = is_pot(width) and is_pot(height)
+            with tempfile.TemporaryDirectory() as directory:
+                rgb = os.path.join(directory, 'rgb.png')
+                image.convert('RGB').save(rgb)
+                run_tool(tool, rgb, output, opaque_format, quality, mipmaps, False)
+                if alpha:
+                    mask = os.path.join(directory, 'alpha.png')
+                    image.convert('RGBA').getchannel('A').convert('RGB').save(mask)
+                    run_tool(tool, mask, output + ETC1_ALPHA_SUFFIX, opaque_format, quality, mipmaps, False)
+                elif os.path.exists(output + ETC1_ALPHA_SUFFIX):
+                    os.remove(output + ETC1_ALPHA_SUFFIX)
+        else:
+            run_tool(tool, path, output, alpha_format if alpha else opaque_format, quality, True, alpha)
+        written.append(output)
+
+    return written
+
+
+def collect_images(root, min_size):
+    images = []
+    for directory, dirnames, filenames in os.walk(root):
+        dirnames.sort()
+        for filename in sorted(filenames):
+            path = os.path.join(directory, filename)
+            if os.path.splitext(filename)[1].lower() in SOURCE_EXTENSIONS and os.path.getsize(path) >= min_size:
+                images.append(path)
+    return images
+
+
+def main():
+    parser = ArgumentParser(description='Transcode images into the GPU compressed variants loaded by TextureCache.')
+    parser.add_argument('root', help='directory whose images are transcoded, the variants are written next to them')
+    parser.add_argument('--formats', default='astc,etc2,etc1',
+                        help='comma separated variants to write among astc, etc2 and etc1 (default: all)')
+    parser.add_argument('--min-size', type=int, default=256 * 1024, metavar='BYTES',
+                        help='skip the images smaller than this (default: 256KB)')
+    parser.add_argument('--tool', default=os.environ.get('PVRTEXTOOL', 'PVRTexToolCLI'),
+                        help='PVRTexToolCLI executable (default: $PVRTEXTOOL or PVRTexToolCLI)')
+    parser.add_argument('--force', action='store_true', help='rewrite the variants which are up to date')
+    args = parser.parse_args()
+
+    formats = [name.strip() for name in args.formats.split(',') if name.strip()]
+    for name in formats:
+        if name not in FORMATS:
+            parser.error('unknown format: %s' % name)
+
+    tool = shutil.which(args.tool)
+    if tool is None:
+        sys.exit('%s not found, install the PowerVR texture tools or pass --tool' % args.tool)
+
+    images = collect_images(args.root, args.min_size)
+    count = 0
+    for path in images:
+        for output in compress_image(tool, path, formats, args.force):
+            print('%s -> %s' % (path, output))
+            count += 1
+    print('%d images, %d variants written' % (len(images), count))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Pack a resource directory into a single file mounted with FileUtils::mountPack().
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Pack a resource directory into a single file mounted with FileUtils::mountPack().
+
+The format is described in cocos2d/cocos/base/CCPackFile.h. Files are compressed
+with zlib when it makes them at least 1/8 smaller, other files (images, audio...)
+are stored as is so that they can be read in place from the mapped pack.
+
+    tools/pack_assets.py Resources/res res.pack
+'''
+
+import os
+import struct
+import zlib
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCPK'
+VERSION = 1
+DATA_ALIGNMENT = 16
+
+COMPRESSION_NONE = 0
+COMPRESSION_ZLIB = 1
+
+HEADER_FORMAT = '<4sIII'
+ENTRY_FORMAT = '<IIIIQII'
+
+
+def hash_name(name):
+    # FNV-1a, as PackFile::hashName()
+    h = 2166136261
+    for byte in name:
+        h ^= byte
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+
+def collect_files(root, excludes):
+    files = []
+    for directory, dirnames, filenames in os.walk(root):
+        dirnames.sort()
+        for filename in sorted(filenames):
+            if filename.startswith('.') or os.path.splitext(filename)[1].lower() in excludes:
+                continue
+            path = os.path.join(directory, filename)
+            name = os.path.relpath(path, root).replace(os.sep, '/')
+            files.append((name.encode('utf-8'), path))
+    return files
+
+
+def align(offset):
+    return (offset + DATA_ALIGNMENT - 1) // DATA_ALIGNMENT * DATA_ALIGNMENT
+
+
+def build_pack(root, output, store_only, excludes):
+    files = collect_files(root, excludes)
+
+    entries = []
+    for name, path in files:
+        with open(path, 'rb') as f:
+            data = f.read()
+        compression = COMPRESSION_NONE
+        stored = data
+        if not store_only and data:
+            compressed = zlib.compress(data, 9)
+            if len(compressed) <= len(data) - len(data) // 8:
+                compression = COMPRESSION_ZLIB
+                stored = compressed
+        entries.append({'name': name, 'hash': hash_name(name), 'size': len(data),
+                        'compression': compression, 'stored': stored})
+
+    entries.sort(key=lambda e: (e['hash'], e['name']))
+
+    names = b''
+    for entry in entries:
+        entry['name_offset'] = len(names)
+        names += entry['name']
+
+    offset = align(struct.calcsize(HEADER_FORMAT) + len(entries) * struct.calcsize(ENTRY_FORMAT) + len(names))
+    for entry in entries:
+        entry['offset'] = offset
+        offset = align(offset + len(entry['stored']))
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(entries), len(names)))
+        for entry in entries:
+            f.write(struct.pack(ENTRY_FORMAT, entry['hash'], entry['name_offset'], len(entry['name']),
+                                entry['compression'], entry['offset'], entry['size'], len(entry['stored'])))
+        f.write(names)
+        for entry in entries:
+            f.write(b'\0' * (entry['offset'] - f.tell()))
+            f.write(entry['stored'])
+
+    total = sum(e['size'] for e in entries)
+    compressed = sum(1 for e in entries if e['compression'] == COMPRESSION_ZLIB)
+    print('%s: %d files (%d compressed), %d bytes -> %d bytes' % (output, len(entries), compressed, total, offset))
+
+
+def main():
+    parser = ArgumentParser(description='Pack a resource directory for FileUtils::mountPack().')
+    parser.add_argument('root', help='directory to pack, file names are relative to it')
+    parser.add_argument('output', help='pack file to write')
+    parser.add_argument('--store', action='store_true', help='store every file uncompressed')
+    parser.add_argument('--exclude', action='append', default=[], metavar='EXT',
+                        help='skip the files with this extension, e.g. --exclude .psd')
+    args = parser.parse_args()
+
+    excludes = set(ext.lower() if ext.startswith('.') else '.' + ext.lower() for ext in args.exclude)
+    build_pack(args.root, args.output, args.store, excludes)
+
+
+if __name__ == '__main__':
+    main()